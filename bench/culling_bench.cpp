@@ -0,0 +1,92 @@
+// frustum culling throughput for every kernel the cpu supports, single threaded and across
+// the job workers. bounds are scattered through a cube around a camera looking down -z
+
+#include "lvk/culling.hpp"
+#include "lvk/job_system.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	constexpr int REPEATS = 10;
+
+	template<typename F>
+	auto measure(F&& f) -> double
+	{
+		double best = 1e30;
+		for (int i = 0; i < REPEATS; i++)
+		{
+			auto start = clock::now();
+			f();
+			best = std::min(best, std::chrono::duration<double, std::milli>(clock::now() - start).count());
+		}
+		return best;
+	}
+
+	void report(const char* shape, const char* kernel, const char* threading, double ms, size_t count, size_t visible)
+	{
+		std::printf(
+			"%-8s %-8s %-8s %10.3f %12.1f %10zu\n",
+			shape, kernel, threading, ms, static_cast<double>(count) / (ms * 1e3), visible
+		);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t count = 4'000'000;
+	if (argc > 1)
+	{
+		count = static_cast<size_t>(std::max(std::atoll(argv[1]), 1ll));
+	}
+
+	std::mt19937 rng{ 7 };
+	std::uniform_real_distribution<float> position{ -500.0f, 500.0f };
+	std::uniform_real_distribution<float> size{ 0.5f, 5.0f };
+
+	lvk::sphere_bounds spheres;
+	lvk::aabb_bounds boxes;
+	for (size_t i = 0; i < count; i++)
+	{
+		glm::vec3 center{ position(rng), position(rng), position(rng) };
+		float radius = size(rng);
+		spheres.push_back(center, radius);
+		boxes.push_back(center - glm::vec3{ radius }, center + glm::vec3{ radius });
+	}
+
+	auto projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 400.0f);
+	auto view = glm::lookAt(glm::vec3{ 0.0f }, glm::vec3{ 0.0f, 0.0f, -1.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+	auto frustum = lvk::frustum::from_matrix(projection * view);
+
+	lvk::job_system jobs;
+	std::vector<uint32_t> visible;
+
+	std::printf("%zu bounds, best of %d, %u job workers\n\n", count, REPEATS, jobs.get_worker_count());
+	std::printf("%-8s %-8s %-8s %10s %12s %10s\n", "shape", "kernel", "threads", "ms", "M bounds/s", "visible");
+
+	for (auto kernel : lvk::available_cull_kernels())
+	{
+		auto name = lvk::cull_kernel_name(kernel);
+
+		auto ms = measure([&] { lvk::cull_spheres(frustum, spheres, visible, nullptr, kernel); });
+		report("sphere", name, "1", ms, count, visible.size());
+		ms = measure([&] { lvk::cull_spheres(frustum, spheres, visible, &jobs, kernel); });
+		report("sphere", name, "jobs", ms, count, visible.size());
+
+		ms = measure([&] { lvk::cull_aabbs(frustum, boxes, visible, nullptr, kernel); });
+		report("aabb", name, "1", ms, count, visible.size());
+		ms = measure([&] { lvk::cull_aabbs(frustum, boxes, visible, &jobs, kernel); });
+		report("aabb", name, "jobs", ms, count, visible.size());
+	}
+
+	return 0;
+}
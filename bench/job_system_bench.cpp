@@ -0,0 +1,108 @@
+// scaling of the job system from 1 to hardware_concurrency workers.
+// two workloads: a compute heavy parallel_for, and lots of tiny jobs to show scheduling overhead
+
+#include "lvk/job_system.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	constexpr size_t ELEMENT_COUNT = 1 << 22;
+	constexpr size_t TINY_JOB_COUNT = 1 << 16;
+	constexpr int REPEATS = 5;
+
+	// best of a few runs, in milliseconds
+	template<typename F>
+	auto measure(F&& f) -> double
+	{
+		double best = 1e30;
+		for (int i = 0; i < REPEATS; i++)
+		{
+			auto start = clock::now();
+			f();
+			best = std::min(best, std::chrono::duration<double, std::milli>(clock::now() - start).count());
+		}
+		return best;
+	}
+
+	auto compute_workload(lvk::job_system& jobs, std::vector<float>& values) -> double
+	{
+		return measure([&] {
+			jobs.parallel_for(values.size(), 4096, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+				{
+					float x = static_cast<float>(i) * 0.001f;
+					for (int k = 0; k < 16; k++)
+					{
+						x = std::sin(x) * 0.5f + std::sqrt(std::fabs(x) + 1.0f);
+					}
+					values[i] = x;
+				}
+			});
+		});
+	}
+
+	auto tiny_job_workload(lvk::job_system& jobs) -> double
+	{
+		return measure([&] {
+			std::atomic<uint64_t> sum{ 0 };
+			// parents of 256 children each, so the per thread job ring never wraps
+			constexpr size_t CHILDREN = 256;
+			for (size_t group = 0; group < TINY_JOB_COUNT / CHILDREN; group++)
+			{
+				auto* root = jobs.create([] {});
+				for (size_t i = 0; i < CHILDREN; i++)
+				{
+					jobs.run(jobs.create([&sum, i] { sum.fetch_add(i, std::memory_order_relaxed); }, root));
+				}
+				jobs.run(root);
+				jobs.wait(root);
+			}
+		});
+	}
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t max_workers = std::max(std::thread::hardware_concurrency(), 1u);
+	if (argc > 1)
+	{
+		max_workers = static_cast<uint32_t>(std::max(std::atoi(argv[1]), 1));
+	}
+
+	std::vector<float> values(ELEMENT_COUNT);
+
+	std::printf("%zu elements, %zu tiny jobs, best of %d\n\n", ELEMENT_COUNT, TINY_JOB_COUNT, REPEATS);
+	std::printf("%8s %14s %9s %14s %12s\n", "workers", "compute (ms)", "speedup", "tiny jobs (ms)", "ns per job");
+
+	double baseline = 0.0;
+	for (uint32_t worker_count = 1; worker_count <= max_workers; worker_count++)
+	{
+		lvk::job_system jobs{ worker_count };
+
+		auto compute_ms = compute_workload(jobs, values);
+		auto tiny_ms = tiny_job_workload(jobs);
+		if (worker_count == 1)
+		{
+			baseline = compute_ms;
+		}
+
+		std::printf(
+			"%8u %14.2f %8.2fx %14.2f %12.1f\n",
+			worker_count,
+			compute_ms,
+			baseline / compute_ms,
+			tiny_ms,
+			tiny_ms * 1e6 / static_cast<double>(TINY_JOB_COUNT)
+		);
+	}
+
+	return 0;
+}
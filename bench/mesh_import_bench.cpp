@@ -0,0 +1,104 @@
+// what the mesh cache saves at startup: parsing an obj from scratch vs mapping the cache file.
+// without an argument a dense sphere gets written out as obj first, otherwise the given file is used
+
+#include "lvk/job_system.hpp"
+#include "lvk/mesh.hpp"
+#include "lvk/mesh_cache.hpp"
+#include "lvk/mesh_import.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	constexpr int REPEATS = 5;
+
+	template<typename F>
+	auto measure(F&& f) -> double
+	{
+		double best = 1e30;
+		for (int i = 0; i < REPEATS; i++)
+		{
+			auto start = clock::now();
+			f();
+			best = std::min(best, std::chrono::duration<double, std::milli>(clock::now() - start).count());
+		}
+		return best;
+	}
+
+	void write_obj(const std::string& path, const lvk::mesh_data& mesh)
+	{
+		std::ofstream file{ path };
+		for (const auto& v : mesh.vertices)
+		{
+			file << "v " << v.position.x << ' ' << v.position.y << ' ' << v.position.z << '\n';
+			file << "vt " << v.uv.x << ' ' << 1.0f - v.uv.y << '\n';
+			file << "vn " << v.normal.x << ' ' << v.normal.y << ' ' << v.normal.z << '\n';
+		}
+		for (size_t i = 0; i < mesh.indices.size(); i += 3)
+		{
+			file << 'f';
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				auto index = mesh.indices[i + corner] + 1;
+				file << ' ' << index << '/' << index << '/' << index;
+			}
+			file << '\n';
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string path = argc > 1 ? argv[1] : "mesh_import_bench.obj";
+	if (argc <= 1)
+	{
+		write_obj(path, lvk::make_uv_sphere(512, 1024));
+	}
+
+	lvk::job_system single{ 1 };
+	lvk::job_system jobs;
+
+	auto single_ms = measure([&] { lvk::import_mesh(path, single); });
+	auto jobs_ms = measure([&] { lvk::import_mesh(path, jobs); });
+
+	auto mesh = lvk::import_mesh(path, jobs);
+	auto source = lvk::mesh_source_stamp::of(path);
+	auto cache = path + ".lvkmesh";
+	// straight from the importer, no lods or optimisation
+	auto options = lvk::mesh_load_options{ .generate_lods = false, .optimize = false };
+	lvk::write_mesh_cache(cache, mesh.view(), source, options);
+
+	// copying the mapped vertices and indices out stands in for the memcpy into the staging buffer
+	std::vector<std::byte> staging(mesh.vertices.size() * sizeof(lvk::vertex) + mesh.indices.size() * sizeof(uint32_t));
+	auto cache_ms = measure([&] {
+		auto loaded = lvk::open_mesh_cache(cache, source, options);
+		const auto& view = loaded->view();
+		std::memcpy(staging.data(), view.vertices.data(), view.vertices.size_bytes());
+		std::memcpy(staging.data() + view.vertices.size_bytes(), view.indices.data(), view.indices.size_bytes());
+	});
+
+	std::printf("%s: %zu vertices, %zu triangles, %.1f MB on disk, best of %d\n\n",
+		path.c_str(), mesh.vertices.size(), mesh.indices.size() / 3,
+		static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0), REPEATS);
+	std::printf("%-28s %10s\n", "", "ms");
+	std::printf("%-28s %10.2f\n", "import, single thread", single_ms);
+	std::printf("%-28s %10.2f\n", "import, job workers", jobs_ms);
+	std::printf("%-28s %10.2f\n", "cache, map + copy", cache_ms);
+	std::printf("\n%u workers\n", jobs.get_worker_count());
+
+	std::filesystem::remove(cache);
+	if (argc <= 1)
+	{
+		std::filesystem::remove(path);
+	}
+	return 0;
+}
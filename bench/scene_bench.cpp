@@ -0,0 +1,76 @@
+// transform update cost for a large scene, single threaded and across the job workers.
+// the hierarchy is a forest of shallow trees, roughly what a level full of props looks like
+
+#include "lvk/job_system.hpp"
+#include "lvk/scene.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	constexpr int REPEATS = 10;
+
+	template<typename F>
+	auto measure(F&& f) -> double
+	{
+		double best = 1e30;
+		for (int i = 0; i < REPEATS; i++)
+		{
+			auto start = clock::now();
+			f();
+			best = std::min(best, std::chrono::duration<double, std::milli>(clock::now() - start).count());
+		}
+		return best;
+	}
+
+	void populate(lvk::scene& scene, size_t count)
+	{
+		std::mt19937 rng{ 42 };
+		std::uniform_real_distribution<float> position{ -100.0f, 100.0f };
+
+		std::vector<lvk::entity> entities;
+		entities.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			// every 8th entity starts a new tree, the rest hang off a recent one
+			auto parent = i % 8 == 0 ? lvk::NO_ENTITY : entities[i - 1 - rng() % (i % 8)];
+			auto e = scene.create(parent);
+			scene.set_position(e, { position(rng), position(rng), position(rng) });
+			scene.set_rotation(e, glm::quat{ 1.0f, 0.1f, 0.2f, 0.3f });
+			entities.push_back(e);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t count = 100'000;
+	if (argc > 1)
+	{
+		count = static_cast<size_t>(std::max(std::atoll(argv[1]), 1ll));
+	}
+
+	lvk::scene scene;
+	populate(scene, count);
+	// the first update sorts the hierarchy, which isn't what's being measured
+	scene.update_transforms();
+
+	lvk::job_system jobs;
+
+	auto single_ms = measure([&] { scene.update_transforms(); });
+	auto jobs_ms = measure([&] { scene.update_transforms(&jobs); });
+
+	std::printf("%zu entities, best of %d\n\n", count, REPEATS);
+	std::printf("%-22s %10s %14s\n", "", "ms", "ns per entity");
+	std::printf("%-22s %10.3f %14.2f\n", "single thread", single_ms, single_ms * 1e6 / static_cast<double>(count));
+	std::printf("%-22s %10.3f %14.2f\n", "job workers", jobs_ms, jobs_ms * 1e6 / static_cast<double>(count));
+	std::printf("\n%u workers, %zu bytes of instance data\n", jobs.get_worker_count(), scene.get_instances().size_bytes());
+	return 0;
+}
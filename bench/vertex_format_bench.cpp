@@ -0,0 +1,121 @@
+// what the quantised vertex layouts save: bytes per vertex, vertex buffer size, the bytes a draw
+// fetches through the vertex cache, how long encoding takes and the worst error each attribute gets.
+// without an argument a dense sphere is used, otherwise the given obj/gltf/glb.
+// the frame time side is measured in the app, compare its exit stats with --vertex-format full and compact
+
+#include "lvk/job_system.hpp"
+#include "lvk/mesh.hpp"
+#include "lvk/mesh_import.hpp"
+#include "lvk/mesh_optimize.hpp"
+#include "lvk/vertex_format.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <span>
+#include <vector>
+
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	constexpr int REPEATS = 5;
+
+	template<typename F>
+	auto measure(F&& f) -> double
+	{
+		double best = 1e30;
+		for (int i = 0; i < REPEATS; i++)
+		{
+			auto start = clock::now();
+			f();
+			best = std::min(best, std::chrono::duration<double, std::milli>(clock::now() - start).count());
+		}
+		return best;
+	}
+
+	struct encoding_error
+	{
+		// position relative to the mesh radius, normal in degrees, uv absolute
+		float position = 0.0f;
+		float normal = 0.0f;
+		float uv = 0.0f;
+	};
+
+	auto measure_error(std::span<const lvk::vertex> vertices, float radius, const lvk::vertex_layout& layout,
+		const lvk::position_dequantization& dequantization, std::span<const std::byte> encoded) -> encoding_error
+	{
+		encoding_error error;
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			auto decoded = lvk::decode_vertex(encoded.data() + i * layout.stride(), layout, dequantization);
+			const auto& v = vertices[i];
+			error.position = std::max(error.position, glm::length(decoded.position - v.position) / radius);
+			auto cosine = std::clamp(glm::dot(decoded.normal, glm::normalize(v.normal)), -1.0f, 1.0f);
+			error.normal = std::max(error.normal, glm::degrees(std::acos(cosine)));
+			error.uv = std::max({ error.uv, std::abs(decoded.uv.x - v.uv.x), std::abs(decoded.uv.y - v.uv.y) });
+		}
+		return error;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		lvk::mesh_data mesh;
+		if (argc > 1)
+		{
+			lvk::job_system jobs;
+			mesh = lvk::import_mesh(argv[1], jobs);
+		}
+		else
+		{
+			mesh = lvk::make_uv_sphere(512, 1024);
+		}
+		lvk::optimize_mesh(mesh);
+
+		const lvk::vertex_layout layouts[] = {
+			lvk::vertex_layout::full(),
+			{ lvk::position_encoding::float16, lvk::normal_encoding::octahedral16, lvk::uv_encoding::float16 },
+			lvk::vertex_layout::compact(),
+			{ lvk::position_encoding::snorm16, lvk::normal_encoding::octahedral8, lvk::uv_encoding::unorm16 },
+		};
+
+		std::printf("%zu vertices, %zu triangles\n\n", mesh.vertices.size(), mesh.indices.size() / 3);
+		std::printf("%-30s %6s %12s %14s %10s %12s %10s %10s\n",
+			"layout", "stride", "buffer kb", "fetched/tri", "encode ms", "position", "normal deg", "uv");
+
+		for (auto requested : layouts)
+		{
+			auto layout = lvk::fit_vertex_layout(mesh.vertices, requested);
+			auto dequantization = lvk::make_position_dequantization(mesh.vertices, layout.position);
+			std::vector<std::byte> encoded(size_t{ layout.stride() } * mesh.vertices.size());
+
+			auto encode = measure([&] {
+				lvk::encode_vertices(mesh.vertices, layout, dequantization, encoded);
+			});
+			auto error = measure_error(mesh.vertices, std::max(mesh.radius, 1e-6f), layout, dequantization, encoded);
+
+			// bytes the vertex fetch pulls in per triangle, which is what the smaller layouts actually save
+			auto overfetch = lvk::analyze_vertex_fetch(mesh.indices, mesh.vertices.size(), layout.stride());
+			auto fetched = overfetch * static_cast<float>(encoded.size()) / static_cast<float>(mesh.indices.size() / 3);
+
+			std::printf("%-30s %6u %12zu %14.1f %10.2f %12.2e %10.3f %10.2e\n",
+				layout.name().c_str(), layout.stride(), encoded.size() / 1024, fetched, encode,
+				error.position, error.normal, error.uv);
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
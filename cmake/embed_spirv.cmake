@@ -0,0 +1,52 @@
+# turns the compiled *.spv files into a header of constexpr uint32_t arrays,
+# so the app doesn't have to load its shaders from disk at startup
+#
+# usage: cmake -DOUTPUT=<header> -DSPV_FILES=<a.spv|b.spv|...> -P embed_spirv.cmake
+
+# lists get mangled on the way through add_custom_command, so they're passed '|' separated
+string(REPLACE "|" ";" SPV_FILES "${SPV_FILES}")
+
+set(BLOBS "")
+set(TABLE "")
+
+foreach (SPV_FILE ${SPV_FILES})
+	get_filename_component(SHADER_NAME ${SPV_FILE} NAME)
+	string(MAKE_C_IDENTIFIER ${SHADER_NAME} SHADER_IDENTIFIER)
+
+	file(READ ${SPV_FILE} SPV_HEX HEX)
+
+	# spir-v is a stream of little endian words, so every 4 bytes get swapped into one literal
+	string(
+		REGEX REPLACE "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])"
+		"0x\\4\\3\\2\\1, " SPV_WORDS "${SPV_HEX}"
+	)
+	string(REGEX REPLACE "((0x[0-9a-f]+, ){8})" "\\1\n\t\t" SPV_WORDS "${SPV_WORDS}")
+	string(REGEX REPLACE " \n" "\n" SPV_WORDS "${SPV_WORDS}")
+	string(STRIP "${SPV_WORDS}" SPV_WORDS)
+
+	string(APPEND BLOBS "\talignas(16) inline constexpr uint32_t ${SHADER_IDENTIFIER}[] = {\n\t\t${SPV_WORDS}\n\t};\n\n")
+	string(APPEND TABLE "\t\tshader_blob{ \"${SHADER_NAME}\", ${SHADER_IDENTIFIER} },\n")
+endforeach ()
+
+set(HEADER "// generated by cmake/embed_spirv.cmake, do not edit
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace lvk::embedded
+{
+${BLOBS}	struct shader_blob
+	{
+		std::string_view name;
+		std::span<const uint32_t> words;
+	};
+
+	inline constexpr shader_blob shaders[] = {
+${TABLE}	};
+}
+")
+
+# only touch the header when something changed, so dependents don't rebuild needlessly
+file(CONFIGURE OUTPUT ${OUTPUT} CONTENT "${HEADER}" @ONLY)
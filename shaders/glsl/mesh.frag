@@ -0,0 +1,17 @@
+#version 460
+
+layout (location = 0) in vec3 frag_normal;
+
+layout (push_constant) uniform push_constants {
+    mat4 transform;
+    vec4 color;
+} push;
+
+layout (location = 0) out vec4 outColor;
+
+const vec3 LIGHT_DIRECTION = normalize(vec3(0.4, 1.0, 0.3));
+
+void main() {
+    float light = 0.25 + 0.75 * max(dot(normalize(frag_normal), LIGHT_DIRECTION), 0.0);
+    outColor = vec4(push.color.rgb * light, 1.0);
+}
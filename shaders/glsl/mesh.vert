@@ -0,0 +1,17 @@
+#version 460
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 uv;
+
+layout (push_constant) uniform push_constants {
+    mat4 transform;
+    vec4 color;
+} push;
+
+layout (location = 0) out vec3 frag_normal;
+
+void main() {
+    gl_Position = push.transform * vec4(position, 1.0);
+    frag_normal = normal;
+}
@@ -0,0 +1,28 @@
+#version 460
+
+// mesh.vert for quantised vertex layouts. positions come in normalised by the vertex fetch and
+// get mapped back by the dequantisation folded into the transform, normals are octahedral
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec2 normal;
+layout (location = 2) in vec2 uv;
+
+layout (push_constant) uniform push_constants {
+    mat4 transform;
+    vec4 color;
+} push;
+
+layout (location = 0) out vec3 frag_normal;
+
+// same as lvk::octahedral_decode
+vec3 decode_octahedral(vec2 encoded) {
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+void main() {
+    gl_Position = push.transform * vec4(position, 1.0);
+    frag_normal = decode_octahedral(normal);
+}
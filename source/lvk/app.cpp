@@ -1,39 +1,303 @@
 #include "app.hpp"
+#include "startup_timer.hpp"
+#include "trace.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
 
 #include <stdexcept>
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <thread>
 
 namespace lvk
 {
-	app::app() {
-		create_pipeline_layout();
-		create_pipeline();
-		create_command_buffers();
+	namespace
+	{
+		// lod 0 is white, coarser lods fade towards red so switches are easy to spot
+		const std::array LOD_COLORS = {
+			glm::vec4{ 1.0f, 1.0f, 1.0f, 1.0f },
+			glm::vec4{ 1.0f, 0.85f, 0.6f, 1.0f },
+			glm::vec4{ 1.0f, 0.7f, 0.4f, 1.0f },
+			glm::vec4{ 1.0f, 0.55f, 0.3f, 1.0f },
+			glm::vec4{ 1.0f, 0.4f, 0.2f, 1.0f },
+			glm::vec4{ 1.0f, 0.25f, 0.15f, 1.0f },
+		};
+
+		constexpr float OBJECT_SPACING = 3.0f;
+		constexpr double CAMERA_ORBIT_SPEED = 0.1;
+
+		auto to_matrix(const instance_transform& instance) -> glm::mat4
+		{
+			glm::mat4 matrix{ 1.0f };
+			for (int row = 0; row < 3; row++)
+			{
+				for (int column = 0; column < 4; column++)
+				{
+					matrix[column][row] = instance.rows[row][column];
+				}
+			}
+			return matrix;
+		}
+	}
+
+	app::app(app_options _options) : options{ std::move(_options) } {
+		create_swap_chains();
+		{
+			startup_phase phase{ "scene" };
+			create_scene();
+		}
+		{
+			startup_phase phase{ "pipelines" };
+			create_pipeline_layout();
+			create_pipeline();
+		}
+		create_pacer();
+		create_readback();
+		create_memory_log();
+		create_occlusion_culler();
+		{
+			startup_phase phase{ "command buffers" };
+			create_command_buffers();
+		}
+		startup_phase::report();
 	}
 
 	app::~app() {
+		// outputs outlive the device, so everything in them that needs it goes first
+		readback.reset();
+		pacer.reset();
+		occlusion.reset();
+		for (auto& output : outputs)
+		{
+			device.get_resources().destroy(output.pipeline);
+			output.swap_chain.reset();
+		}
+		// the swap chains have to be gone before their surfaces
+		vkDeviceWaitIdle(device.get_device());
+		device.get_deletion_queue().flush();
 		vkDestroyPipelineLayout(device.get_device(), pipeline_layout, nullptr);
 	}
 
 	void app::run()
 	{
-		while (!window.should_close())
+		trace::set_thread_name("main");
+
+		running = true;
+		std::thread render_thread{ [this] { render_loop(); } };
+
+		// glfw wants events handled on the main thread, which also runs the simulation at a fixed rate
+		using clock = std::chrono::steady_clock;
+		const auto step = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / SIMULATION_HZ));
+		auto next_tick = clock::now();
+
+		while (running && !should_close())
+		{
+			auto now = clock::now();
+			if (now < next_tick)
+			{
+				LVK_TRACE_SCOPE("wait events");
+				glfwWaitEventsTimeout(std::chrono::duration<double>(next_tick - now).count());
+				continue;
+			}
+
+			LVK_TRACE_SCOPE("tick");
+			{
+				LVK_TRACE_SCOPE("poll events");
+				glfwPollEvents();
+			}
+			simulation.input_time = clock::now();
+			update_simulation(std::chrono::duration<double>(step).count());
+
+			// never blocks. if the render thread fell that far behind this tick is simply skipped,
+			// it only ever draws the newest packet anyway
+			render_packets.try_push(simulation);
+
+			// after a long stall don't try to catch up on every missed tick
+			next_tick = std::max(next_tick + step, now);
+		}
+
+		running = false;
+		render_thread.join();
+		if (render_error)
+		{
+			std::rethrow_exception(render_error);
+		}
+
+		if (readback)
+		{
+			readback->flush([this](const readback_frame& frame) { save_capture(frame); });
+		}
+		if (pacer)
+		{
+			pacer->report();
+		}
+		std::cout << device.get_memory_tracker().snapshot().summary() << std::endl;
+		if (drawn_frames > 0)
+		{
+			auto frames = static_cast<double>(drawn_frames);
+			std::cout << "lod: " << objects.size() << " objects, "
+					  << static_cast<uint64_t>(static_cast<double>(drawn_triangles) / frames) << " triangles per frame on average ("
+					  << static_cast<uint64_t>(static_cast<double>(full_detail_triangles) / frames) << " at full detail)" << std::endl;
+		}
+		if (occlusion_frames > 0)
+		{
+			auto frames = static_cast<double>(occlusion_frames);
+			std::cout << "occlusion: " << static_cast<uint64_t>(static_cast<double>(occlusion_occluded) / frames) << " of "
+					  << static_cast<uint64_t>(static_cast<double>(occlusion_visible + occlusion_occluded) / frames)
+					  << " objects in view occluded per frame on average, "
+					  << static_cast<uint64_t>(static_cast<double>(occlusion_late) / frames) << " drawn late" << std::endl;
+		}
+		trace::write_chrome_trace_from_env();
+	}
+
+	void app::update_simulation(double step)
+	{
+		simulation.sim_frame++;
+		simulation.sim_time += step;
+	}
+
+	void app::render_loop()
+	{
+		trace::set_thread_name("render");
+
+		try
+		{
+			render_packet packet;
+			while (running)
+			{
+				if (pacer)
+				{
+					pacer->wait_for_next_frame();
+				}
+
+				// older packets are stale by now, only the newest one gets drawn
+				if (!render_packets.try_pop_latest(packet))
+				{
+					std::this_thread::sleep_for(std::chrono::microseconds{ 200 });
+					continue;
+				}
+
+				LVK_TRACE_SCOPE("frame");
+				if (pacer)
+				{
+					pacer->mark_input_sampled(packet.input_time);
+				}
+				device.get_deletion_queue().collect();
+				reload_shaders();
+				prepare_draws(packet);
+				draw_frame(packet);
+				check_memory();
+			}
+		}
+		catch (...)
 		{
-			glfwPollEvents();
-			draw_frame();
+			render_error = std::current_exception();
+			running = false;
+			glfwPostEmptyEvent();
 		}
 
 		vkDeviceWaitIdle(device.get_device());
 	}
 
+	auto app::create_outputs() -> std::vector<output>
+	{
+		std::vector<output> result(std::max(options.window_count, 1u));
+		for (size_t i = 0; i < result.size(); i++)
+		{
+			auto title = i == 0 ? std::string{ "first app" } : "first app (" + std::to_string(i + 1) + ")";
+			result[i].window = std::make_unique<window_wrp>(WIDTH, HEIGHT, title);
+			result[i].surface = std::make_unique<surface_wrp>(instance, *result[i].window);
+		}
+		return result;
+	}
+	void app::create_swap_chains()
+	{
+		for (auto& output : outputs)
+		{
+			output.swap_chain = std::make_unique<swap_chain_wrp>(device, *output.surface);
+		}
+		std::cout << (device.get_optional_features().dynamic_rendering ? "rendering: VK_KHR_dynamic_rendering" : "rendering: render passes")
+				  << std::endl;
+	}
+	// closing any window ends the app
+	bool app::should_close()
+	{
+		return std::any_of(outputs.begin(), outputs.end(), [](auto& output) {
+			return output.window->should_close();
+		});
+	}
+	void app::create_scene()
+	{
+		if (options.mesh_path.empty())
+		{
+			auto data = make_uv_sphere(64, 128);
+			generate_lods(data);
+			optimize_mesh(data);
+			mesh = std::make_unique<mesh_wrp>(device, data.view(), options.vertex_format);
+		}
+		else
+		{
+			// the cached mesh stays mapped just long enough to be copied into the staging buffers
+			auto loaded = load_mesh(options.mesh_path, jobs);
+			std::cout << "mesh: " << options.mesh_path << (loaded.is_cached() ? " (cached)" : " (imported)") << std::endl;
+			mesh = std::make_unique<mesh_wrp>(device, loaded.view(), options.vertex_format);
+		}
+
+		// every mesh gets scaled to a radius of 1 and centered on its grid cell
+		auto scale = mesh->get_radius() > 0.0f ? 1.0f / mesh->get_radius() : 1.0f;
+		auto count = std::max(options.object_count, 1u);
+		auto side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+		auto offset = static_cast<float>(side - 1) * OBJECT_SPACING * 0.5f;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			auto object = objects.create();
+			objects.set_position(object, glm::vec3{
+				static_cast<float>(i % side) * OBJECT_SPACING - offset,
+				0.0f,
+				static_cast<float>(i / side) * OBJECT_SPACING - offset,
+			} - mesh->get_center() * scale);
+			objects.set_scale(object, glm::vec3{ scale });
+		}
+		objects.update_transforms(&jobs);
+
+		// nothing moves yet, so the bounds only have to be built once
+		for (const auto& instance : objects.get_instances())
+		{
+			auto center = to_matrix(instance) * glm::vec4{ mesh->get_center(), 1.0f };
+			object_bounds.push_back({ center.x, center.y, center.z }, mesh->get_radius() * scale);
+		}
+		lods.resize(objects.size());
+
+		// close enough to the nearest objects for full detail, far enough to see the whole grid
+		camera_distance = std::max(offset * 0.75f, 4.0f);
+		camera_height = std::max(offset * 0.25f, 2.0f);
+
+		std::cout << "scene: " << objects.size() << " objects, " << mesh->get_lods().size() << " lods of "
+				  << mesh->get_lods().front().index_count / 3 << " to " << mesh->get_lods().back().index_count / 3
+				  << " triangles" << std::endl;
+		std::cout << "vertices: " << mesh->get_layout().name() << ", " << mesh->get_layout().stride() << " bytes each, "
+				  << mesh->get_vertex_bytes() / 1024 << " kb of vertices and " << mesh->get_index_bytes() / 1024 << " kb of indices" << std::endl;
+	}
 	void app::create_pipeline_layout()
 	{
+		auto push_constant_range = VkPushConstantRange{
+			.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+			.offset = 0,
+			.size = sizeof(push_constants),
+		};
+
 		VkPipelineLayoutCreateInfo pipeline_layout_info{};
 		pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		pipeline_layout_info.setLayoutCount = 0;
 		pipeline_layout_info.pSetLayouts = nullptr;
-		pipeline_layout_info.pushConstantRangeCount = 0;
-		pipeline_layout_info.pPushConstantRanges = nullptr;
+		pipeline_layout_info.pushConstantRangeCount = 1;
+		pipeline_layout_info.pPushConstantRanges = &push_constant_range;
 
 		if(vkCreatePipelineLayout(device.get_device(), &pipeline_layout_info, nullptr, &pipeline_layout)
 		!= VK_SUCCESS)
@@ -43,81 +307,369 @@ namespace lvk
 	}
 	void app::create_pipeline()
 	{
-		auto pipeline_config = pipeline->default_pipeline_config_info(swap_chain.width(), swap_chain.height());
-		pipeline_config.render_pass = swap_chain.get_render_pass();
-		pipeline_config.pipeline_layout = pipeline_layout;
-		pipeline = std::make_unique<pipeline_wrp>(device, pipeline_config,
-			"shaders/spv/test.vert.spv", "shaders/spv/test.frag.spv");
+		auto& primary = *outputs.front().swap_chain;
+		for (auto& output : outputs)
+		{
+			auto& swap_chain = *output.swap_chain;
+			auto pipeline_config = pipeline_wrp::default_pipeline_config_info(swap_chain.width(), swap_chain.height());
+			pipeline_config.pipeline_layout = pipeline_layout;
+			pipeline_config.binding_descriptions = mesh->binding_descriptions();
+			pipeline_config.attribute_descriptions = mesh->attribute_descriptions();
+
+			if (swap_chain.uses_dynamic_rendering())
+			{
+				// no render pass to be compatible with, outputs with the same formats simply end up
+				// with the same state and the registry hands back the same pipeline
+				pipeline_config.color_format = swap_chain.get_swap_chain_image_format();
+				pipeline_config.depth_format = swap_chain.get_depth_format();
+			}
+			else
+			{
+				// render passes with the same formats are compatible, so outputs that match the
+				// first one build the exact same state and the registry hands back the same pipeline
+				pipeline_config.render_pass =
+					swap_chain.get_swap_chain_image_format() == primary.get_swap_chain_image_format()
+					? primary.get_render_pass()
+					: swap_chain.get_render_pass();
+			}
+
+			// octahedral normals need decoding, everything else is handled by the vertex fetch
+			auto vertex_shader = mesh->get_layout().normal == normal_encoding::float32
+				? "shaders/spv/mesh.vert.spv"
+				: "shaders/spv/mesh_packed.vert.spv";
+			output.pipeline = device.get_resources().add_pipeline(
+				pipelines.get(pipeline_config, vertex_shader, "shaders/spv/mesh.frag.spv"));
+		}
 	}
 	void app::create_command_buffers()
 	{
-		command_buffers.resize(swap_chain.image_count());
+		for (auto& output : outputs)
+		{
+			output.command_buffers.resize(swap_chain_wrp::MAX_FRAMES_IN_FLIGHT);
+
+			auto alloc_info = VkCommandBufferAllocateInfo{
+				.sType =  VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.commandPool = device.get_command_pool(),
+				.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				.commandBufferCount = static_cast<uint32_t>(output.command_buffers.size()),
+			};
+
+			if (vkAllocateCommandBuffers(device.get_device(), &alloc_info, output.command_buffers.data()) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to allocate command buffers");
+			}
+		}
+	}
+	void app::create_pacer()
+	{
+		// LVK_FRAME_PACING=off runs unpaced, =fence skips present wait even where it's available
+		auto* pacing = std::getenv("LVK_FRAME_PACING");
+		auto setting = std::string{ pacing ? pacing : "" };
+		if (setting == "off")
+		{
+			return;
+		}
 
-		auto alloc_info = VkCommandBufferAllocateInfo{
-			.sType =  VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-			.commandPool = device.get_command_pool(),
-			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-			.commandBufferCount = static_cast<uint32_t>(command_buffers.size()),
+		pacer = std::make_unique<frame_pacer>(device, *outputs.front().swap_chain, setting == "fence");
+		std::cout << "frame pacing: "
+				  << (pacer->get_mode() == frame_pacer::mode::present_wait ? "present wait" : "fence") << std::endl;
+	}
+	void app::create_readback()
+	{
+		// LVK_CAPTURE_DIR turns on frame dumps, LVK_CAPTURE_FRAMES=n stops after n frames and
+		// closes the app (0 keeps dumping every frame), LVK_CAPTURE_FORMAT picks png or ppm
+		auto* dir = std::getenv("LVK_CAPTURE_DIR");
+		if (!dir || !*dir)
+		{
+			return;
+		}
+
+		capture_dir = dir;
+		std::filesystem::create_directories(capture_dir);
+
+		auto* frames = std::getenv("LVK_CAPTURE_FRAMES");
+		capture_frames = frames ? std::strtoull(frames, nullptr, 10) : 1;
+
+		auto* format = std::getenv("LVK_CAPTURE_FORMAT");
+		capture_extension = format && std::string{ format } == "ppm" ? ".ppm" : ".png";
+
+		readback = std::make_unique<frame_readback>(device, *outputs.front().swap_chain);
+	}
+	void app::create_memory_log()
+	{
+		if (auto* interval = std::getenv("LVK_MEMORY_LOG"); interval && *interval)
+		{
+			memory_log_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+				std::chrono::duration<double>(std::max(std::strtod(interval, nullptr), 0.1)));
+		}
+		std::cout << (device.get_optional_features().memory_budget ? "memory budget: VK_EXT_memory_budget" : "memory budget: heap sizes only")
+				  << std::endl;
+	}
+	void app::create_occlusion_culler()
+	{
+		// LVK_OCCLUSION=off keeps to frustum culling
+		auto* setting = std::getenv("LVK_OCCLUSION");
+		if (setting && std::string{ setting } == "off")
+		{
+			return;
+		}
+		if (!occlusion_culler::is_supported(device))
+		{
+			std::cout << "occlusion culling: off, needs VK_EXT_conditional_rendering" << std::endl;
+			return;
+		}
+
+		occlusion = std::make_unique<occlusion_culler>(device, *outputs.front().swap_chain, object_bounds);
+		std::cout << "occlusion culling: " << occlusion->get_pyramid_levels() << " level depth pyramid" << std::endl;
+	}
+	void app::check_memory()
+	{
+		auto now = std::chrono::steady_clock::now();
+		if (now < next_memory_check)
+		{
+			return;
+		}
+		next_memory_check = now + std::chrono::seconds{ 1 };
+
+		LVK_TRACE_SCOPE("check memory");
+		auto snapshot = device.get_memory_tracker().snapshot();
+
+		// warns once per approach, so a heap that stays close to its budget doesn't spam the log
+		const auto* fullest = snapshot.fullest_heap();
+		auto close_to_budget = fullest && fullest->used_fraction() >= MEMORY_WARNING_FRACTION;
+		if (close_to_budget && !memory_warning_shown)
+		{
+			std::cerr << "warning: a memory heap is at " << static_cast<int>(fullest->used_fraction() * 100.0)
+					  << "% of its budget\n" << snapshot.summary() << std::endl;
+		}
+		memory_warning_shown = close_to_budget;
+
+		if (memory_log_interval.count() > 0 && now >= next_memory_log)
+		{
+			next_memory_log = now + memory_log_interval;
+			std::cout << snapshot.summary() << std::endl;
+		}
+	}
+	void app::save_capture(const readback_frame& frame)
+	{
+		if (capture_frames != 0 && captured_frames >= capture_frames)
+		{
+			return;
+		}
+
+		char name[32];
+		std::snprintf(name, sizeof(name), "frame_%06llu", static_cast<unsigned long long>(frame.frame_index));
+		auto path = (std::filesystem::path{ capture_dir } / name).string() + capture_extension;
+
+		if (!write_frame(path, frame))
+		{
+			std::cerr << "failed to write capture " << path << std::endl;
+		}
+
+		if (++captured_frames == capture_frames)
+		{
+			outputs.front().window->request_close();
+		}
+	}
+	void app::record_command_buffer(output& target, VkCommandBuffer command_buffer, const render_packet& packet)
+	{
+		using enum swap_chain_wrp::render_pass_part;
+
+		auto begin_info = VkCommandBufferBeginInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
 		};
 
-		if (vkAllocateCommandBuffers(device.get_device(), &alloc_info, command_buffers.data()) != VK_SUCCESS)
+		if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+			throw std::runtime_error("failed to begin recording command buffer");
+		}
+
+		// only the first output is occlusion culled, the others draw everything in view
+		if (occlusion && &target == &outputs.front())
+		{
+			record_render_pass(target, command_buffer, packet, early);
+			occlusion->record_cull(command_buffer, target.image_index, view_projection);
+			record_render_pass(target, command_buffer, packet, late);
+		}
+		else
 		{
-			throw std::runtime_error("failed to allocate command buffers");
+			record_render_pass(target, command_buffer, packet, whole);
 		}
 
-		for (int i = 0; i < command_buffers.size(); i++) {
-			auto begin_info = VkCommandBufferBeginInfo{
-				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO
-			};
+		if (readback && &target == &outputs.front())
+		{
+			readback->record_copy(command_buffer, target.image_index);
+		}
+		target.swap_chain->prepare_present(command_buffer, target.image_index);
 
-			if (vkBeginCommandBuffer(command_buffers[i], &begin_info) != VK_SUCCESS) {
-				throw std::runtime_error("failed to begin recording command buffer");
+		if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+		  throw std::runtime_error("failed to record command buffer");
+		}
+	}
+	void app::record_render_pass(output& target, VkCommandBuffer command_buffer, const render_packet& packet, swap_chain_wrp::render_pass_part part)
+	{
+		using enum swap_chain_wrp::render_pass_part;
+		auto& swap_chain = *target.swap_chain;
+
+		swap_chain.begin_rendering(
+			command_buffer, target.image_index, part,
+			VkClearColorValue{ {packet.clear_color[0], packet.clear_color[1], packet.clear_color[2], packet.clear_color[3]} });
+
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, device.get_resources().get(target.pipeline)->pipeline);
+		mesh->bind(command_buffer);
+
+		auto instances = objects.get_instances();
+		auto dequantization = mesh->get_dequantization();
+		for (const auto& draw : draws)
+		{
+			// both passes record every draw, the gpu skips the ones the other pass is responsible for
+			if (part == early)
+			{
+				occlusion->begin_early(command_buffer, draw.object);
+			}
+			else if (part == late)
+			{
+				occlusion->begin_late(command_buffer, draw.object);
 			}
 
-			auto render_pass_info = VkRenderPassBeginInfo{
-				.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-				.renderPass = swap_chain.get_render_pass(),
-				.framebuffer = swap_chain.get_frame_buffer(i),
-				.renderArea{
-					.offset = {0, 0},
-					.extent = swap_chain.get_swap_chain_extent()
-				}
+			auto push = push_constants{
+				.transform = view_projection * to_matrix(instances[draw.object]) * dequantization,
+				.color = LOD_COLORS[std::min<size_t>(draw.lod, LOD_COLORS.size() - 1)],
 			};
+			vkCmdPushConstants(
+				command_buffer, pipeline_layout,
+				VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+				0, sizeof(push), &push
+			);
+			mesh->draw(command_buffer, draw.lod);
 
-			auto clear_values = std::array<VkClearValue, 2>{
-				VkClearValue{
-					.color = {0.1f, 0.1f, 0.1f, 1.0f}
-				},
-				VkClearValue{
-					.depthStencil = {1.0f, 0}
-				}
-			};
+			if (part != whole)
+			{
+				occlusion->end(command_buffer);
+			}
+		}
 
-			render_pass_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
-			render_pass_info.pClearValues = clear_values.data();
+		swap_chain.end_rendering(command_buffer, target.image_index, part);
+	}
+	void app::reload_shaders()
+	{
+#ifdef LVK_SHADER_HOT_RELOAD
+		auto changed = shaders.take_changes();
+		if (changed.empty())
+		{
+			return;
+		}
+
+		LVK_TRACE_SCOPE("reload shaders");
+		auto reloads = pipelines.reload(changed);
+		if (reloads.empty())
+		{
+			return;
+		}
 
-			vkCmdBeginRenderPass(command_buffers[i], &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+		// command buffers still in flight reference the old pipelines, but dropping them only
+		// queues their destruction until those frames have retired, see deletion_queue
+		for (const auto& reload : reloads)
+		{
+			device.get_resources().replace_pipeline(reload.old_pipeline, reload.new_pipeline);
+		}
 
-			pipeline->bind(command_buffers[i]);
-			vkCmdDraw(command_buffers[i], 3, 1, 0, 0);
+		reloads.clear();
+		pipelines.purge_unused();
+#endif
+	}
+	void app::prepare_draws(const render_packet& packet)
+	{
+		LVK_TRACE_SCOPE("prepare draws");
 
-			vkCmdEndRenderPass(command_buffers[i]);
-			if (vkEndCommandBuffer(command_buffers[i]) != VK_SUCCESS) {
-			  throw std::runtime_error("failed to record command buffer");
-			}
+		auto extent = outputs.front().swap_chain->get_swap_chain_extent();
+		auto aspect = static_cast<float>(extent.width) / static_cast<float>(extent.height);
+
+		// orbits the middle of the grid
+		auto angle = static_cast<float>(packet.sim_time * CAMERA_ORBIT_SPEED);
+		glm::vec3 eye{ std::cos(angle) * camera_distance, camera_height, std::sin(angle) * camera_distance };
+		auto view = glm::lookAt(eye, glm::vec3{ 0.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+		auto projection = glm::perspective(FIELD_OF_VIEW, aspect, 0.1f, 1000.0f);
+		// vulkan's clip space y points down
+		projection[1][1] *= -1.0f;
+		view_projection = projection * view;
+
+		cull_spheres(frustum::from_matrix(view_projection), object_bounds, visible_objects, &jobs);
+
+		// lods only depend on how big an object ends up on screen, so the triangle count
+		// stays roughly flat no matter how many objects are in the distance
+		auto scale = projection_scale(FIELD_OF_VIEW, static_cast<float>(extent.height));
+		auto mesh_lods = mesh->get_lods();
+		draws.clear();
+		for (auto object : visible_objects)
+		{
+			glm::vec3 center{ object_bounds.x[object], object_bounds.y[object], object_bounds.z[object] };
+			auto radius = object_bounds.radius[object];
+			auto lod = lods.select(object, mesh_lods, radius, glm::distance(center, eye), scale);
+			draws.push_back({ object, lod });
+
+			drawn_triangles += mesh_lods[lod].index_count / 3;
+			full_detail_triangles += mesh_lods.front().index_count / 3;
 		}
+		drawn_frames++;
 	}
-	void app::draw_frame()
+	void app::draw_frame(const render_packet& packet)
 	{
-		uint32_t image_index;
-		auto result = swap_chain.acquire_next_image(&image_index);
-		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-			throw std::runtime_error("failed to acquire swap chain image");
+		LVK_TRACE_SCOPE("draw frame");
+		for (auto& output : outputs)
+		{
+			auto result = output.swap_chain->acquire_next_image(&output.image_index);
+			if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+				throw std::runtime_error("failed to acquire swap chain image");
+			}
+		}
+
+		auto& primary = outputs.front();
+		if (readback)
+		{
+			readback->collect(primary.image_index, [this](const readback_frame& frame) { save_capture(frame); });
+		}
+		if (occlusion)
+		{
+			auto stats = occlusion->collect_stats();
+			occlusion_visible += stats.visible;
+			occlusion_occluded += stats.occluded;
+			occlusion_late += stats.late;
+			occlusion_frames++;
 		}
 
-		result = swap_chain.submit_command_buffers(&command_buffers[image_index], &image_index);
-		if (result != VK_SUCCESS) {
+		// every output presents in the same vkQueuePresentKHR
+		present_batch presents;
+		for (auto& output : outputs)
+		{
+			// acquiring waited for the frame that last used this command buffer
+			auto command_buffer = output.command_buffers[output.swap_chain->get_current_frame()];
+			{
+				LVK_TRACE_SCOPE("record commands");
+				record_command_buffer(output, command_buffer, packet);
+			}
+			output.swap_chain->submit_command_buffers(&command_buffer, &output.image_index);
+
+			// only the first output is paced
+			auto present_id = pacer && &output == &primary ? pacer->get_present_id() : 0;
+			presents.add(*output.swap_chain, output.image_index, present_id);
+		}
+
+		if (readback)
+		{
+			readback->mark_submitted(primary.image_index);
+		}
+		if (pacer)
+		{
+			pacer->mark_submitted();
+		}
+
+		if (presents.present(device.get_present_queue()) != VK_SUCCESS) {
 			throw std::runtime_error("failed to present swap chain image");
 		}
+		if (pacer)
+		{
+			pacer->mark_presented();
+		}
 	}
 }
\ No newline at end of file
@@ -2,20 +2,62 @@
 
 #include "window_wrp.hpp"
 #include "pipeline_wrp.hpp"
+#include "pipeline_registry.hpp"
+#include "instance_wrp.hpp"
+#include "surface_wrp.hpp"
 #include "device_wrp.hpp"
 #include "swap_chain_wrp.hpp"
+#include "frame_readback.hpp"
+#include "frame_pacer.hpp"
+#include "render_packet.hpp"
+#include "spsc_queue.hpp"
+#include "job_system.hpp"
+#include "mesh_wrp.hpp"
+#include "mesh_lod.hpp"
+#include "mesh_cache.hpp"
+#include "mesh_optimize.hpp"
+#include "vertex_format.hpp"
+#include "scene.hpp"
+#include "culling.hpp"
+#include "occlusion_culler.hpp"
+#ifdef LVK_SHADER_HOT_RELOAD
+#include "shader_watcher.hpp"
+#endif
 
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include "atomic"
+#include "chrono"
+#include "exception"
 #include "memory"
+#include "string"
 #include "vector"
 
 namespace lvk
 {
+	struct app_options
+	{
+		// pins a physical device, see device_wrp
+		std::string device_selector;
+		// every window gets its own swap chain, the device and pipelines are shared
+		uint32_t window_count = 1;
+		// copies of the test mesh, laid out on a grid
+		uint32_t object_count = 4096;
+		// obj, gltf or glb to draw instead of the test sphere
+		std::string mesh_path;
+		// how vertices are stored on the gpu, see vertex_layout::parse
+		vertex_layout vertex_format = vertex_layout::full();
+	};
+
 	class app
 	{
 		public:
 		static constexpr int WIDTH = 1280, HEIGHT = 720;
+		static constexpr double SIMULATION_HZ = 240.0;
+		static constexpr float FIELD_OF_VIEW = 1.0f;
 
-		app();
+		explicit app(app_options _options = {});
 		~app();
 		app(const app&) = delete;
 		app &operator=(const app&) = delete;
@@ -23,19 +65,107 @@ namespace lvk
 		void run();
 
 		private:
-		window_wrp window{ WIDTH, HEIGHT, "first app" };
-		device_wrp device{ window };
-		swap_chain_wrp swap_chain{device, window.get_extent()};
+		// a window plus everything that can't be shared with the other windows
+		struct output
+		{
+			std::unique_ptr<window_wrp> window;
+			std::unique_ptr<surface_wrp> surface;
+			std::unique_ptr<swap_chain_wrp> swap_chain;
+			// the same pipeline for every output with a compatible render pass. the handle stays
+			// valid across hot reloads, see gpu_resources::replace_pipeline
+			pipeline_handle pipeline;
+			// one per frame in flight, recorded fresh every frame
+			std::vector<VkCommandBuffer> command_buffers;
+			uint32_t image_index = 0;
+		};
+
+		struct mesh_draw
+		{
+			uint32_t object;
+			uint32_t lod;
+		};
+
+		struct push_constants
+		{
+			glm::mat4 transform;
+			glm::vec4 color;
+		};
+
+		app_options options;
+		// one worker per hardware thread. the render thread isn't a worker, its jobs go through
+		// the shared queue and it helps out while it waits on them
+		job_system jobs;
+		instance_wrp instance;
+		// created before the device, which gets picked to present to the first one
+		std::vector<output> outputs = create_outputs();
+		device_wrp device{ instance, *outputs.front().surface, options.device_selector };
 //		pipeline_wrp pipeline{
 //			device, pipeline_wrp::default_pipeline_config_info(WIDTH, HEIGHT),
 //			"shaders/spv/test.vert.spv", "shaders/spv/test.frag.spv" };
-		std::unique_ptr<pipeline_wrp> pipeline;
+		pipeline_registry pipelines{ device };
 		VkPipelineLayout pipeline_layout;
-		std::vector<VkCommandBuffer> command_buffers;
 
+		// every object draws the same mesh, one lod per object picked each frame
+		std::unique_ptr<mesh_wrp> mesh;
+		scene objects;
+		sphere_bounds object_bounds;
+		lod_selector lods;
+		float camera_distance = 0.0f, camera_height = 0.0f;
+		// built by the render thread once per frame and recorded into every output
+		glm::mat4 view_projection{ 1.0f };
+		std::vector<uint32_t> visible_objects;
+		std::vector<mesh_draw> draws;
+		uint64_t drawn_frames = 0, drawn_triangles = 0, full_detail_triangles = 0;
+
+		// splits the first output's frames around a gpu occlusion test, see create_occlusion_culler
+		std::unique_ptr<occlusion_culler> occlusion;
+		uint64_t occlusion_frames = 0, occlusion_visible = 0, occlusion_occluded = 0, occlusion_late = 0;
+
+		// paces the first output, see create_pacer
+		std::unique_ptr<frame_pacer> pacer;
+		// only exists while capturing the first output, see create_readback
+		std::unique_ptr<frame_readback> readback;
+		std::string capture_dir;
+		std::string capture_extension;
+		uint64_t capture_frames = 0;
+		uint64_t captured_frames = 0;
+
+		// budget checks run about once a second on the render thread, see check_memory.
+		// LVK_MEMORY_LOG=<seconds> also prints the summary that often
+		static constexpr double MEMORY_WARNING_FRACTION = 0.9;
+		std::chrono::steady_clock::duration memory_log_interval{};
+		std::chrono::steady_clock::time_point next_memory_check, next_memory_log;
+		bool memory_warning_shown = false;
+
+		// the main thread polls input and simulates, the render thread records, submits and presents.
+		// sized so the simulation never fills it up while the render thread keeps up
+		spsc_queue<render_packet, 8> render_packets;
+		render_packet simulation;
+		std::atomic<bool> running{ false };
+		std::exception_ptr render_error;
+#ifdef LVK_SHADER_HOT_RELOAD
+		shader_watcher shaders{ LVK_SHADER_SOURCE_DIR, LVK_SHADER_BINARY_DIR, LVK_GLSLC_PATH };
+#endif
+
+		auto create_outputs() -> std::vector<output>;
+		void create_swap_chains();
+		bool should_close();
+		void create_scene();
 		void create_pipeline_layout();
 		void create_pipeline();
 		void create_command_buffers();
-		void draw_frame();
+		void create_pacer();
+		void create_readback();
+		void create_memory_log();
+		void create_occlusion_culler();
+		void check_memory();
+		void save_capture(const readback_frame& frame);
+		void update_simulation(double step);
+		void render_loop();
+		void prepare_draws(const render_packet& packet);
+		void record_command_buffer(output& target, VkCommandBuffer command_buffer, const render_packet& packet);
+		void record_render_pass(output& target, VkCommandBuffer command_buffer, const render_packet& packet, swap_chain_wrp::render_pass_part part);
+		void reload_shaders();
+		void draw_frame(const render_packet& packet);
 	};
 }
@@ -0,0 +1,281 @@
+#include "barrier_batch.hpp"
+#include "device_wrp.hpp"
+
+#include <stdexcept>
+
+namespace lvk
+{
+	namespace
+	{
+		// everything else only reads
+		constexpr VkAccessFlags2KHR WRITE_ACCESS = VK_ACCESS_2_SHADER_WRITE_BIT_KHR
+			| VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR
+			| VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR
+			| VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR
+			| VK_ACCESS_2_HOST_WRITE_BIT_KHR
+			| VK_ACCESS_2_MEMORY_WRITE_BIT_KHR;
+	}
+
+	barrier_batch::barrier_batch(device_wrp& _device) : synchronization2{ _device.get_optional_features().synchronization2 }
+	{
+		if (synchronization2)
+		{
+			cmd_pipeline_barrier2 = (PFN_vkCmdPipelineBarrier2KHR)vkGetDeviceProcAddr(_device.get_device(), "vkCmdPipelineBarrier2KHR");
+		}
+	}
+
+	void barrier_batch::use(VkBuffer buffer, const resource_access& next)
+	{
+		auto& state = buffers[buffer];
+		if (auto* barrier = prepare(state, buffer_barriers, buffer_owners, next, false))
+		{
+			barrier->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR;
+			barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier->buffer = buffer;
+			barrier->offset = 0;
+			barrier->size = VK_WHOLE_SIZE;
+		}
+	}
+
+	void barrier_batch::use(VkImage image, const VkImageSubresourceRange& range, const resource_access& next)
+	{
+		auto& state = images[image];
+		auto old_layout = state.layout;
+		if (auto* barrier = prepare(state, image_barriers, image_owners, next, true))
+		{
+			barrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+			barrier->oldLayout = old_layout;
+			barrier->newLayout = next.layout;
+			barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier->image = image;
+			barrier->subresourceRange = range;
+		}
+	}
+
+	void barrier_batch::assume(VkBuffer buffer, const resource_access& last)
+	{
+		reset(buffers[buffer], last);
+	}
+
+	void barrier_batch::assume(VkImage image, const resource_access& last)
+	{
+		reset(images[image], last);
+	}
+
+	void barrier_batch::forget(VkBuffer buffer)
+	{
+		if (auto found = buffers.find(buffer); found != buffers.end())
+		{
+			if (found->second.barrier != NO_BARRIER)
+			{
+				drop(buffer_barriers, buffer_owners, found->second.barrier);
+			}
+			buffers.erase(found);
+		}
+	}
+
+	void barrier_batch::forget(VkImage image)
+	{
+		if (auto found = images.find(image); found != images.end())
+		{
+			if (found->second.barrier != NO_BARRIER)
+			{
+				drop(image_barriers, image_owners, found->second.barrier);
+			}
+			images.erase(found);
+		}
+	}
+
+	void barrier_batch::flush(VkCommandBuffer command_buffer)
+	{
+		if (pending() == 0)
+		{
+			return;
+		}
+
+		if (synchronization2)
+		{
+			auto dependency = VkDependencyInfoKHR{
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
+				.bufferMemoryBarrierCount = static_cast<uint32_t>(buffer_barriers.size()),
+				.pBufferMemoryBarriers = buffer_barriers.data(),
+				.imageMemoryBarrierCount = static_cast<uint32_t>(image_barriers.size()),
+				.pImageMemoryBarriers = image_barriers.data(),
+			};
+			cmd_pipeline_barrier2(command_buffer, &dependency);
+		}
+		else
+		{
+			record_fallback(command_buffer);
+		}
+
+		// from here on the batched uses are what happened last
+		for (auto* state : buffer_owners)
+		{
+			advance(*state, state->batched, false);
+			state->barrier = NO_BARRIER;
+		}
+		for (auto* state : image_owners)
+		{
+			advance(*state, state->batched, true);
+			state->barrier = NO_BARRIER;
+		}
+		buffer_barriers.clear();
+		image_barriers.clear();
+		buffer_owners.clear();
+		image_owners.clear();
+	}
+
+	auto barrier_batch::wait_for(const tracked& state, const resource_access& next, bool is_image, source_scope& source) -> bool
+	{
+		auto relayout = is_image && next.layout != state.layout;
+		auto writes = (next.access & WRITE_ACCESS) != 0;
+
+		if (!relayout && !writes)
+		{
+			auto covered = (next.stages & ~state.read_stages) == 0 && (next.access & ~state.read_access) == 0;
+			if (state.write_stages == VK_PIPELINE_STAGE_2_NONE_KHR || covered)
+			{
+				return false;
+			}
+			source = { state.write_stages, state.write_access };
+			return true;
+		}
+
+		// reads before a write only need to have finished, nothing of theirs has to become visible
+		source = { state.write_stages | state.read_stages, state.write_access };
+		return relayout || source.stages != VK_PIPELINE_STAGE_2_NONE_KHR;
+	}
+
+	void barrier_batch::advance(tracked& state, const resource_access& next, bool is_image)
+	{
+		auto relayout = is_image && next.layout != state.layout;
+		if (!relayout && (next.access & WRITE_ACCESS) == 0)
+		{
+			state.read_stages |= next.stages;
+			state.read_access |= next.access;
+			return;
+		}
+		reset(state, next);
+	}
+
+	void barrier_batch::reset(tracked& state, const resource_access& last)
+	{
+		auto writes = (last.access & WRITE_ACCESS) != 0;
+		state.layout = last.layout;
+		// a layout change counts as a write, one the barrier already made visible to last
+		state.write_stages = last.stages;
+		state.write_access = last.access & WRITE_ACCESS;
+		state.read_stages = writes ? VK_PIPELINE_STAGE_2_NONE_KHR : last.stages;
+		state.read_access = writes ? VK_ACCESS_2_NONE_KHR : last.access;
+	}
+
+	template<typename Barrier>
+	auto barrier_batch::prepare(tracked& state, std::vector<Barrier>& barriers, std::vector<tracked*>& owners, const resource_access& next, bool is_image)
+		-> Barrier*
+	{
+		source_scope source{};
+
+		// the commands after the next flush use it both ways, so the one barrier has to cover both
+		if (state.barrier != NO_BARRIER)
+		{
+			if (is_image && next.layout != state.batched.layout)
+			{
+				throw std::runtime_error("an image can only be used in one layout between barrier flushes");
+			}
+			state.batched.stages |= next.stages;
+			state.batched.access |= next.access;
+			wait_for(state, state.batched, is_image, source);
+
+			auto& barrier = barriers[state.barrier];
+			barrier.srcStageMask = source.stages;
+			barrier.srcAccessMask = source.access;
+			barrier.dstStageMask = state.batched.stages;
+			barrier.dstAccessMask = state.batched.access;
+			return nullptr;
+		}
+
+		if (!wait_for(state, next, is_image, source))
+		{
+			advance(state, next, is_image);
+			return nullptr;
+		}
+
+		state.barrier = barriers.size();
+		state.batched = next;
+		owners.push_back(&state);
+
+		auto& barrier = barriers.emplace_back();
+		barrier.srcStageMask = source.stages;
+		barrier.srcAccessMask = source.access;
+		barrier.dstStageMask = next.stages;
+		barrier.dstAccessMask = next.access;
+		return &barrier;
+	}
+
+	template<typename Barrier>
+	void barrier_batch::drop(std::vector<Barrier>& barriers, std::vector<tracked*>& owners, size_t index)
+	{
+		barriers[index] = barriers.back();
+		owners[index] = owners.back();
+		owners[index]->barrier = index;
+		barriers.pop_back();
+		owners.pop_back();
+	}
+
+	void barrier_batch::record_fallback(VkCommandBuffer command_buffer)
+	{
+		// the legacy stage and access bits have the same values in both, plain barriers just can't
+		// have stages of their own, so everything waits for everything in the batch
+		VkPipelineStageFlags src_stages = 0, dst_stages = 0;
+
+		std::vector<VkBufferMemoryBarrier> legacy_buffers;
+		legacy_buffers.reserve(buffer_barriers.size());
+		for (const auto& barrier : buffer_barriers)
+		{
+			src_stages |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+			dst_stages |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+			legacy_buffers.push_back({
+				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+				.srcAccessMask = static_cast<VkAccessFlags>(barrier.srcAccessMask),
+				.dstAccessMask = static_cast<VkAccessFlags>(barrier.dstAccessMask),
+				.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+				.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+				.buffer = barrier.buffer,
+				.offset = barrier.offset,
+				.size = barrier.size,
+			});
+		}
+
+		std::vector<VkImageMemoryBarrier> legacy_images;
+		legacy_images.reserve(image_barriers.size());
+		for (const auto& barrier : image_barriers)
+		{
+			src_stages |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+			dst_stages |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+			legacy_images.push_back({
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+				.srcAccessMask = static_cast<VkAccessFlags>(barrier.srcAccessMask),
+				.dstAccessMask = static_cast<VkAccessFlags>(barrier.dstAccessMask),
+				.oldLayout = barrier.oldLayout,
+				.newLayout = barrier.newLayout,
+				.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+				.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+				.image = barrier.image,
+				.subresourceRange = barrier.subresourceRange,
+			});
+		}
+
+		// no stage at all isn't allowed there, these are the closest that wait for nothing
+		vkCmdPipelineBarrier(
+			command_buffer,
+			src_stages != 0 ? src_stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			dst_stages != 0 ? dst_stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0,
+			0, nullptr,
+			static_cast<uint32_t>(legacy_buffers.size()), legacy_buffers.data(),
+			static_cast<uint32_t>(legacy_images.size()), legacy_images.data());
+	}
+}
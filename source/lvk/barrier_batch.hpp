@@ -0,0 +1,113 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace lvk
+{
+	class device_wrp;
+
+	// one way a command touches a buffer or image. only the stage and access bits that exist in
+	// plain vkCmdPipelineBarrier too, so they still mean the same without synchronization2
+	struct resource_access
+	{
+		VkPipelineStageFlags2KHR stages = VK_PIPELINE_STAGE_2_NONE_KHR;
+		VkAccessFlags2KHR access = VK_ACCESS_2_NONE_KHR;
+		// ignored for buffers
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	};
+
+	// keeps the last access of every buffer and image and works out the barriers in between.
+	// use says what the next commands are going to do with a resource, flush records whatever
+	// that needs in one vkCmdPipelineBarrier2 (or one vkCmdPipelineBarrier without
+	// synchronization2) right before those commands:
+	//   reads after reads only wait for a layout change, never for each other
+	//   reads after a write wait for it once per stage, later reads in those stages don't
+	//   writes and layout changes wait for the last write and every read since
+	// one device wide instance, command buffers get submitted in the order they're recorded in,
+	// so what one frame leaves behind is where the next one starts. images are tracked as a
+	// whole, every use of one has to name the same subresource range. not thread safe
+	class barrier_batch
+	{
+	public:
+		explicit barrier_batch(device_wrp& _device);
+
+		barrier_batch(const barrier_batch&) = delete;
+		barrier_batch& operator=(const barrier_batch&) = delete;
+
+		void use(VkBuffer buffer, const resource_access& next);
+		void use(VkImage image, const VkImageSubresourceRange& range, const resource_access& next);
+
+		// for what happened without use, like a render pass' layout transitions or a wait on a
+		// semaphore. the next use waits for it like for anything that went through use
+		void assume(VkBuffer buffer, const resource_access& last);
+		void assume(VkImage image, const resource_access& last);
+
+		// drops what's known about a destroyed resource, so a new one with the same handle starts
+		// out undefined
+		void forget(VkBuffer buffer);
+		void forget(VkImage image);
+
+		// records the pending barriers, nothing when there are none. can't be inside a render pass
+		void flush(VkCommandBuffer command_buffer);
+
+		auto pending() const -> size_t
+		{
+			return buffer_barriers.size() + image_barriers.size();
+		}
+
+	private:
+		static constexpr size_t NO_BARRIER = ~size_t{ 0 };
+
+		struct tracked
+		{
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			// the last write or layout change
+			VkPipelineStageFlags2KHR write_stages = VK_PIPELINE_STAGE_2_NONE_KHR;
+			VkAccessFlags2KHR write_access = VK_ACCESS_2_NONE_KHR;
+			// everything that read since, and so already waited for it
+			VkPipelineStageFlags2KHR read_stages = VK_PIPELINE_STAGE_2_NONE_KHR;
+			VkAccessFlags2KHR read_access = VK_ACCESS_2_NONE_KHR;
+			// the pending barrier every further use until flush gets merged into
+			size_t barrier = NO_BARRIER;
+			// every use since the last flush, becomes the tracked access then
+			resource_access batched;
+		};
+
+		struct source_scope
+		{
+			VkPipelineStageFlags2KHR stages;
+			VkAccessFlags2KHR access;
+		};
+
+		// what next has to wait for, false when it doesn't need a barrier at all
+		static auto wait_for(const tracked& state, const resource_access& next, bool is_image, source_scope& source) -> bool;
+		static void advance(tracked& state, const resource_access& next, bool is_image);
+		static void reset(tracked& state, const resource_access& last);
+
+		// a new barrier for the caller to fill in the resource of, nullptr when there's none or
+		// next got merged into the one already pending
+		template<typename Barrier>
+		auto prepare(tracked& state, std::vector<Barrier>& barriers, std::vector<tracked*>& owners, const resource_access& next, bool is_image)
+			-> Barrier*;
+		template<typename Barrier>
+		static void drop(std::vector<Barrier>& barriers, std::vector<tracked*>& owners, size_t index);
+
+		void record_fallback(VkCommandBuffer command_buffer);
+
+		bool synchronization2;
+		PFN_vkCmdPipelineBarrier2KHR cmd_pipeline_barrier2 = nullptr;
+
+		std::unordered_map<VkBuffer, tracked> buffers;
+		std::unordered_map<VkImage, tracked> images;
+
+		std::vector<VkBufferMemoryBarrier2KHR> buffer_barriers;
+		std::vector<VkImageMemoryBarrier2KHR> image_barriers;
+		// whose barriers those are, by index. map nodes don't move, so the pointers stay good
+		std::vector<tracked*> buffer_owners;
+		std::vector<tracked*> image_owners;
+	};
+}
@@ -0,0 +1,538 @@
+#include "culling.hpp"
+
+#include "job_system.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LVK_CULL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define LVK_TARGET_AVX2
+#else
+// only the avx2 kernels get compiled for avx2, the rest of the file stays baseline so it
+// still runs on cpus without it
+#define LVK_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define LVK_CULL_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace lvk
+{
+	namespace
+	{
+		// bounds per job, large enough that the scheduling cost disappears
+		constexpr size_t CULL_CHUNK_SIZE = 16 * 1024;
+
+		struct sphere_columns
+		{
+			const float *x, *y, *z, *radius;
+		};
+
+		struct aabb_columns
+		{
+			const float *center_x, *center_y, *center_z;
+			const float *extent_x, *extent_y, *extent_z;
+		};
+
+		// kernels write the indices of the visible bounds in [begin, end) to out and return how many
+		// there were. they never write more than end - begin entries, so each chunk can compact
+		// into its own slice of the output
+		using sphere_kernel = size_t (*)(const frustum&, const sphere_columns&, size_t, size_t, uint32_t*);
+		using aabb_kernel = size_t (*)(const frustum&, const aabb_columns&, size_t, size_t, uint32_t*);
+
+		// branchless compaction, every lane gets written and only the visible ones advance the cursor
+		inline auto write_visible(uint32_t* out, size_t count, size_t base, uint32_t mask, uint32_t width) -> size_t
+		{
+			for (uint32_t lane = 0; lane < width; lane++)
+			{
+				out[count] = static_cast<uint32_t>(base + lane);
+				count += (mask >> lane) & 1;
+			}
+			return count;
+		}
+
+		auto cull_spheres_scalar(const frustum& view, const sphere_columns& b, size_t begin, size_t end, uint32_t* out) -> size_t
+		{
+			size_t count = 0;
+			for (size_t i = begin; i < end; i++)
+			{
+				bool inside = true;
+				for (const auto& plane : view.planes)
+				{
+					float distance = plane.x * b.x[i] + plane.y * b.y[i] + plane.z * b.z[i] + plane.w;
+					inside &= distance >= -b.radius[i];
+				}
+				out[count] = static_cast<uint32_t>(i);
+				count += inside;
+			}
+			return count;
+		}
+
+		// a box is outside a plane if even its corner furthest along the normal is behind it
+		auto cull_aabbs_scalar(const frustum& view, const aabb_columns& b, size_t begin, size_t end, uint32_t* out) -> size_t
+		{
+			size_t count = 0;
+			for (size_t i = begin; i < end; i++)
+			{
+				bool inside = true;
+				for (const auto& plane : view.planes)
+				{
+					float distance = plane.x * b.center_x[i] + plane.y * b.center_y[i] + plane.z * b.center_z[i] + plane.w;
+					float radius = std::fabs(plane.x) * b.extent_x[i] + std::fabs(plane.y) * b.extent_y[i] + std::fabs(plane.z) * b.extent_z[i];
+					inside &= distance >= -radius;
+				}
+				out[count] = static_cast<uint32_t>(i);
+				count += inside;
+			}
+			return count;
+		}
+
+#ifdef LVK_CULL_X86
+		auto cull_spheres_sse(const frustum& view, const sphere_columns& b, size_t begin, size_t end, uint32_t* out) -> size_t
+		{
+			__m128 nx[6], ny[6], nz[6], nw[6];
+			for (size_t p = 0; p < 6; p++)
+			{
+				nx[p] = _mm_set1_ps(view.planes[p].x);
+				ny[p] = _mm_set1_ps(view.planes[p].y);
+				nz[p] = _mm_set1_ps(view.planes[p].z);
+				nw[p] = _mm_set1_ps(view.planes[p].w);
+			}
+
+			size_t count = 0;
+			size_t i = begin;
+			for (; i + 4 <= end; i += 4)
+			{
+				__m128 x = _mm_loadu_ps(b.x + i);
+				__m128 y = _mm_loadu_ps(b.y + i);
+				__m128 z = _mm_loadu_ps(b.z + i);
+				__m128 neg_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(b.radius + i));
+
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (size_t p = 0; p < 6; p++)
+				{
+					__m128 distance = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(x, nx[p]), _mm_mul_ps(y, ny[p])),
+						_mm_add_ps(_mm_mul_ps(z, nz[p]), nw[p])
+					);
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, neg_radius));
+				}
+				count = write_visible(out, count, i, static_cast<uint32_t>(_mm_movemask_ps(inside)), 4);
+			}
+			return count + cull_spheres_scalar(view, b, i, end, out + count);
+		}
+
+		auto cull_aabbs_sse(const frustum& view, const aabb_columns& b, size_t begin, size_t end, uint32_t* out) -> size_t
+		{
+			__m128 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+			for (size_t p = 0; p < 6; p++)
+			{
+				nx[p] = _mm_set1_ps(view.planes[p].x);
+				ny[p] = _mm_set1_ps(view.planes[p].y);
+				nz[p] = _mm_set1_ps(view.planes[p].z);
+				nw[p] = _mm_set1_ps(view.planes[p].w);
+				ax[p] = _mm_set1_ps(std::fabs(view.planes[p].x));
+				ay[p] = _mm_set1_ps(std::fabs(view.planes[p].y));
+				az[p] = _mm_set1_ps(std::fabs(view.planes[p].z));
+			}
+
+			size_t count = 0;
+			size_t i = begin;
+			for (; i + 4 <= end; i += 4)
+			{
+				__m128 cx = _mm_loadu_ps(b.center_x + i);
+				__m128 cy = _mm_loadu_ps(b.center_y + i);
+				__m128 cz = _mm_loadu_ps(b.center_z + i);
+				__m128 ex = _mm_loadu_ps(b.extent_x + i);
+				__m128 ey = _mm_loadu_ps(b.extent_y + i);
+				__m128 ez = _mm_loadu_ps(b.extent_z + i);
+
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (size_t p = 0; p < 6; p++)
+				{
+					__m128 distance = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(cx, nx[p]), _mm_mul_ps(cy, ny[p])),
+						_mm_add_ps(_mm_mul_ps(cz, nz[p]), nw[p])
+					);
+					__m128 radius = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(ex, ax[p]), _mm_mul_ps(ey, ay[p])),
+						_mm_mul_ps(ez, az[p])
+					);
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+				}
+				count = write_visible(out, count, i, static_cast<uint32_t>(_mm_movemask_ps(inside)), 4);
+			}
+			return count + cull_aabbs_scalar(view, b, i, end, out + count);
+		}
+
+		LVK_TARGET_AVX2 auto cull_spheres_avx2(const frustum& view, const sphere_columns& b, size_t begin, size_t end, uint32_t* out) -> size_t
+		{
+			__m256 nx[6], ny[6], nz[6], nw[6];
+			for (size_t p = 0; p < 6; p++)
+			{
+				nx[p] = _mm256_set1_ps(view.planes[p].x);
+				ny[p] = _mm256_set1_ps(view.planes[p].y);
+				nz[p] = _mm256_set1_ps(view.planes[p].z);
+				nw[p] = _mm256_set1_ps(view.planes[p].w);
+			}
+
+			size_t count = 0;
+			size_t i = begin;
+			for (; i + 8 <= end; i += 8)
+			{
+				__m256 x = _mm256_loadu_ps(b.x + i);
+				__m256 y = _mm256_loadu_ps(b.y + i);
+				__m256 z = _mm256_loadu_ps(b.z + i);
+				__m256 neg_radius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(b.radius + i));
+
+				__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (size_t p = 0; p < 6; p++)
+				{
+					__m256 distance = _mm256_fmadd_ps(x, nx[p], _mm256_fmadd_ps(y, ny[p], _mm256_fmadd_ps(z, nz[p], nw[p])));
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, neg_radius, _CMP_GE_OQ));
+				}
+				count = write_visible(out, count, i, static_cast<uint32_t>(_mm256_movemask_ps(inside)), 8);
+			}
+			return count + cull_spheres_scalar(view, b, i, end, out + count);
+		}
+
+		LVK_TARGET_AVX2 auto cull_aabbs_avx2(const frustum& view, const aabb_columns& b, size_t begin, size_t end, uint32_t* out) -> size_t
+		{
+			__m256 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+			for (size_t p = 0; p < 6; p++)
+			{
+				nx[p] = _mm256_set1_ps(view.planes[p].x);
+				ny[p] = _mm256_set1_ps(view.planes[p].y);
+				nz[p] = _mm256_set1_ps(view.planes[p].z);
+				nw[p] = _mm256_set1_ps(view.planes[p].w);
+				ax[p] = _mm256_set1_ps(std::fabs(view.planes[p].x));
+				ay[p] = _mm256_set1_ps(std::fabs(view.planes[p].y));
+				az[p] = _mm256_set1_ps(std::fabs(view.planes[p].z));
+			}
+
+			size_t count = 0;
+			size_t i = begin;
+			for (; i + 8 <= end; i += 8)
+			{
+				__m256 cx = _mm256_loadu_ps(b.center_x + i);
+				__m256 cy = _mm256_loadu_ps(b.center_y + i);
+				__m256 cz = _mm256_loadu_ps(b.center_z + i);
+				__m256 ex = _mm256_loadu_ps(b.extent_x + i);
+				__m256 ey = _mm256_loadu_ps(b.extent_y + i);
+				__m256 ez = _mm256_loadu_ps(b.extent_z + i);
+
+				__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (size_t p = 0; p < 6; p++)
+				{
+					__m256 distance = _mm256_fmadd_ps(cx, nx[p], _mm256_fmadd_ps(cy, ny[p], _mm256_fmadd_ps(cz, nz[p], nw[p])));
+					__m256 reach = _mm256_fmadd_ps(ex, ax[p], _mm256_fmadd_ps(ey, ay[p], _mm256_fmadd_ps(ez, az[p], distance)));
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(reach, _mm256_setzero_ps(), _CMP_GE_OQ));
+				}
+				count = write_visible(out, count, i, static_cast<uint32_t>(_mm256_movemask_ps(inside)), 8);
+			}
+			return count + cull_aabbs_scalar(view, b, i, end, out + count);
+		}
+
+		bool cpu_supports_avx2()
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+			{
+				return false;
+			}
+
+			// fma and avx, plus the os saving ymm registers
+			__cpuid(info, 1);
+			bool fma = info[2] & (1 << 12);
+			bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+			bool avx = info[2] & (1 << 28);
+			if (!fma || !os_saves_ymm || !avx)
+			{
+				return false;
+			}
+
+			__cpuidex(info, 7, 0);
+			return info[1] & (1 << 5);
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+		}
+#endif
+
+#ifdef LVK_CULL_NEON
+		inline auto neon_mask(uint32x4_t inside) -> uint32_t
+		{
+			const uint32x4_t lane_bits = { 1, 2, 4, 8 };
+			return vaddvq_u32(vandq_u32(inside, lane_bits));
+		}
+
+		auto cull_spheres_neon(const frustum& view, const sphere_columns& b, size_t begin, size_t end, uint32_t* out) -> size_t
+		{
+			size_t count = 0;
+			size_t i = begin;
+			for (; i + 4 <= end; i += 4)
+			{
+				float32x4_t x = vld1q_f32(b.x + i);
+				float32x4_t y = vld1q_f32(b.y + i);
+				float32x4_t z = vld1q_f32(b.z + i);
+				float32x4_t neg_radius = vnegq_f32(vld1q_f32(b.radius + i));
+
+				uint32x4_t inside = vdupq_n_u32(~0u);
+				for (const auto& plane : view.planes)
+				{
+					float32x4_t distance = vfmaq_n_f32(vfmaq_n_f32(vfmaq_n_f32(vdupq_n_f32(plane.w), z, plane.z), y, plane.y), x, plane.x);
+					inside = vandq_u32(inside, vcgeq_f32(distance, neg_radius));
+				}
+				count = write_visible(out, count, i, neon_mask(inside), 4);
+			}
+			return count + cull_spheres_scalar(view, b, i, end, out + count);
+		}
+
+		auto cull_aabbs_neon(const frustum& view, const aabb_columns& b, size_t begin, size_t end, uint32_t* out) -> size_t
+		{
+			size_t count = 0;
+			size_t i = begin;
+			for (; i + 4 <= end; i += 4)
+			{
+				float32x4_t cx = vld1q_f32(b.center_x + i);
+				float32x4_t cy = vld1q_f32(b.center_y + i);
+				float32x4_t cz = vld1q_f32(b.center_z + i);
+				float32x4_t ex = vld1q_f32(b.extent_x + i);
+				float32x4_t ey = vld1q_f32(b.extent_y + i);
+				float32x4_t ez = vld1q_f32(b.extent_z + i);
+
+				uint32x4_t inside = vdupq_n_u32(~0u);
+				for (const auto& plane : view.planes)
+				{
+					float32x4_t reach = vdupq_n_f32(plane.w);
+					reach = vfmaq_n_f32(reach, cx, plane.x);
+					reach = vfmaq_n_f32(reach, cy, plane.y);
+					reach = vfmaq_n_f32(reach, cz, plane.z);
+					reach = vfmaq_n_f32(reach, ex, std::fabs(plane.x));
+					reach = vfmaq_n_f32(reach, ey, std::fabs(plane.y));
+					reach = vfmaq_n_f32(reach, ez, std::fabs(plane.z));
+					inside = vandq_u32(inside, vcgeq_f32(reach, vdupq_n_f32(0.0f)));
+				}
+				count = write_visible(out, count, i, neon_mask(inside), 4);
+			}
+			return count + cull_aabbs_scalar(view, b, i, end, out + count);
+		}
+#endif
+
+		auto select_sphere_kernel(cull_kernel kernel) -> sphere_kernel
+		{
+			switch (kernel)
+			{
+#ifdef LVK_CULL_X86
+			case cull_kernel::sse: return cull_spheres_sse;
+			case cull_kernel::avx2: return cull_spheres_avx2;
+#endif
+#ifdef LVK_CULL_NEON
+			case cull_kernel::neon: return cull_spheres_neon;
+#endif
+			case cull_kernel::scalar: return cull_spheres_scalar;
+			default: throw std::runtime_error(std::string{ "cull kernel not available: " } + cull_kernel_name(kernel));
+			}
+		}
+
+		auto select_aabb_kernel(cull_kernel kernel) -> aabb_kernel
+		{
+			switch (kernel)
+			{
+#ifdef LVK_CULL_X86
+			case cull_kernel::sse: return cull_aabbs_sse;
+			case cull_kernel::avx2: return cull_aabbs_avx2;
+#endif
+#ifdef LVK_CULL_NEON
+			case cull_kernel::neon: return cull_aabbs_neon;
+#endif
+			case cull_kernel::scalar: return cull_aabbs_scalar;
+			default: throw std::runtime_error(std::string{ "cull kernel not available: " } + cull_kernel_name(kernel));
+			}
+		}
+
+		// runs cull_range(begin, end, out) over every chunk and squeezes the per chunk results together
+		template<typename F>
+		void cull_chunks(size_t count, std::vector<uint32_t>& visible, job_system* jobs, F&& cull_range)
+		{
+			visible.resize(count);
+			if (jobs == nullptr || count <= CULL_CHUNK_SIZE)
+			{
+				visible.resize(cull_range(0, count, visible.data()));
+				return;
+			}
+
+			auto chunk_count = (count + CULL_CHUNK_SIZE - 1) / CULL_CHUNK_SIZE;
+			std::vector<size_t> chunk_visible(chunk_count);
+			jobs->parallel_for(chunk_count, 1, [&](size_t first, size_t last) {
+				for (size_t chunk = first; chunk < last; chunk++)
+				{
+					auto begin = chunk * CULL_CHUNK_SIZE;
+					auto end = std::min(begin + CULL_CHUNK_SIZE, count);
+					chunk_visible[chunk] = cull_range(begin, end, visible.data() + begin);
+				}
+			});
+
+			size_t total = 0;
+			for (size_t chunk = 0; chunk < chunk_count; chunk++)
+			{
+				auto begin = chunk * CULL_CHUNK_SIZE;
+				if (total != begin)
+				{
+					std::memmove(visible.data() + total, visible.data() + begin, chunk_visible[chunk] * sizeof(uint32_t));
+				}
+				total += chunk_visible[chunk];
+			}
+			visible.resize(total);
+		}
+	}
+
+	auto frustum::from_matrix(const glm::mat4& view_projection) -> frustum
+	{
+		// gribb/hartmann, with the near plane at z = 0 instead of z = -w
+		auto row = [&](int i) {
+			return glm::vec4{ view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i] };
+		};
+
+		frustum result;
+		result.planes = {
+			row(3) + row(0),
+			row(3) - row(0),
+			row(3) + row(1),
+			row(3) - row(1),
+			row(2),
+			row(3) - row(2),
+		};
+
+		for (auto& plane : result.planes)
+		{
+			plane /= std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		}
+		return result;
+	}
+
+	void sphere_bounds::push_back(glm::vec3 center, float r)
+	{
+		x.push_back(center.x);
+		y.push_back(center.y);
+		z.push_back(center.z);
+		radius.push_back(r);
+	}
+
+	void sphere_bounds::clear()
+	{
+		x.clear();
+		y.clear();
+		z.clear();
+		radius.clear();
+	}
+
+	void aabb_bounds::push_back(glm::vec3 min, glm::vec3 max)
+	{
+		center_x.push_back((min.x + max.x) * 0.5f);
+		center_y.push_back((min.y + max.y) * 0.5f);
+		center_z.push_back((min.z + max.z) * 0.5f);
+		extent_x.push_back((max.x - min.x) * 0.5f);
+		extent_y.push_back((max.y - min.y) * 0.5f);
+		extent_z.push_back((max.z - min.z) * 0.5f);
+	}
+
+	void aabb_bounds::clear()
+	{
+		center_x.clear();
+		center_y.clear();
+		center_z.clear();
+		extent_x.clear();
+		extent_y.clear();
+		extent_z.clear();
+	}
+
+	auto cull_kernel_name(cull_kernel kernel) -> const char*
+	{
+		switch (kernel)
+		{
+		case cull_kernel::scalar: return "scalar";
+		case cull_kernel::sse: return "sse";
+		case cull_kernel::avx2: return "avx2";
+		case cull_kernel::neon: return "neon";
+		}
+		return "unknown";
+	}
+
+	auto available_cull_kernels() -> std::vector<cull_kernel>
+	{
+		std::vector<cull_kernel> kernels{ cull_kernel::scalar };
+#ifdef LVK_CULL_X86
+		// sse2 is part of every x86-64 cpu
+		kernels.push_back(cull_kernel::sse);
+		if (cpu_supports_avx2())
+		{
+			kernels.push_back(cull_kernel::avx2);
+		}
+#endif
+#ifdef LVK_CULL_NEON
+		kernels.push_back(cull_kernel::neon);
+#endif
+		return kernels;
+	}
+
+	auto active_cull_kernel() -> cull_kernel
+	{
+		static const cull_kernel kernel = [] {
+			auto kernels = available_cull_kernels();
+			if (const char* requested = std::getenv("LVK_CULL_KERNEL"))
+			{
+				for (auto candidate : kernels)
+				{
+					if (std::string_view{ requested } == cull_kernel_name(candidate))
+					{
+						return candidate;
+					}
+				}
+				std::cerr << "LVK_CULL_KERNEL=" << requested << " isn't available here, ignoring it" << std::endl;
+			}
+			return kernels.back();
+		}();
+		return kernel;
+	}
+
+	void cull_spheres(const frustum& view, const sphere_bounds& bounds, std::vector<uint32_t>& visible, job_system* jobs, cull_kernel kernel)
+	{
+		LVK_TRACE_SCOPE("cull spheres");
+
+		auto cull = select_sphere_kernel(kernel);
+		sphere_columns columns{ bounds.x.data(), bounds.y.data(), bounds.z.data(), bounds.radius.data() };
+		cull_chunks(bounds.size(), visible, jobs, [&](size_t begin, size_t end, uint32_t* out) {
+			return cull(view, columns, begin, end, out);
+		});
+	}
+
+	void cull_aabbs(const frustum& view, const aabb_bounds& bounds, std::vector<uint32_t>& visible, job_system* jobs, cull_kernel kernel)
+	{
+		LVK_TRACE_SCOPE("cull aabbs");
+
+		auto cull = select_aabb_kernel(kernel);
+		aabb_columns columns{
+			bounds.center_x.data(), bounds.center_y.data(), bounds.center_z.data(),
+			bounds.extent_x.data(), bounds.extent_y.data(), bounds.extent_z.data(),
+		};
+		cull_chunks(bounds.size(), visible, jobs, [&](size_t begin, size_t end, uint32_t* out) {
+			return cull(view, columns, begin, end, out);
+		});
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lvk
+{
+	class job_system;
+
+	// the six planes of a view frustum as (normal, distance), normals point inwards
+	// and are normalized. a point p is inside a plane when dot(normal, p) + distance >= 0
+	struct frustum
+	{
+		std::array<glm::vec4, 6> planes;
+
+		// extracts the planes from a view projection matrix with vulkan's 0..1 clip depth
+		static auto from_matrix(const glm::mat4& view_projection) -> frustum;
+	};
+
+	// bounding spheres as structure of arrays, so the kernels can load several at once
+	struct sphere_bounds
+	{
+		std::vector<float> x, y, z, radius;
+
+		void push_back(glm::vec3 center, float r);
+		void clear();
+		auto size() const -> size_t
+		{
+			return x.size();
+		}
+	};
+
+	// axis aligned boxes as center and half extents, which is what the plane test wants
+	struct aabb_bounds
+	{
+		std::vector<float> center_x, center_y, center_z;
+		std::vector<float> extent_x, extent_y, extent_z;
+
+		void push_back(glm::vec3 min, glm::vec3 max);
+		void clear();
+		auto size() const -> size_t
+		{
+			return center_x.size();
+		}
+	};
+
+	enum class cull_kernel
+	{
+		scalar,
+		sse,
+		avx2,
+		neon,
+	};
+
+	auto cull_kernel_name(cull_kernel kernel) -> const char*;
+
+	// every kernel the running cpu can execute, slowest first
+	auto available_cull_kernels() -> std::vector<cull_kernel>;
+
+	// the fastest available kernel, picked once on first use. LVK_CULL_KERNEL=scalar|sse|avx2|neon
+	// overrides it (if the cpu supports it)
+	auto active_cull_kernel() -> cull_kernel;
+
+	// fills visible with the indices of every bound that intersects the frustum, in ascending order.
+	// chunks get spread over the job workers when a job system is passed in.
+	// visible is reused as scratch, keeping it around between calls avoids reallocating
+	void cull_spheres(
+		const frustum& view,
+		const sphere_bounds& bounds,
+		std::vector<uint32_t>& visible,
+		job_system* jobs = nullptr,
+		cull_kernel kernel = active_cull_kernel()
+	);
+	void cull_aabbs(
+		const frustum& view,
+		const aabb_bounds& bounds,
+		std::vector<uint32_t>& visible,
+		job_system* jobs = nullptr,
+		cull_kernel kernel = active_cull_kernel()
+	);
+}
@@ -0,0 +1,114 @@
+#include "deletion_queue.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace lvk
+{
+	deletion_queue::deletion_queue(VkDevice _device) : device{ _device }
+	{
+	}
+
+	deletion_queue::~deletion_queue()
+	{
+		// the owner flushes after waiting for the device, this only catches what came after that
+		flush();
+	}
+
+	auto deletion_queue::submitted(VkFence fence) -> uint64_t
+	{
+		std::lock_guard lock{ mutex };
+		in_flight.push_back({ ++last_value, fence });
+		return last_value;
+	}
+
+	void deletion_queue::retired(uint64_t submission)
+	{
+		std::lock_guard lock{ mutex };
+		std::erase_if(in_flight, [&](const auto& s) { return s.value == submission; });
+	}
+
+	auto deletion_queue::last_submitted() const -> uint64_t
+	{
+		std::lock_guard lock{ mutex };
+		return last_value;
+	}
+
+	auto deletion_queue::completed() const -> uint64_t
+	{
+		std::lock_guard lock{ mutex };
+		return completed_locked();
+	}
+
+	void deletion_queue::defer(std::function<void()> destroy)
+	{
+		std::lock_guard lock{ mutex };
+		deletions.push_back({ last_value, std::move(destroy) });
+	}
+
+	void deletion_queue::defer(uint64_t last_use, std::function<void()> destroy)
+	{
+		std::lock_guard lock{ mutex };
+		deletions.push_back({ last_use, std::move(destroy) });
+	}
+
+	void deletion_queue::collect()
+	{
+		std::vector<deletion> due;
+		{
+			std::lock_guard lock{ mutex };
+			std::erase_if(in_flight, [&](const auto& s) { return vkGetFenceStatus(device, s.fence) == VK_SUCCESS; });
+
+			// submissions can finish out of order across queues, so only what's older than
+			// the oldest one still running counts as done
+			auto done = completed_locked();
+			auto first_due = std::stable_partition(deletions.begin(), deletions.end(), [&](const auto& d) {
+				return d.last_use > done;
+			});
+			due.assign(std::make_move_iterator(first_due), std::make_move_iterator(deletions.end()));
+			deletions.erase(first_due, deletions.end());
+		}
+
+		if (!due.empty())
+		{
+			LVK_TRACE_SCOPE("deferred destroy");
+			for (auto& d : due)
+			{
+				d.destroy();
+			}
+		}
+	}
+
+	void deletion_queue::flush()
+	{
+		std::vector<deletion> all;
+		{
+			std::lock_guard lock{ mutex };
+			in_flight.clear();
+			all.swap(deletions);
+		}
+		for (auto& d : all)
+		{
+			d.destroy();
+		}
+	}
+
+	auto deletion_queue::pending() const -> size_t
+	{
+		std::lock_guard lock{ mutex };
+		return deletions.size();
+	}
+
+	auto deletion_queue::completed_locked() const -> uint64_t
+	{
+		if (in_flight.empty())
+		{
+			return last_value;
+		}
+		auto oldest = std::min_element(in_flight.begin(), in_flight.end(), [](const auto& a, const auto& b) {
+			return a.value < b.value;
+		});
+		return oldest->value - 1;
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace lvk
+{
+	// destroys vulkan objects once the gpu is done with them instead of waiting for the whole device.
+	// every queue submission gets the next value of a counter, and a deferred destruction waits for
+	// every submission up to the value the object was last used in. submissions retire when whoever
+	// waits on their fence says so (the swap chain does before reusing it) or when collect finds the
+	// fence signaled. thread safe, destructions run on whichever thread calls collect
+	class deletion_queue
+	{
+	public:
+		explicit deletion_queue(VkDevice _device);
+		~deletion_queue();
+
+		deletion_queue(const deletion_queue&) = delete;
+		deletion_queue& operator=(const deletion_queue&) = delete;
+
+		// tags a queue submission whose fence gets signaled when it's done, returns its value.
+		// the fence has to stay alive and not get reset until the submission was retired
+		auto submitted(VkFence fence) -> uint64_t;
+		// the submission is known to be finished, e.g. its fence was just waited on
+		void retired(uint64_t submission);
+
+		// value of the newest submission, anything recorded before it is covered by it
+		auto last_submitted() const -> uint64_t;
+		// every submission up to this one has finished
+		auto completed() const -> uint64_t;
+
+		// destroy runs once everything submitted so far has finished
+		void defer(std::function<void()> destroy);
+		// destroy runs once the submission last_use and every one before it has finished
+		void defer(uint64_t last_use, std::function<void()> destroy);
+
+		// retires signaled submissions and runs what's due, once a frame is plenty
+		void collect();
+		// runs everything left, only once the device is idle
+		void flush();
+
+		auto pending() const -> size_t;
+
+	private:
+		struct submission
+		{
+			uint64_t value;
+			VkFence fence;
+		};
+
+		struct deletion
+		{
+			uint64_t last_use;
+			std::function<void()> destroy;
+		};
+
+		auto completed_locked() const -> uint64_t;
+
+		VkDevice device;
+		mutable std::mutex mutex;
+		uint64_t last_value = 0;
+		std::vector<submission> in_flight;
+		std::vector<deletion> deletions;
+	};
+}
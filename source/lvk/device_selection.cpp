@@ -0,0 +1,213 @@
+#include "device_selection.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <sstream>
+
+namespace lvk
+{
+	namespace
+	{
+		// vram counts in whole gib up to this cap, so a huge shared heap on an
+		// integrated gpu can never make up for the device type difference
+		constexpr int64_t MAX_SCORED_VRAM_GIB = 32;
+
+		auto type_score(VkPhysicalDeviceType type) -> int64_t
+		{
+			switch (type)
+			{
+			case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+				return 40000;
+			case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+				return 30000;
+			case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+				return 20000;
+			case VK_PHYSICAL_DEVICE_TYPE_CPU:
+				return 0;
+			default:
+				return 10000;
+			}
+		}
+
+		auto to_lower(std::string_view text) -> std::string
+		{
+			std::string result{ text };
+			std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) {
+				return static_cast<char>(std::tolower(c));
+			});
+			return result;
+		}
+
+		// strips dashes and lowercases, returns an empty string if it isn't a uuid
+		auto normalize_uuid(std::string_view text) -> std::string
+		{
+			std::string digits;
+			for (char c : text)
+			{
+				if (c == '-')
+				{
+					continue;
+				}
+				if (!std::isxdigit(static_cast<unsigned char>(c)))
+				{
+					return {};
+				}
+				digits.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+			}
+			return digits.size() == VK_UUID_SIZE * 2 ? digits : std::string{};
+		}
+	}
+
+	auto score_device(const device_candidate& candidate) -> int64_t
+	{
+		if (!candidate.is_suitable())
+		{
+			return -1;
+		}
+
+		int64_t score = type_score(candidate.type);
+
+		auto vram_gib = static_cast<int64_t>(candidate.device_local_bytes >> 30);
+		score += std::min(vram_gib, MAX_SCORED_VRAM_GIB) * 100;
+
+		// bigger render targets are a decent proxy for how capable the hardware is
+		score += candidate.max_image_dimension_2d / 1024;
+
+		// extra queues mean uploads and compute can overlap rendering
+		if (candidate.has_dedicated_transfer_queue)
+		{
+			score += 200;
+		}
+		if (candidate.has_async_compute_queue)
+		{
+			score += 200;
+		}
+		// one queue family for both avoids ownership transfers on the swap chain images
+		if (candidate.graphics_can_present)
+		{
+			score += 100;
+		}
+
+		return score;
+	}
+
+	void rank_devices(std::vector<device_candidate>& candidates)
+	{
+		for (auto& candidate : candidates)
+		{
+			candidate.score = score_device(candidate);
+		}
+
+		// stable so equally scored devices keep the driver's enumeration order
+		std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+			return a.score > b.score;
+		});
+	}
+
+	auto find_device(const std::vector<device_candidate>& candidates, std::string_view selector)
+		-> const device_candidate*
+	{
+		if (selector.empty())
+		{
+			return nullptr;
+		}
+
+		uint32_t index;
+		auto [end, error] = std::from_chars(selector.data(), selector.data() + selector.size(), index);
+		if (error == std::errc{} && end == selector.data() + selector.size())
+		{
+			auto found = std::find_if(candidates.begin(), candidates.end(), [&](const auto& candidate) {
+				return candidate.index == index;
+			});
+			return found != candidates.end() ? &*found : nullptr;
+		}
+
+		if (auto uuid = normalize_uuid(selector); !uuid.empty())
+		{
+			for (const auto& candidate : candidates)
+			{
+				if (candidate.has_uuid && normalize_uuid(format_uuid(candidate.uuid)) == uuid)
+				{
+					return &candidate;
+				}
+			}
+		}
+
+		// candidates are ranked, so a partial name picks the best device that matches
+		auto name = to_lower(selector);
+		for (const auto& candidate : candidates)
+		{
+			if (to_lower(candidate.name).find(name) != std::string::npos)
+			{
+				return &candidate;
+			}
+		}
+
+		return nullptr;
+	}
+
+	auto format_uuid(const std::array<uint8_t, VK_UUID_SIZE>& uuid) -> std::string
+	{
+		std::string result;
+		char digits[3];
+		for (size_t i = 0; i < uuid.size(); i++)
+		{
+			if (i == 4 || i == 6 || i == 8 || i == 10)
+			{
+				result.push_back('-');
+			}
+			std::snprintf(digits, sizeof(digits), "%02x", uuid[i]);
+			result += digits;
+		}
+		return result;
+	}
+
+	auto device_type_name(VkPhysicalDeviceType type) -> const char*
+	{
+		switch (type)
+		{
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+			return "discrete";
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+			return "integrated";
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+			return "virtual";
+		case VK_PHYSICAL_DEVICE_TYPE_CPU:
+			return "cpu";
+		default:
+			return "other";
+		}
+	}
+
+	auto format_device_ranking(const std::vector<device_candidate>& candidates, const device_candidate& selected)
+		-> std::string
+	{
+		std::ostringstream out;
+		out << "physical devices:\n";
+		for (const auto& candidate : candidates)
+		{
+			out << (&candidate == &selected ? "  * " : "    ")
+				<< '[' << candidate.index << "] " << candidate.name
+				<< " (" << device_type_name(candidate.type)
+				<< ", " << (candidate.device_local_bytes >> 20) << " MiB";
+			if (candidate.has_uuid)
+			{
+				out << ", " << format_uuid(candidate.uuid);
+			}
+			out << ')';
+
+			if (candidate.is_suitable())
+			{
+				out << " score " << candidate.score;
+			}
+			else
+			{
+				out << " rejected: " << candidate.rejection;
+			}
+			out << '\n';
+		}
+		return out.str();
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lvk
+{
+	// everything device selection looks at, gathered once per physical device
+	struct device_candidate
+	{
+		uint32_t index;
+		std::string name;
+		VkPhysicalDeviceType type;
+		// only known when VK_KHR_get_physical_device_properties2 is available
+		std::array<uint8_t, VK_UUID_SIZE> uuid{};
+		bool has_uuid = false;
+		VkDeviceSize device_local_bytes = 0;
+		uint32_t max_image_dimension_2d = 0;
+		bool has_dedicated_transfer_queue = false;
+		bool has_async_compute_queue = false;
+		bool graphics_can_present = false;
+		// empty when the device can run the app at all
+		std::string rejection;
+		int64_t score = 0;
+
+		bool is_suitable() const
+		{
+			return rejection.empty();
+		}
+	};
+
+	// higher is better. the device type dominates, so a discrete gpu always beats an integrated one
+	// and anything beats a software rasterizer, the rest only breaks ties within the same type
+	auto score_device(const device_candidate& candidate) -> int64_t;
+
+	// scores every candidate and sorts them best first, rejected devices go last
+	void rank_devices(std::vector<device_candidate>& candidates);
+
+	// finds the candidate picked by an override, which is either an enumeration index,
+	// a device uuid (32 hex digits, dashes allowed) or a case insensitive part of the name.
+	// returns nullptr if nothing matches
+	auto find_device(const std::vector<device_candidate>& candidates, std::string_view selector)
+		-> const device_candidate*;
+
+	auto format_uuid(const std::array<uint8_t, VK_UUID_SIZE>& uuid) -> std::string;
+	auto device_type_name(VkPhysicalDeviceType type) -> const char*;
+
+	// one line per candidate, the selected one marked with a *
+	auto format_device_ranking(const std::vector<device_candidate>& candidates, const device_candidate& selected)
+		-> std::string;
+}
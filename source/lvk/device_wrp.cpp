@@ -1,6 +1,11 @@
 #include "device_wrp.hpp"
+#include "startup_timer.hpp"
+#include "trace.hpp"
 
 // std headers
+#include <algorithm>
+#include <array>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <set>
@@ -8,156 +13,167 @@
 
 namespace lvk
 {
-
-	// local callback functions
-	static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
-		VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
-		VkDebugUtilsMessageTypeFlagsEXT messageType,
-		const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData,
-		void *pUserData)
-	{
-		std::cerr << "validation layer: " << pCallbackData->pMessage << std::endl;
-
-		return VK_FALSE;
-	}
-
-	VkResult CreateDebugUtilsMessengerEXT(
-		VkInstance instance,
-		const VkDebugUtilsMessengerCreateInfoEXT *pCreateInfo,
-		const VkAllocationCallbacks *pAllocator,
-		VkDebugUtilsMessengerEXT *pDebugMessenger)
+	// class member functions
+	device_wrp::device_wrp(instance_wrp &_instance, surface_wrp &surface, std::string _device_selector)
+		: instance{_instance}, device_selector{std::move(_device_selector)}
 	{
-		auto func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(
-			instance,
-			"vkCreateDebugUtilsMessengerEXT");
-		if (func != nullptr)
 		{
-			return func(instance, pCreateInfo, pAllocator, pDebugMessenger);
+			startup_phase phase{"device pick"};
+			pick_physical_device(surface);
 		}
-		else
 		{
-			return VK_ERROR_EXTENSION_NOT_PRESENT;
+			startup_phase phase{"logical device"};
+			create_logical_device();
+			create_command_pool();
+			create_memory_tracker();
+			deletions = std::make_unique<deletion_queue>(device);
+			barriers = std::make_unique<barrier_batch>(*this);
+			resources = std::make_unique<gpu_resources>(*this);
 		}
 	}
 
-	void DestroyDebugUtilsMessengerEXT(
-		VkInstance instance,
-		VkDebugUtilsMessengerEXT debugMessenger,
-		const VkAllocationCallbacks *pAllocator)
-	{
-		auto func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(
-			instance,
-			"vkDestroyDebugUtilsMessengerEXT");
-		if (func != nullptr)
-		{
-			func(instance, debugMessenger, pAllocator);
-		}
-	}
-
-	// class member functions
-	device_wrp::device_wrp(window_wrp &_window) : window{_window}
-	{
-		create_instance();
-		setup_debug_messenger();
-		create_surface();
-		pick_physical_device();
-		create_logical_device();
-		create_command_pool();
-	}
-
 	device_wrp::~device_wrp()
 	{
+		// whatever's still queued was deferred by objects destroyed after the last frame
+		vkDeviceWaitIdle(device);
+		resources.reset();
+		barriers.reset();
+		deletions.reset();
 		vkDestroyCommandPool(device, command_pool, nullptr);
-		vkDestroyDevice(device, nullptr);
-
-		if (enable_validation_layers)
+		// anything still allocated at this point leaked
+		if (auto leaked = memory->snapshot().allocations; leaked > 0)
 		{
-			DestroyDebugUtilsMessengerEXT(instance, debug_messenger, nullptr);
+			std::cerr << "device memory: " << leaked << " allocations were never freed\n";
 		}
-
-		vkDestroySurfaceKHR(instance, surface, nullptr);
-		vkDestroyInstance(instance, nullptr);
+		vkDestroyDevice(device, nullptr);
 	}
 
-	void device_wrp::create_instance()
+	void device_wrp::pick_physical_device(surface_wrp &surface)
 	{
-		if (enable_validation_layers && !check_validation_layer_support())
+		uint32_t deviceCount = 0;
+		vkEnumeratePhysicalDevices(instance.get_instance(), &deviceCount, nullptr);
+		if (deviceCount == 0)
 		{
-			throw std::runtime_error("validation layers requested, but not available!");
+			throw std::runtime_error("failed to find GPUs with Vulkan support!");
 		}
+		std::vector<VkPhysicalDevice> devices(deviceCount);
+		vkEnumeratePhysicalDevices(instance.get_instance(), &deviceCount, devices.data());
 
-		VkApplicationInfo appInfo = {};
-		appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-		appInfo.pApplicationName = "LittleVulkanEngine App";
-		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.pEngineName = "No Engine";
-		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
-
-		VkInstanceCreateInfo createInfo = {};
-		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-		createInfo.pApplicationInfo = &appInfo;
-
-		auto extensions = get_required_extensions();
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
-		createInfo.ppEnabledExtensionNames = extensions.data();
-
-		VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo;
-		if (enable_validation_layers)
+		std::vector<queue_family_indices> indices(deviceCount);
+		std::vector<device_candidate> candidates;
+		candidates.reserve(deviceCount);
+		for (uint32_t i = 0; i < deviceCount; i++)
 		{
-			createInfo.enabledLayerCount = static_cast<uint32_t>(validation_layers.size());
-			createInfo.ppEnabledLayerNames = validation_layers.data();
+			candidates.push_back(describe_physical_device(devices[i], i, surface, indices[i]));
+		}
+		rank_devices(candidates);
 
-			populate_debug_messenger_create_info(debugCreateInfo);
-			createInfo.pNext = (VkDebugUtilsMessengerCreateInfoEXT *)&debugCreateInfo;
+		// an explicit choice (cli, then LVK_DEVICE) beats the ranking, and has to exist
+		std::string selector = device_selector;
+		if (selector.empty())
+		{
+			if (const char *env = std::getenv("LVK_DEVICE"))
+			{
+				selector = env;
+			}
 		}
-		else
+
+		const device_candidate *selected = &candidates.front();
+		if (!selector.empty())
 		{
-			createInfo.enabledLayerCount = 0;
-			createInfo.pNext = nullptr;
+			selected = find_device(candidates, selector);
+			if (selected == nullptr)
+			{
+				std::cout << format_device_ranking(candidates, candidates.front());
+				throw std::runtime_error("no physical device matches \"" + selector + "\"");
+			}
 		}
 
-		if (vkCreateInstance(&createInfo, nullptr, &instance) != VK_SUCCESS)
+		std::cout << format_device_ranking(candidates, *selected);
+
+		if (!selected->is_suitable())
 		{
-			throw std::runtime_error("failed to create instance!");
+			throw std::runtime_error(
+				selector.empty() ? "failed to find a suitable GPU!"
+								 : "selected physical device " + selected->name + " is unsuitable: " + selected->rejection);
 		}
 
-		has_gflw_required_instance_extensions();
+		physical_device = devices[selected->index];
+		queue_families = indices[selected->index];
+		vkGetPhysicalDeviceProperties(physical_device, &properties);
 	}
 
-	void device_wrp::pick_physical_device()
+	device_candidate device_wrp::describe_physical_device(
+		VkPhysicalDevice device, uint32_t index, surface_wrp &surface, queue_family_indices &indices)
 	{
-		uint32_t deviceCount = 0;
-		vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
-		if (deviceCount == 0)
+		device_candidate candidate{};
+		candidate.index = index;
+
+		VkPhysicalDeviceProperties deviceProperties;
+		if (instance.has_physical_device_properties2())
 		{
-			throw std::runtime_error("failed to find GPUs with Vulkan support!");
+			auto getProperties2 = (PFN_vkGetPhysicalDeviceProperties2KHR)vkGetInstanceProcAddr(
+				instance.get_instance(),
+				"vkGetPhysicalDeviceProperties2KHR");
+
+			VkPhysicalDeviceIDProperties idProperties = {};
+			idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+			VkPhysicalDeviceProperties2 properties2 = {};
+			properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+			properties2.pNext = &idProperties;
+			getProperties2(device, &properties2);
+
+			deviceProperties = properties2.properties;
+			std::memcpy(candidate.uuid.data(), idProperties.deviceUUID, VK_UUID_SIZE);
+			candidate.has_uuid = true;
 		}
-		std::cout << "Device count: " << deviceCount << std::endl;
-		std::vector<VkPhysicalDevice> devices(deviceCount);
-		vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+		else
+		{
+			vkGetPhysicalDeviceProperties(device, &deviceProperties);
+		}
+
+		candidate.name = deviceProperties.deviceName;
+		candidate.type = deviceProperties.deviceType;
+		candidate.max_image_dimension_2d = deviceProperties.limits.maxImageDimension2D;
 
-		for (const auto &device : devices)
+		VkPhysicalDeviceMemoryProperties memoryProperties;
+		vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+		for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
 		{
-			if (is_device_suitable(device))
+			if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
 			{
-				physical_device = device;
-				break;
+				candidate.device_local_bytes += memoryProperties.memoryHeaps[i].size;
 			}
 		}
 
-		if (physical_device == VK_NULL_HANDLE)
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+		for (const auto &queueFamily : queueFamilies)
+		{
+			bool graphics = queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT;
+			bool compute = queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT;
+			bool transfer = queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT;
+			candidate.has_dedicated_transfer_queue |= transfer && !graphics && !compute;
+			candidate.has_async_compute_queue |= compute && !graphics;
+		}
+
+		// the limit check needs the window, everything else is in is_device_suitable
+		auto extent = surface.get_window().get_extent();
+		if (is_device_suitable(device, surface.get_surface(), indices, candidate.rejection) &&
+			std::max(extent.width, extent.height) > candidate.max_image_dimension_2d)
 		{
-			throw std::runtime_error("failed to find a suitable GPU!");
+			candidate.rejection = "max image size is smaller than the window";
 		}
+		candidate.graphics_can_present = candidate.is_suitable() && indices.graphics_family == indices.present_family;
 
-		vkGetPhysicalDeviceProperties(physical_device, &properties);
-		std::cout << "physical get_device: " << properties.deviceName << std::endl;
+		return candidate;
 	}
 
 	void device_wrp::create_logical_device()
 	{
-		queue_family_indices indices = find_queue_families(physical_device);
+		queue_family_indices indices = queue_families;
 
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 		std::set<uint32_t> uniqueQueueFamilies = {indices.graphics_family, indices.present_family};
@@ -182,16 +198,130 @@ namespace lvk
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
-		createInfo.pEnabledFeatures = &deviceFeatures;
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(device_extensions.size());
-		createInfo.ppEnabledExtensionNames = device_extensions.data();
+		// optional extensions come with feature structs of their own, which can only be
+		// queried and enabled through a features2 chain
+		auto available = get_available_device_extensions(physical_device);
+		std::vector<const char *> enabledExtensions = device_extensions;
+
+		// no feature struct for this one, it only adds a struct to the memory properties2 query
+		if (available.count(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) && instance.has_physical_device_properties2())
+		{
+			enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+			optional_features.memory_budget = true;
+		}
+
+		VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+		presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+		VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+		presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+		VkPhysicalDeviceConditionalRenderingFeaturesEXT conditionalRenderingFeatures = {};
+		conditionalRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONDITIONAL_RENDERING_FEATURES_EXT;
+		VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
+		dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+		VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features = {};
+		synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+
+		VkPhysicalDeviceFeatures2 features2 = {};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+
+		if (available.count(VK_KHR_PRESENT_ID_EXTENSION_NAME) && available.count(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+		{
+			presentIdFeatures.pNext = features2.pNext;
+			features2.pNext = &presentIdFeatures;
+			presentWaitFeatures.pNext = features2.pNext;
+			features2.pNext = &presentWaitFeatures;
+		}
+
+		if (available.count(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME))
+		{
+			conditionalRenderingFeatures.pNext = features2.pNext;
+			features2.pNext = &conditionalRenderingFeatures;
+		}
+
+		// the instance is 1.0, so everything dynamic rendering was built on has to be enabled along with it
+		const std::array dynamicRenderingExtensions = {
+			VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
+			VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+			VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+			VK_KHR_MULTIVIEW_EXTENSION_NAME,
+			VK_KHR_MAINTENANCE2_EXTENSION_NAME,
+		};
+		auto *dynamicRenderingSetting = std::getenv("LVK_DYNAMIC_RENDERING");
+		if ((!dynamicRenderingSetting || std::string{dynamicRenderingSetting} != "off") &&
+			std::all_of(dynamicRenderingExtensions.begin(), dynamicRenderingExtensions.end(), [&](const char *name) {
+				return available.count(name) > 0;
+			}))
+		{
+			dynamicRenderingFeatures.pNext = features2.pNext;
+			features2.pNext = &dynamicRenderingFeatures;
+		}
+
+		auto *synchronization2Setting = std::getenv("LVK_SYNC2");
+		if ((!synchronization2Setting || std::string{synchronization2Setting} != "off") &&
+			available.count(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME))
+		{
+			synchronization2Features.pNext = features2.pNext;
+			features2.pNext = &synchronization2Features;
+		}
+
+		if (features2.pNext != nullptr && instance.has_physical_device_properties2())
+		{
+			auto getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(
+				instance.get_instance(),
+				"vkGetPhysicalDeviceFeatures2KHR");
+			getFeatures2(physical_device, &features2);
+
+			// present wait is only any use together with present ids
+			if (presentIdFeatures.presentId && presentWaitFeatures.presentWait)
+			{
+				enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+				enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+				optional_features.present_wait = true;
+			}
+			else
+			{
+				presentIdFeatures.presentId = VK_FALSE;
+				presentWaitFeatures.presentWait = VK_FALSE;
+			}
+
+			if (conditionalRenderingFeatures.conditionalRendering)
+			{
+				enabledExtensions.push_back(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME);
+				optional_features.conditional_rendering = true;
+			}
+			// inherited conditional rendering is only for secondary command buffers, which aren't used
+			conditionalRenderingFeatures.inheritedConditionalRendering = VK_FALSE;
+
+			if (dynamicRenderingFeatures.dynamicRendering)
+			{
+				enabledExtensions.insert(enabledExtensions.end(), dynamicRenderingExtensions.begin(), dynamicRenderingExtensions.end());
+				optional_features.dynamic_rendering = true;
+			}
+
+			if (synchronization2Features.synchronization2)
+			{
+				enabledExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+				optional_features.synchronization2 = true;
+			}
+
+			// the queried core features get replaced by the ones actually used
+			features2.features = deviceFeatures;
+			createInfo.pNext = &features2;
+		}
+		else
+		{
+			createInfo.pEnabledFeatures = &deviceFeatures;
+		}
+
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+		createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
 		// might not really be necessary anymore because get_device specific validation layers
 		// have been deprecated
-		if (enable_validation_layers)
+		if (instance.enable_validation_layers)
 		{
-			createInfo.enabledLayerCount = static_cast<uint32_t>(validation_layers.size());
-			createInfo.ppEnabledLayerNames = validation_layers.data();
+			createInfo.enabledLayerCount = static_cast<uint32_t>(instance.get_validation_layers().size());
+			createInfo.ppEnabledLayerNames = instance.get_validation_layers().data();
 		}
 		else
 		{
@@ -223,131 +353,66 @@ namespace lvk
 		}
 	}
 
-	void device_wrp::create_surface()
-	{
-		window.create_window_surface(instance, &surface);
-	}
-
-	bool device_wrp::is_device_suitable(VkPhysicalDevice device)
+	void device_wrp::create_memory_tracker()
 	{
-		queue_family_indices indices = find_queue_families(device);
-
-		bool extensionsSupported = check_device_extension_support(device);
-
-		bool swapChainAdequate = false;
-		if (extensionsSupported)
+		PFN_vkGetPhysicalDeviceMemoryProperties2KHR getMemoryProperties2 = nullptr;
+		if (optional_features.memory_budget)
 		{
-			swap_chain_support_details swap_chain_support = query_swap_chain_support(device);
-			swapChainAdequate = !swap_chain_support.formats.empty() && !swap_chain_support.present_modes.empty();
+			getMemoryProperties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr(
+				instance.get_instance(),
+				"vkGetPhysicalDeviceMemoryProperties2KHR");
 		}
-
-		VkPhysicalDeviceFeatures supportedFeatures;
-		vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
-
-		return indices.is_complete() && extensionsSupported && swapChainAdequate &&
-			   supportedFeatures.samplerAnisotropy;
+		memory = std::make_unique<memory_tracker>(
+			physical_device, properties.limits.maxMemoryAllocationCount, getMemoryProperties2);
 	}
 
-	void device_wrp::populate_debug_messenger_create_info(
-		VkDebugUtilsMessengerCreateInfoEXT &createInfo)
+	bool device_wrp::supports_present(VkSurfaceKHR surface)
 	{
-		createInfo = {};
-		createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
-		createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
-									 VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
-		createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
-								 VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
-								 VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
-		createInfo.pfnUserCallback = debugCallback;
-		createInfo.pUserData = nullptr; // Optional
+		VkBool32 presentSupport = false;
+		vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, queue_families.present_family, surface, &presentSupport);
+		return presentSupport;
 	}
 
-	void device_wrp::setup_debug_messenger()
+	bool device_wrp::is_device_suitable(
+		VkPhysicalDevice device, VkSurfaceKHR surface, queue_family_indices &indices, std::string &rejection)
 	{
-		if (!enable_validation_layers)
-			return;
-		VkDebugUtilsMessengerCreateInfoEXT createInfo;
-		populate_debug_messenger_create_info(createInfo);
-		if (CreateDebugUtilsMessengerEXT(instance, &createInfo, nullptr, &debug_messenger) != VK_SUCCESS)
+		// cheapest checks first, so unsuitable candidates are rejected early
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
+		if (!supportedFeatures.samplerAnisotropy)
 		{
-			throw std::runtime_error("failed to set up debug messenger!");
+			rejection = "no sampler anisotropy";
+			return false;
 		}
-	}
-
-	bool device_wrp::check_validation_layer_support()
-	{
-		uint32_t layerCount;
-		vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
-
-		std::vector<VkLayerProperties> availableLayers(layerCount);
-		vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
-
-		for (const char *layerName : validation_layers)
+		if (!check_device_extension_support(device))
 		{
-			bool layerFound = false;
-
-			for (const auto &layerProperties : availableLayers)
-			{
-				if (strcmp(layerName, layerProperties.layerName) == 0)
-				{
-					layerFound = true;
-					break;
-				}
-			}
-
-			if (!layerFound)
-			{
-				return false;
-			}
+			rejection = "missing required device extensions";
+			return false;
 		}
 
-		return true;
-	}
-
-	std::vector<const char *> device_wrp::get_required_extensions()
-	{
-		uint32_t glfwExtensionCount = 0;
-		const char **glfwExtensions;
-		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-		std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
-
-		if (enable_validation_layers)
+		indices = find_queue_families(device, surface);
+		if (!indices.is_complete())
 		{
-			extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+			rejection = "no graphics or present queue";
+			return false;
 		}
 
-		return extensions;
-	}
-
-	void device_wrp::has_gflw_required_instance_extensions()
-	{
-		uint32_t extensionCount = 0;
-		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
-		std::vector<VkExtensionProperties> extensions(extensionCount);
-		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
-
-		std::cout << "available extensions:" << std::endl;
-		std::unordered_set<std::string> available;
-		for (const auto &extension : extensions)
-		{
-			std::cout << "\t" << extension.extensionName << std::endl;
-			available.insert(extension.extensionName);
-		}
+		// the swap chain only needs at least one format and present mode here,
+		// the full lists get queried when it is actually created
+		uint32_t formatCount = 0;
+		vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, nullptr);
+		uint32_t presentModeCount = 0;
+		vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, nullptr);
 
-		std::cout << "required extensions:" << std::endl;
-		auto requiredExtensions = get_required_extensions();
-		for (const auto &required : requiredExtensions)
+		if (formatCount == 0 || presentModeCount == 0)
 		{
-			std::cout << "\t" << required << std::endl;
-			if (available.find(required) == available.end())
-			{
-				throw std::runtime_error("Missing required glfw extension");
-			}
+			rejection = "no surface formats or present modes";
+			return false;
 		}
+		return true;
 	}
 
-	bool device_wrp::check_device_extension_support(VkPhysicalDevice device)
+	std::unordered_set<std::string> device_wrp::get_available_device_extensions(VkPhysicalDevice device)
 	{
 		uint32_t extensionCount;
 		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
@@ -359,17 +424,23 @@ namespace lvk
 			&extensionCount,
 			availableExtensions.data());
 
-		std::set<std::string> requiredExtensions(device_extensions.begin(), device_extensions.end());
-
+		std::unordered_set<std::string> available;
 		for (const auto &extension : availableExtensions)
 		{
-			requiredExtensions.erase(extension.extensionName);
+			available.insert(extension.extensionName);
 		}
+		return available;
+	}
 
-		return requiredExtensions.empty();
+	bool device_wrp::check_device_extension_support(VkPhysicalDevice device)
+	{
+		auto available = get_available_device_extensions(device);
+		return std::all_of(device_extensions.begin(), device_extensions.end(), [&](const char *required) {
+			return available.count(required) > 0;
+		});
 	}
 
-	queue_family_indices device_wrp::find_queue_families(VkPhysicalDevice device)
+	queue_family_indices device_wrp::find_queue_families(VkPhysicalDevice device, VkSurfaceKHR surface)
 	{
 		queue_family_indices indices;
 
@@ -386,6 +457,7 @@ namespace lvk
 			{
 				indices.graphics_family = i;
 				indices.graphics_family_has_value = true;
+				indices.graphics_has_compute = queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT;
 			}
 			VkBool32 presentSupport = false;
 			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
@@ -405,7 +477,7 @@ namespace lvk
 		return indices;
 	}
 
-	swap_chain_support_details device_wrp::query_swap_chain_support(VkPhysicalDevice device)
+	swap_chain_support_details device_wrp::query_swap_chain_support(VkPhysicalDevice device, VkSurfaceKHR surface)
 	{
 		swap_chain_support_details details;
 		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &details.capabilities);
@@ -457,26 +529,31 @@ namespace lvk
 
 	uint32_t device_wrp::find_memory_type(uint32_t typeFilter, VkMemoryPropertyFlags properties)
 	{
-		VkPhysicalDeviceMemoryProperties memProperties;
-		vkGetPhysicalDeviceMemoryProperties(physical_device, &memProperties);
-		for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
+		if (auto type = memory->find_type(typeFilter, properties))
 		{
-			if ((typeFilter & (1 << i)) &&
-				(memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-			{
-				return i;
-			}
+			return *type;
 		}
-
 		throw std::runtime_error("failed to find suitable memory type!");
 	}
 
+	VkDeviceMemory device_wrp::allocate_memory(
+		const VkMemoryRequirements &requirements, uint32_t memory_type, memory_category category)
+	{
+		return memory->allocate(device, requirements, memory_type, category);
+	}
+
+	void device_wrp::free_memory(VkDeviceMemory memory_handle)
+	{
+		memory->free(device, memory_handle);
+	}
+
 	void device_wrp::createBuffer(
 		VkDeviceSize size,
 		VkBufferUsageFlags usage,
 		VkMemoryPropertyFlags properties,
 		VkBuffer &buffer,
-		VkDeviceMemory &buffer_memory)
+		VkDeviceMemory &buffer_memory,
+		memory_category category)
 	{
 		VkBufferCreateInfo buffer_info{};
 		buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -492,15 +569,8 @@ namespace lvk
 		VkMemoryRequirements mem_requirements;
 		vkGetBufferMemoryRequirements(device, buffer, &mem_requirements);
 
-		VkMemoryAllocateInfo alloc_info{};
-		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		alloc_info.allocationSize = mem_requirements.size;
-		alloc_info.memoryTypeIndex = find_memory_type(mem_requirements.memoryTypeBits, properties);
-
-		if (vkAllocateMemory(device, &alloc_info, nullptr, &buffer_memory) != VK_SUCCESS)
-		{
-			throw std::runtime_error("failed to allocate vertex buffer memory!");
-		}
+		buffer_memory = allocate_memory(
+			mem_requirements, find_memory_type(mem_requirements.memoryTypeBits, properties), category);
 
 		vkBindBufferMemory(device, buffer, buffer_memory, 0);
 	}
@@ -526,6 +596,7 @@ namespace lvk
 
 	void device_wrp::end_single_time_commands(VkCommandBuffer command_buffer)
 	{
+		LVK_TRACE_SCOPE("single time commands");
 		vkEndCommandBuffer(command_buffer);
 
 		VkSubmitInfo submit_info{};
@@ -541,6 +612,7 @@ namespace lvk
 
 	void device_wrp::copyBuffer(VkBuffer src_buffer, VkBuffer dst_buffer, VkDeviceSize size)
 	{
+		LVK_TRACE_SCOPE("copy buffer");
 		VkCommandBuffer command_buffer = begin_single_time_commands();
 
 		VkBufferCopy copy_region{};
@@ -555,6 +627,7 @@ namespace lvk
 	void device_wrp::copyBufferToImage(
 		VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layer_count)
 	{
+		LVK_TRACE_SCOPE("copy buffer to image");
 		VkCommandBuffer command_buffer = begin_single_time_commands();
 
 		VkBufferImageCopy region{};
@@ -584,7 +657,8 @@ namespace lvk
 		const VkImageCreateInfo &image_info,
 		VkMemoryPropertyFlags properties,
 		VkImage &image,
-		VkDeviceMemory &image_memory)
+		VkDeviceMemory &image_memory,
+		memory_category category)
 	{
 		if (vkCreateImage(device, &image_info, nullptr, &image) != VK_SUCCESS)
 		{
@@ -594,15 +668,8 @@ namespace lvk
 		VkMemoryRequirements mem_requirements;
 		vkGetImageMemoryRequirements(device, image, &mem_requirements);
 
-		VkMemoryAllocateInfo alloc_info{};
-		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		alloc_info.allocationSize = mem_requirements.size;
-		alloc_info.memoryTypeIndex = find_memory_type(mem_requirements.memoryTypeBits, properties);
-
-		if (vkAllocateMemory(device, &alloc_info, nullptr, &image_memory) != VK_SUCCESS)
-		{
-			throw std::runtime_error("failed to allocate image memory!");
-		}
+		image_memory = allocate_memory(
+			mem_requirements, find_memory_type(mem_requirements.memoryTypeBits, properties), category);
 
 		if (vkBindImageMemory(device, image, image_memory, 0) != VK_SUCCESS)
 		{
@@ -1,8 +1,16 @@
 #pragma once
 
-#include "window_wrp.hpp"
-
+#include "instance_wrp.hpp"
+#include "barrier_batch.hpp"
+#include "surface_wrp.hpp"
+#include "deletion_queue.hpp"
+#include "device_selection.hpp"
+#include "gpu_resources.hpp"
+#include "memory_tracker.hpp"
+
+#include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 namespace lvk
@@ -21,22 +29,39 @@ namespace lvk
 		uint32_t present_family;
 		bool graphics_family_has_value = false;
 		bool present_family_has_value = false;
+		// vulkan only promises compute on *some* graphics family, not necessarily this one
+		bool graphics_has_compute = false;
 		bool is_complete()
 		{
 			return graphics_family_has_value && present_family_has_value;
 		}
 	};
 
+	// optional device extensions and features, only set when they were actually enabled
+	struct optional_device_features
+	{
+		// VK_KHR_present_id together with VK_KHR_present_wait
+		bool present_wait = false;
+		// VK_EXT_memory_budget, see memory_tracker
+		bool memory_budget = false;
+		// VK_EXT_conditional_rendering, see occlusion_culler
+		bool conditional_rendering = false;
+		// VK_KHR_dynamic_rendering, swap chains draw without render passes and framebuffers then.
+		// LVK_DYNAMIC_RENDERING=off keeps it disabled
+		bool dynamic_rendering = false;
+		// VK_KHR_synchronization2, barrier_batch falls back to vkCmdPipelineBarrier without it.
+		// LVK_SYNC2=off keeps it disabled
+		bool synchronization2 = false;
+	};
+
 	class device_wrp
 	{
 	public:
-#ifdef NDEBUG
-		const bool enable_validation_layers = false;
-#else
-		const bool enable_validation_layers = true;
-#endif
-
-		explicit device_wrp(window_wrp &_window);
+		// surface is only used to pick a device that can present to it, other surfaces
+		// can share the device as long as supports_present says so.
+		// device_selector overrides the automatic choice, see find_device. when it's empty
+		// the LVK_DEVICE environment variable is used instead
+		device_wrp(instance_wrp &_instance, surface_wrp &surface, std::string _device_selector = {});
 		~device_wrp();
 
 		// Not copyable or movable
@@ -53,10 +78,6 @@ namespace lvk
 		{
 			return device;
 		}
-		VkSurfaceKHR get_surface()
-		{
-			return surface;
-		}
 		VkQueue get_graphics_queue()
 		{
 			return graphics_queue;
@@ -66,25 +87,60 @@ namespace lvk
 			return present_queue;
 		}
 
-		swap_chain_support_details get_swap_chain_support()
+		const optional_device_features &get_optional_features()
+		{
+			return optional_features;
+		}
+
+		swap_chain_support_details get_swap_chain_support(VkSurfaceKHR surface)
 		{
-			return query_swap_chain_support(physical_device);
+			return query_swap_chain_support(physical_device, surface);
 		}
+		// whether the present queue can present to a surface other than the one used for picking the device
+		bool supports_present(VkSurfaceKHR surface);
+		// uses the memory properties cached by the tracker
 		uint32_t find_memory_type(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+
+		// all device memory should be allocated and freed through these so it shows up in the stats
+		VkDeviceMemory allocate_memory(
+			const VkMemoryRequirements &requirements, uint32_t memory_type, memory_category category);
+		void free_memory(VkDeviceMemory memory_handle);
+		memory_tracker &get_memory_tracker()
+		{
+			return *memory;
+		}
+		// objects that may still be used by submitted work get destroyed through this
+		deletion_queue &get_deletion_queue()
+		{
+			return *deletions;
+		}
+		// last access of every buffer and image used in command buffers, and the barriers still
+		// to be recorded for them
+		barrier_batch &get_barriers()
+		{
+			return *barriers;
+		}
+		// buffers, images and pipelines behind generational handles
+		gpu_resources &get_resources()
+		{
+			return *resources;
+		}
 		queue_family_indices find_physical_queue_families()
 		{
-			return find_queue_families(physical_device);
+			return queue_families;
 		}
 		VkFormat find_supported_format(
 			const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
 		// Buffer Helper Functions
+		// the caller owns what these create, get_resources hands out handles instead
 		void createBuffer(
 			VkDeviceSize size,
 			VkBufferUsageFlags usage,
 			VkMemoryPropertyFlags properties,
 			VkBuffer &buffer,
-			VkDeviceMemory &buffer_memory);
+			VkDeviceMemory &buffer_memory,
+			memory_category category = memory_category::buffer);
 		VkCommandBuffer begin_single_time_commands();
 		void end_single_time_commands(VkCommandBuffer command_buffer);
 		void copyBuffer(VkBuffer src_buffer, VkBuffer dst_buffer, VkDeviceSize size);
@@ -95,40 +151,42 @@ namespace lvk
 			const VkImageCreateInfo &image_info,
 			VkMemoryPropertyFlags properties,
 			VkImage &image,
-			VkDeviceMemory &image_memory);
+			VkDeviceMemory &image_memory,
+			memory_category category = memory_category::image);
 
 		VkPhysicalDeviceProperties properties;
 
 	private:
-		void create_instance();
-		void setup_debug_messenger();
-		void create_surface();
-		void pick_physical_device();
+		void pick_physical_device(surface_wrp &surface);
 		void create_logical_device();
 		void create_command_pool();
+		void create_memory_tracker();
 
 		// helper functions
-		bool is_device_suitable(VkPhysicalDevice device);
-		std::vector<const char *> get_required_extensions();
-		bool check_validation_layer_support();
-		queue_family_indices find_queue_families(VkPhysicalDevice device);
-		void populate_debug_messenger_create_info(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
-		void has_gflw_required_instance_extensions();
+		bool is_device_suitable(
+			VkPhysicalDevice device, VkSurfaceKHR surface, queue_family_indices &indices, std::string &rejection);
+		device_candidate describe_physical_device(
+			VkPhysicalDevice device, uint32_t index, surface_wrp &surface, queue_family_indices &indices);
+		queue_family_indices find_queue_families(VkPhysicalDevice device, VkSurfaceKHR surface);
+		std::unordered_set<std::string> get_available_device_extensions(VkPhysicalDevice device);
 		bool check_device_extension_support(VkPhysicalDevice device);
-		swap_chain_support_details query_swap_chain_support(VkPhysicalDevice device);
+		swap_chain_support_details query_swap_chain_support(VkPhysicalDevice device, VkSurfaceKHR surface);
 
-		VkInstance instance;
-		VkDebugUtilsMessengerEXT debug_messenger;
+		instance_wrp &instance;
 		VkPhysicalDevice physical_device = VK_NULL_HANDLE;
-		window_wrp &window;
+		queue_family_indices queue_families;
+		optional_device_features optional_features;
+		std::string device_selector;
 		VkCommandPool command_pool;
+		std::unique_ptr<memory_tracker> memory;
+		std::unique_ptr<deletion_queue> deletions;
+		std::unique_ptr<barrier_batch> barriers;
+		std::unique_ptr<gpu_resources> resources;
 
 		VkDevice device;
-		VkSurfaceKHR surface;
 		VkQueue graphics_queue;
 		VkQueue present_queue;
 
-		const std::vector<const char *> validation_layers = {"VK_LAYER_KHRONOS_validation"};
 		const std::vector<const char *> device_extensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 	};
 
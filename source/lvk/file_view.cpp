@@ -0,0 +1,252 @@
+#include "file_view.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lvk
+{
+	file_view::file_view(const std::string& path, mode _mode)
+	{
+		if (_mode == mode::map && try_map(path))
+		{
+			return;
+		}
+		stream_file(path);
+	}
+
+	file_view::~file_view()
+	{
+		release();
+	}
+
+	file_view::file_view(file_view&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	file_view& file_view::operator=(file_view&& other) noexcept
+	{
+		if (this != &other)
+		{
+			release();
+
+			data = std::exchange(other.data, nullptr);
+			size = std::exchange(other.size, 0);
+			mapped = std::exchange(other.mapped, false);
+#ifdef _WIN32
+			file_handle = std::exchange(other.file_handle, nullptr);
+			mapping_handle = std::exchange(other.mapping_handle, nullptr);
+#endif
+		}
+		return *this;
+	}
+
+#ifdef _WIN32
+	bool file_view::try_map(const std::string& path)
+	{
+		auto file = CreateFileA(
+			path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER file_size{};
+		if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+		{
+			// empty files can't be mapped, the streaming path deals with them
+			CloseHandle(file);
+			return false;
+		}
+
+		auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		auto* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (view == nullptr)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		data = static_cast<const std::byte*>(view);
+		size = static_cast<size_t>(file_size.QuadPart);
+		mapped = true;
+		file_handle = file;
+		mapping_handle = mapping;
+		return true;
+	}
+#else
+	bool file_view::try_map(const std::string& path)
+	{
+		// non blocking, so opening a fifo nobody writes to yet doesn't hang here. it's never
+		// mapped anyway
+		int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		struct stat file_stat{};
+		if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_size == 0)
+		{
+			// pipes, devices and empty files can't be mapped, stream_file reads them instead
+			close(fd);
+			return false;
+		}
+
+		auto file_size = static_cast<size_t>(file_stat.st_size);
+		void* view = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		// the mapping keeps its own reference to the file
+		close(fd);
+
+		if (view == MAP_FAILED)
+		{
+			return false;
+		}
+
+		// assets are consumed right after loading, so start faulting the pages in early
+		madvise(view, file_size, MADV_WILLNEED);
+
+		data = static_cast<const std::byte*>(view);
+		size = file_size;
+		mapped = true;
+		return true;
+	}
+#endif
+
+	void file_view::stream_file(const std::string& path)
+	{
+		// no std::ios::ate, opening fails altogether when the end can't be seeked to
+		std::ifstream file{ path, std::ios::binary };
+		if (!file.is_open())
+		{
+			throw std::runtime_error("failed to open file: " + path);
+		}
+
+		file.seekg(0, std::ios::end);
+		auto end = file.tellg();
+		if (end < 0)
+		{
+			// pipes and devices have no size, they get read until they run dry
+			file.clear();
+			stream_unsized(file, path);
+			return;
+		}
+
+		auto file_size = static_cast<size_t>(end);
+		if (file_size == 0)
+		{
+			return;
+		}
+
+		auto* buffer = static_cast<std::byte*>(::operator new(file_size, std::align_val_t{ BUFFER_ALIGNMENT }));
+
+		file.seekg(0);
+		if (!file.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(file_size)))
+		{
+			::operator delete(buffer, std::align_val_t{ BUFFER_ALIGNMENT });
+			throw std::runtime_error("failed to read file: " + path);
+		}
+
+		data = buffer;
+		size = file_size;
+		mapped = false;
+	}
+
+	void file_view::stream_unsized(std::ifstream& file, const std::string& path)
+	{
+		constexpr size_t FIRST_CHUNK = 64 * 1024;
+
+		auto allocate = [](size_t bytes) {
+			return static_cast<std::byte*>(::operator new(bytes, std::align_val_t{ BUFFER_ALIGNMENT }));
+		};
+		auto deallocate = [](std::byte* buffer) {
+			::operator delete(buffer, std::align_val_t{ BUFFER_ALIGNMENT });
+		};
+
+		size_t capacity = FIRST_CHUNK;
+		size_t used = 0;
+		auto* buffer = allocate(capacity);
+
+		// doubles whenever it's full, so every byte gets copied about once on average
+		while (true)
+		{
+			file.read(reinterpret_cast<char*>(buffer + used), static_cast<std::streamsize>(capacity - used));
+			used += static_cast<size_t>(file.gcount());
+			if (file.eof())
+			{
+				break;
+			}
+			if (!file)
+			{
+				deallocate(buffer);
+				throw std::runtime_error("failed to read file: " + path);
+			}
+
+			auto* grown = allocate(capacity * 2);
+			std::memcpy(grown, buffer, used);
+			deallocate(buffer);
+			buffer = grown;
+			capacity *= 2;
+		}
+
+		if (used == 0)
+		{
+			deallocate(buffer);
+			return;
+		}
+
+		data = buffer;
+		size = used;
+		mapped = false;
+	}
+
+	void file_view::release()
+	{
+		if (data == nullptr)
+		{
+			return;
+		}
+
+		if (mapped)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(data);
+			CloseHandle(mapping_handle);
+			CloseHandle(file_handle);
+			mapping_handle = nullptr;
+			file_handle = nullptr;
+#else
+			munmap(const_cast<std::byte*>(data), size);
+#endif
+		}
+		else
+		{
+			::operator delete(const_cast<std::byte*>(data), std::align_val_t{ BUFFER_ALIGNMENT });
+		}
+
+		data = nullptr;
+		size = 0;
+		mapped = false;
+	}
+}
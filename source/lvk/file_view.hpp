@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+namespace lvk
+{
+	// read only view of a whole file. the file gets memory mapped where possible, which
+	// hands out spans straight into the page cache without copying anything.
+	// if mapping isn't possible (or streaming is requested) the file is read into an
+	// aligned heap buffer instead, so callers never have to care which path was taken
+	class file_view
+	{
+	public:
+		enum class mode
+		{
+			map,
+			stream,
+		};
+
+		// alignment of the streaming buffer, mapped views are always page aligned
+		static constexpr size_t BUFFER_ALIGNMENT = 64;
+
+		explicit file_view(const std::string& path, mode _mode = mode::map);
+		~file_view();
+
+		file_view(const file_view&) = delete;
+		file_view& operator=(const file_view&) = delete;
+		file_view(file_view&& other) noexcept;
+		file_view& operator=(file_view&& other) noexcept;
+
+		auto bytes() const -> std::span<const std::byte>
+		{
+			return { data, size };
+		}
+
+		// reinterprets the file as an array of T, the file has to be a whole number of Ts
+		template<typename T>
+		auto as() const -> std::span<const T>
+		{
+			if (size % sizeof(T) != 0 || reinterpret_cast<uintptr_t>(data) % alignof(T) != 0)
+			{
+				throw std::runtime_error("file can't be viewed as an array of the requested type");
+			}
+			return { reinterpret_cast<const T*>(data), size / sizeof(T) };
+		}
+
+		bool is_mapped() const
+		{
+			return mapped;
+		}
+
+	private:
+		bool try_map(const std::string& path);
+		void stream_file(const std::string& path);
+		// for files without a size, like pipes
+		void stream_unsized(std::ifstream& file, const std::string& path);
+		void release();
+
+		const std::byte* data = nullptr;
+		size_t size = 0;
+		bool mapped = false;
+
+#ifdef _WIN32
+		void* file_handle = nullptr;
+		void* mapping_handle = nullptr;
+#endif
+	};
+}
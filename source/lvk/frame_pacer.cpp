@@ -0,0 +1,143 @@
+#include "frame_pacer.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+namespace lvk
+{
+	namespace
+	{
+		// long enough for any sane refresh rate, short enough that a minimized
+		// window (which may never present) doesn't freeze the app
+		constexpr uint64_t PRESENT_WAIT_TIMEOUT_NS = 100'000'000;
+
+		auto to_ms(std::chrono::steady_clock::duration duration) -> float
+		{
+			return std::chrono::duration<float, std::milli>(duration).count();
+		}
+
+		auto percentile(std::vector<float> samples, double p) -> float
+		{
+			auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(samples.size())));
+			auto nth = samples.begin() + static_cast<std::ptrdiff_t>(std::max<size_t>(rank, 1) - 1);
+			std::nth_element(samples.begin(), nth, samples.end());
+			return *nth;
+		}
+	}
+
+	frame_pacer::frame_pacer(device_wrp& _device, swap_chain_wrp& _swap_chain, bool force_fence)
+		: device{ _device }, swap_chain{ _swap_chain }, pacing_mode{ mode::fence }
+	{
+		if (!force_fence && device.get_optional_features().present_wait)
+		{
+			wait_for_present =
+				(PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(device.get_device(), "vkWaitForPresentKHR");
+			if (wait_for_present != nullptr)
+			{
+				pacing_mode = mode::present_wait;
+			}
+		}
+	}
+
+	void frame_pacer::wait_for_next_frame()
+	{
+		if (!previous.presented)
+		{
+			return;
+		}
+
+		LVK_TRACE_SCOPE("frame pacing");
+
+		if (pacing_mode == mode::present_wait)
+		{
+			auto result = wait_for_present(
+				device.get_device(), swap_chain.get_swap_chain(), previous.id, PRESENT_WAIT_TIMEOUT_NS);
+			if (result == VK_SUCCESS)
+			{
+				record_displayed(previous, clock::now());
+			}
+			else if (result != VK_TIMEOUT)
+			{
+				// some surfaces don't support waiting even if the device does
+				std::cerr << "frame pacer: vkWaitForPresentKHR failed, falling back to fences" << std::endl;
+				pacing_mode = mode::fence;
+			}
+		}
+
+		// without present wait the best guess for "on screen" is the gpu being done with the frame
+		if (pacing_mode == mode::fence)
+		{
+			auto fence = swap_chain.get_last_submit_fence();
+			vkWaitForFences(device.get_device(), 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+			record_displayed(previous, clock::now());
+		}
+
+		previous.presented = false;
+	}
+
+	void frame_pacer::mark_input_sampled(clock::time_point input_time)
+	{
+		current = frame_timing{ .id = ++frame_count, .input = input_time };
+	}
+
+	void frame_pacer::mark_submitted()
+	{
+		current.submit = clock::now();
+	}
+
+	auto frame_pacer::get_present_id() const -> uint64_t
+	{
+		return pacing_mode == mode::present_wait ? current.id : 0;
+	}
+
+	void frame_pacer::mark_presented()
+	{
+		current.present = clock::now();
+		current.presented = true;
+		previous = current;
+	}
+
+	void frame_pacer::record_displayed(const frame_timing& frame, clock::time_point displayed)
+	{
+		auto slot = displayed_count++ & (HISTORY_SIZE - 1);
+		to_submit[slot] = to_ms(frame.submit - frame.input);
+		to_present[slot] = to_ms(frame.present - frame.input);
+		to_display[slot] = to_ms(displayed - frame.input);
+	}
+
+	void frame_pacer::report() const
+	{
+		if (displayed_count == 0)
+		{
+			return;
+		}
+
+		// until the ring wraps only the front of it is filled
+		auto count = static_cast<size_t>(std::min<uint64_t>(displayed_count, HISTORY_SIZE));
+		std::cout << "frame latency over the last " << count << " frames ("
+				  << (pacing_mode == mode::present_wait ? "present wait" : "fence") << "):\n"
+				  << std::fixed << std::setprecision(2)
+				  << '\t' << std::setw(20) << ' '
+				  << std::setw(9) << "p50" << std::setw(9) << "p90" << std::setw(9) << "p99" << std::setw(9) << "max"
+				  << '\n';
+
+		auto print_row = [count](const char* name, const std::array<float, HISTORY_SIZE>& ring) {
+			auto samples = std::vector<float>(ring.begin(), ring.begin() + static_cast<std::ptrdiff_t>(count));
+			std::cout << '\t' << std::left << std::setw(20) << name << std::right
+					  << std::setw(9) << percentile(samples, 0.50)
+					  << std::setw(9) << percentile(samples, 0.90)
+					  << std::setw(9) << percentile(samples, 0.99)
+					  << std::setw(9) << *std::max_element(samples.begin(), samples.end())
+					  << " ms\n";
+		};
+		print_row("input -> submit", to_submit);
+		print_row("input -> present", to_present);
+		print_row("input -> display", to_display);
+
+		std::cout << std::defaultfloat << std::flush;
+	}
+}
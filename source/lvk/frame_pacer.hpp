@@ -0,0 +1,79 @@
+#pragma once
+
+#include "device_wrp.hpp"
+#include "swap_chain_wrp.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace lvk
+{
+	// keeps the cpu from running ahead of the display, so input gets sampled as late as possible.
+	// before sampling input for a frame it waits until the previous frame was presented
+	// (VK_KHR_present_wait) or, without that extension, until the gpu finished it.
+	// also records input sample -> submit -> present -> display timings of every frame.
+	//
+	// per frame usage, all from the thread that submits:
+	//   wait_for_next_frame, poll input, mark_input_sampled,
+	//   submit, mark_submitted, present tagged with get_present_id, mark_presented
+	class frame_pacer
+	{
+	public:
+		enum class mode
+		{
+			present_wait,
+			fence,
+		};
+
+		frame_pacer(device_wrp& _device, swap_chain_wrp& _swap_chain, bool force_fence = false);
+
+		frame_pacer(const frame_pacer&) = delete;
+		frame_pacer& operator=(const frame_pacer&) = delete;
+
+		void wait_for_next_frame();
+		// input can be sampled on another thread, see render_packet
+		void mark_input_sampled(std::chrono::steady_clock::time_point input_time = std::chrono::steady_clock::now());
+		void mark_submitted();
+		// the id to tag the current frame's present with, 0 if present wait isn't used
+		auto get_present_id() const -> uint64_t;
+		void mark_presented();
+
+		auto get_mode() const -> mode
+		{
+			return pacing_mode;
+		}
+
+		// prints latency percentiles over the last HISTORY_SIZE frames
+		void report() const;
+
+		// power of two, a minute at 60 hz is plenty for stable percentiles
+		static constexpr size_t HISTORY_SIZE = 4096;
+
+	private:
+		using clock = std::chrono::steady_clock;
+
+		struct frame_timing
+		{
+			uint64_t id = 0;
+			clock::time_point input, submit, present;
+			bool presented = false;
+		};
+
+		void record_displayed(const frame_timing& frame, clock::time_point displayed);
+
+		device_wrp& device;
+		swap_chain_wrp& swap_chain;
+		mode pacing_mode;
+		PFN_vkWaitForPresentKHR wait_for_present = nullptr;
+
+		frame_timing previous, current;
+		uint64_t frame_count = 0;
+
+		// latencies in ms, all measured from input sampling. rings over the last HISTORY_SIZE
+		// frames, so a long session doesn't grow them forever
+		std::array<float, HISTORY_SIZE> to_submit{}, to_present{}, to_display{};
+		uint64_t displayed_count = 0;
+	};
+}
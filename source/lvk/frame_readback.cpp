@@ -0,0 +1,225 @@
+#include "frame_readback.hpp"
+#include "image_writer.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace lvk
+{
+	bool write_frame(const std::string& path, const readback_frame& frame)
+	{
+		auto image = image_rgba8{
+			.width = frame.width,
+			.height = frame.height,
+			.pixels = frame.pixels,
+			.swap_red_blue = frame.is_bgra,
+		};
+
+		if (path.ends_with(".ppm"))
+		{
+			return write_ppm(path, image);
+		}
+		return write_png(path, image);
+	}
+
+	frame_readback::frame_readback(device_wrp& _device, swap_chain_wrp& _swap_chain)
+		: device{ _device }, swap_chain{ _swap_chain }
+	{
+		if (!swap_chain.supports_transfer_src())
+		{
+			throw std::runtime_error("swap chain images can't be copied from on this surface");
+		}
+
+		switch (swap_chain.get_swap_chain_image_format())
+		{
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			is_bgra = true;
+			break;
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			is_bgra = false;
+			break;
+		default:
+			throw std::runtime_error("frame readback only supports 8 bit rgba/bgra swap chains");
+		}
+
+		frame_size = static_cast<VkDeviceSize>(swap_chain.width()) * swap_chain.height() * 4;
+
+		slots.resize(swap_chain.image_count());
+		for (auto& target : slots)
+		{
+			create_slot(target);
+		}
+	}
+
+	frame_readback::~frame_readback()
+	{
+		for (auto& target : slots)
+		{
+			// unmapped implicitly by freeing the memory
+			device.get_barriers().forget(target.buffer);
+			vkDestroyBuffer(device.get_device(), target.buffer, nullptr);
+			device.free_memory(target.memory);
+		}
+	}
+
+	void frame_readback::create_slot(slot& target)
+	{
+		auto buffer_info = VkBufferCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.size = frame_size,
+			.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+		};
+
+		if (vkCreateBuffer(device.get_device(), &buffer_info, nullptr, &target.buffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create readback buffer");
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(device.get_device(), target.buffer, &requirements);
+
+		// cached memory makes the cpu side reads a lot faster, coherent is the guaranteed fallback
+		uint32_t memory_type;
+		try
+		{
+			memory_type = device.find_memory_type(
+				requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+		}
+		catch (const std::runtime_error&)
+		{
+			memory_type = device.find_memory_type(
+				requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		}
+
+		target.memory = device.allocate_memory(requirements, memory_type, memory_category::readback);
+		vkBindBufferMemory(device.get_device(), target.buffer, target.memory, 0);
+
+		void* mapped;
+		if (vkMapMemory(device.get_device(), target.memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to map readback buffer memory");
+		}
+		target.mapped = static_cast<const std::byte*>(mapped);
+	}
+
+	void frame_readback::record_copy(VkCommandBuffer command_buffer, uint32_t image_index)
+	{
+		auto image = swap_chain.get_image(static_cast<int>(image_index));
+		auto buffer = slots[image_index].buffer;
+		auto& barriers = device.get_barriers();
+
+		// waits for the frame's color writes, and for the host having read what was copied into the
+		// buffer last time around
+		barriers.use(
+			image,
+			{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
+			{ VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR, VK_ACCESS_2_TRANSFER_READ_BIT_KHR, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL });
+		barriers.use(buffer, { VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR, VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR });
+		barriers.flush(command_buffer);
+
+		auto region = VkBufferImageCopy{
+			.bufferOffset = 0,
+			.bufferRowLength = 0,
+			.bufferImageHeight = 0,
+			.imageSubresource{
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.mipLevel = 0,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			},
+			.imageOffset = {0, 0, 0},
+			.imageExtent = {swap_chain.width(), swap_chain.height(), 1},
+		};
+		vkCmdCopyImageToBuffer(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region);
+
+		// fences don't make device writes visible to the host on their own. this gets recorded
+		// together with the image's way back to present, see swap_chain_wrp::prepare_present
+		barriers.use(buffer, { VK_PIPELINE_STAGE_2_HOST_BIT_KHR, VK_ACCESS_2_HOST_READ_BIT_KHR });
+	}
+
+	void frame_readback::collect(uint32_t image_index, const callback& on_frame)
+	{
+		LVK_TRACE_SCOPE("collect readbacks");
+
+		// this buffer is about to be written again, so whatever is in it has to be read now
+		auto& reused = slots[image_index];
+		if (reused.pending)
+		{
+			vkWaitForFences(device.get_device(), 1, &reused.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+		}
+
+		consume_finished(on_frame, false);
+	}
+
+	void frame_readback::mark_submitted(uint32_t image_index)
+	{
+		auto& target = slots[image_index];
+		target.fence = swap_chain.get_image_fence(static_cast<int>(image_index));
+		target.frame_index = submitted_frames++;
+		target.pending = true;
+	}
+
+	void frame_readback::flush(const callback& on_frame)
+	{
+		consume_finished(on_frame, true);
+	}
+
+	void frame_readback::consume_finished(const callback& on_frame, bool wait)
+	{
+		std::vector<slot*> finished;
+		for (auto& source : slots)
+		{
+			if (!source.pending)
+			{
+				continue;
+			}
+			if (wait)
+			{
+				vkWaitForFences(device.get_device(), 1, &source.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+			}
+			else if (vkGetFenceStatus(device.get_device(), source.fence) != VK_SUCCESS)
+			{
+				continue;
+			}
+			finished.push_back(&source);
+		}
+
+		// slots finish in submission order but sit in the ring in image order
+		std::sort(finished.begin(), finished.end(), [](const slot* a, const slot* b) {
+			return a->frame_index < b->frame_index;
+		});
+		for (auto* source : finished)
+		{
+			consume(*source, on_frame);
+		}
+	}
+
+	void frame_readback::consume(slot& source, const callback& on_frame)
+	{
+		source.pending = false;
+
+		// harmless on coherent memory, required on cached but non coherent memory
+		auto range = VkMappedMemoryRange{
+			.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+			.memory = source.memory,
+			.offset = 0,
+			.size = VK_WHOLE_SIZE,
+		};
+		vkInvalidateMappedMemoryRanges(device.get_device(), 1, &range);
+
+		on_frame(readback_frame{
+			.frame_index = source.frame_index,
+			.width = swap_chain.width(),
+			.height = swap_chain.height(),
+			.format = swap_chain.get_swap_chain_image_format(),
+			.pixels = { source.mapped, static_cast<size_t>(frame_size) },
+			.is_bgra = is_bgra,
+		});
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "device_wrp.hpp"
+#include "swap_chain_wrp.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace lvk
+{
+	// pixels of a finished frame, only valid for the duration of the readback callback
+	struct readback_frame
+	{
+		uint64_t frame_index;
+		uint32_t width, height;
+		VkFormat format;
+		std::span<const std::byte> pixels;
+		// swap chains are usually bgra, image writers want to know
+		bool is_bgra;
+	};
+
+	// writes a frame as png or ppm depending on the extension of path
+	bool write_frame(const std::string& path, const readback_frame& frame);
+
+	// copies swap chain images into a ring of persistently mapped host buffers, one per
+	// swap chain image. a copy is only read once the fence of its submission signals, so
+	// grabbing frames never stalls the frame that produced them.
+	//
+	// per frame usage, all of it between acquiring and submitting:
+	//   collect(image_index, callback) then submit then mark_submitted(image_index)
+	class frame_readback
+	{
+	public:
+		using callback = std::function<void(const readback_frame&)>;
+
+		frame_readback(device_wrp& _device, swap_chain_wrp& _swap_chain);
+		~frame_readback();
+
+		frame_readback(const frame_readback&) = delete;
+		frame_readback& operator=(const frame_readback&) = delete;
+
+		// records the copy of the given swap chain image, goes after the last pass and before
+		// swap_chain_wrp::prepare_present
+		void record_copy(VkCommandBuffer command_buffer, uint32_t image_index);
+
+		// hands every finished readback to on_frame. the slot of image_index is waited for,
+		// which costs nothing extra since the swap chain waits on the same fence before submitting.
+		// has to run every frame after acquiring, before the in flight fences get reset and reused
+		void collect(uint32_t image_index, const callback& on_frame);
+		void mark_submitted(uint32_t image_index);
+
+		// waits for and hands out everything still pending, e.g. on shutdown
+		void flush(const callback& on_frame);
+
+	private:
+		struct slot
+		{
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			const std::byte* mapped = nullptr;
+			VkFence fence = VK_NULL_HANDLE;
+			uint64_t frame_index = 0;
+			bool pending = false;
+		};
+
+		void create_slot(slot& target);
+		// hands out every pending slot whose fence has signaled, oldest frame first
+		void consume_finished(const callback& on_frame, bool wait);
+		void consume(slot& source, const callback& on_frame);
+
+		device_wrp& device;
+		swap_chain_wrp& swap_chain;
+		std::vector<slot> slots;
+		VkDeviceSize frame_size;
+		bool is_bgra;
+		uint64_t submitted_frames = 0;
+	};
+}
@@ -0,0 +1,137 @@
+#include "gpu_resources.hpp"
+#include "device_wrp.hpp"
+#include "pipeline_wrp.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace lvk
+{
+	gpu_resources::gpu_resources(device_wrp& _device) : device{ _device }
+	{
+	}
+
+	gpu_resources::~gpu_resources()
+	{
+		for (const auto& record : buffers.items())
+		{
+			release(record);
+		}
+		for (const auto& record : images.items())
+		{
+			release(record);
+		}
+		// pipeline_wrp defers its own destruction
+	}
+
+	auto gpu_resources::create_buffer(const buffer_desc& desc) -> buffer_handle
+	{
+		buffer_record record{ .size = desc.size, .category = desc.category };
+		device.createBuffer(desc.size, desc.usage, desc.memory_properties, record.buffer, record.memory, desc.category);
+		return buffers.create(record);
+	}
+
+	auto gpu_resources::create_image(const image_desc& desc) -> image_handle
+	{
+		image_record record{ .format = desc.info.format, .extent = desc.info.extent, .category = desc.category };
+		device.createImageWithInfo(desc.info, desc.memory_properties, record.image, record.memory, desc.category);
+
+		if (desc.view_aspect != 0)
+		{
+			auto view_info = VkImageViewCreateInfo{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+				.image = record.image,
+				.viewType = desc.info.arrayLayers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
+				.format = desc.info.format,
+				.subresourceRange = {
+					.aspectMask = desc.view_aspect,
+					.baseMipLevel = 0,
+					.levelCount = desc.info.mipLevels,
+					.baseArrayLayer = 0,
+					.layerCount = desc.info.arrayLayers,
+				},
+			};
+			if (vkCreateImageView(device.get_device(), &view_info, nullptr, &record.view) != VK_SUCCESS)
+			{
+				release(record);
+				throw std::runtime_error("failed to create image view");
+			}
+		}
+		return images.create(record);
+	}
+
+	auto gpu_resources::add_pipeline(std::shared_ptr<pipeline_wrp> pipeline) -> pipeline_handle
+	{
+		auto vk_pipeline = pipeline->get_pipeline();
+		return pipelines.create({ vk_pipeline, std::move(pipeline) });
+	}
+
+	void gpu_resources::replace_pipeline(const std::shared_ptr<pipeline_wrp>& old_pipeline, const std::shared_ptr<pipeline_wrp>& new_pipeline)
+	{
+		for (auto& record : pipelines.items())
+		{
+			if (record.owner == old_pipeline)
+			{
+				record.pipeline = new_pipeline->get_pipeline();
+				record.owner = new_pipeline;
+			}
+		}
+	}
+
+	void gpu_resources::destroy(buffer_handle handle)
+	{
+		if (auto record = buffers.remove(handle))
+		{
+			release(*record);
+		}
+	}
+
+	void gpu_resources::destroy(image_handle handle)
+	{
+		if (auto record = images.remove(handle))
+		{
+			release(*record);
+		}
+	}
+
+	void gpu_resources::destroy(pipeline_handle handle)
+	{
+		pipelines.remove(handle);
+	}
+
+	auto gpu_resources::get_stats() const -> gpu_resource_stats
+	{
+		gpu_resource_stats stats{
+			.buffers = buffers.size(),
+			.images = images.size(),
+			.pipelines = pipelines.size(),
+		};
+		for (const auto& record : buffers.items())
+		{
+			stats.buffer_bytes += record.size;
+		}
+		return stats;
+	}
+
+	void gpu_resources::release(const buffer_record& record)
+	{
+		device.get_barriers().forget(record.buffer);
+		device.get_deletion_queue().defer([&device = device, record] {
+			vkDestroyBuffer(device.get_device(), record.buffer, nullptr);
+			device.free_memory(record.memory);
+		});
+	}
+
+	void gpu_resources::release(const image_record& record)
+	{
+		device.get_barriers().forget(record.image);
+		device.get_deletion_queue().defer([&device = device, record] {
+			if (record.view != VK_NULL_HANDLE)
+			{
+				vkDestroyImageView(device.get_device(), record.view, nullptr);
+			}
+			vkDestroyImage(device.get_device(), record.image, nullptr);
+			device.free_memory(record.memory);
+		});
+	}
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "handle_pool.hpp"
+#include "memory_tracker.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+
+namespace lvk
+{
+	class device_wrp;
+	class pipeline_wrp;
+
+	using buffer_handle = handle<struct buffer_tag>;
+	using image_handle = handle<struct image_tag>;
+	using pipeline_handle = handle<struct pipeline_tag>;
+
+	struct buffer_desc
+	{
+		VkDeviceSize size = 0;
+		VkBufferUsageFlags usage = 0;
+		VkMemoryPropertyFlags memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		memory_category category = memory_category::buffer;
+	};
+
+	struct buffer_record
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize size = 0;
+		memory_category category = memory_category::buffer;
+	};
+
+	struct image_desc
+	{
+		VkImageCreateInfo info{};
+		VkMemoryPropertyFlags memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		memory_category category = memory_category::image;
+		// a view of the whole image gets created for these aspects, none when it's 0
+		VkImageAspectFlags view_aspect = 0;
+	};
+
+	struct image_record
+	{
+		VkImage image = VK_NULL_HANDLE;
+		VkImageView view = VK_NULL_HANDLE;
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		VkExtent3D extent{};
+		memory_category category = memory_category::image;
+	};
+
+	struct pipeline_record
+	{
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		// pipelines are still built and shared by pipeline_registry, this keeps them alive
+		std::shared_ptr<pipeline_wrp> owner;
+	};
+
+	struct gpu_resource_stats
+	{
+		size_t buffers = 0;
+		size_t images = 0;
+		size_t pipelines = 0;
+		VkDeviceSize buffer_bytes = 0;
+	};
+
+	// owns buffers, images and pipelines behind generational handles, see handle_pool. lookups are
+	// an index and a generation check, stale handles get nullptr. destroying only drops the record,
+	// the vulkan objects go through the device's deletion queue so in flight frames can finish.
+	// not thread safe, the app only touches it from one thread at a time
+	class gpu_resources
+	{
+	public:
+		explicit gpu_resources(device_wrp& _device);
+		~gpu_resources();
+
+		gpu_resources(const gpu_resources&) = delete;
+		gpu_resources& operator=(const gpu_resources&) = delete;
+
+		auto create_buffer(const buffer_desc& desc) -> buffer_handle;
+		auto create_image(const image_desc& desc) -> image_handle;
+		auto add_pipeline(std::shared_ptr<pipeline_wrp> pipeline) -> pipeline_handle;
+
+		// every handle to old_pipeline keeps working but binds new_pipeline from now on
+		void replace_pipeline(const std::shared_ptr<pipeline_wrp>& old_pipeline, const std::shared_ptr<pipeline_wrp>& new_pipeline);
+
+		// stale handles are ignored
+		void destroy(buffer_handle handle);
+		void destroy(image_handle handle);
+		void destroy(pipeline_handle handle);
+
+		auto get(buffer_handle handle) const -> const buffer_record*
+		{
+			return buffers.get(handle);
+		}
+		auto get(image_handle handle) const -> const image_record*
+		{
+			return images.get(handle);
+		}
+		auto get(pipeline_handle handle) const -> const pipeline_record*
+		{
+			return pipelines.get(handle);
+		}
+
+		auto get_buffers() const -> std::span<const buffer_record>
+		{
+			return buffers.items();
+		}
+		auto get_images() const -> std::span<const image_record>
+		{
+			return images.items();
+		}
+		auto get_pipelines() const -> std::span<const pipeline_record>
+		{
+			return pipelines.items();
+		}
+
+		auto get_stats() const -> gpu_resource_stats;
+
+	private:
+		void release(const buffer_record& record);
+		void release(const image_record& record);
+
+		device_wrp& device;
+		handle_pool<buffer_record, buffer_tag> buffers;
+		handle_pool<image_record, image_tag> images;
+		handle_pool<pipeline_record, pipeline_tag> pipelines;
+	};
+}
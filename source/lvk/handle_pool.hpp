@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace lvk
+{
+	// index of a slot in a handle_pool plus the generation the slot had when the handle was made,
+	// so a handle to something destroyed never finds whatever reused its slot. the tag only keeps
+	// handles of different pools apart
+	template<typename Tag>
+	struct handle
+	{
+		uint32_t index = 0;
+		// 0 is never handed out, so default constructed handles are always stale
+		uint32_t generation = 0;
+
+		explicit operator bool() const
+		{
+			return generation != 0;
+		}
+		bool operator==(const handle&) const = default;
+	};
+
+	// items live in one dense array, handles go through a slot that knows where in it they are.
+	// removing swaps the last item into the hole, so iterating items never skips dead ones.
+	// same idea as scene's entity -> slot mapping, just with stale handle detection
+	template<typename T, typename Tag>
+	class handle_pool
+	{
+	public:
+		using handle_type = handle<Tag>;
+
+		auto create(T item) -> handle_type
+		{
+			uint32_t index;
+			if (!free_slots.empty())
+			{
+				index = free_slots.back();
+				free_slots.pop_back();
+			}
+			else
+			{
+				index = static_cast<uint32_t>(slots.size());
+				slots.push_back({ NO_POSITION, 0 });
+			}
+
+			auto& s = slots[index];
+			// skips 0 when it wraps around
+			s.generation = s.generation + 1 == 0 ? 1 : s.generation + 1;
+			s.position = static_cast<uint32_t>(dense.size());
+			dense.push_back(std::move(item));
+			dense_slots.push_back(index);
+			return { index, s.generation };
+		}
+
+		// nullptr for stale handles
+		auto get(handle_type h) -> T*
+		{
+			return contains(h) ? &dense[slots[h.index].position] : nullptr;
+		}
+		auto get(handle_type h) const -> const T*
+		{
+			return contains(h) ? &dense[slots[h.index].position] : nullptr;
+		}
+
+		bool contains(handle_type h) const
+		{
+			return h.index < slots.size() && h.generation != 0 && slots[h.index].generation == h.generation
+				&& slots[h.index].position != NO_POSITION;
+		}
+
+		// moves the item out, nothing for stale handles
+		auto remove(handle_type h) -> std::optional<T>
+		{
+			if (!contains(h))
+			{
+				return std::nullopt;
+			}
+
+			auto& s = slots[h.index];
+			auto position = s.position;
+			std::optional<T> removed{ std::move(dense[position]) };
+
+			auto last = static_cast<uint32_t>(dense.size() - 1);
+			if (position != last)
+			{
+				dense[position] = std::move(dense[last]);
+				dense_slots[position] = dense_slots[last];
+				slots[dense_slots[position]].position = position;
+			}
+			dense.pop_back();
+			dense_slots.pop_back();
+
+			s.position = NO_POSITION;
+			free_slots.push_back(h.index);
+			return removed;
+		}
+
+		// every handle goes stale, generations are kept so they stay stale
+		void clear()
+		{
+			for (auto index : dense_slots)
+			{
+				slots[index].position = NO_POSITION;
+				free_slots.push_back(index);
+			}
+			dense.clear();
+			dense_slots.clear();
+		}
+
+		auto size() const -> size_t
+		{
+			return dense.size();
+		}
+		auto empty() const -> bool
+		{
+			return dense.empty();
+		}
+
+		// contiguous, in no particular order once something was removed
+		auto items() -> std::span<T>
+		{
+			return dense;
+		}
+		auto items() const -> std::span<const T>
+		{
+			return dense;
+		}
+		// handle of items()[position]
+		auto handle_at(size_t position) const -> handle_type
+		{
+			auto index = dense_slots[position];
+			return { index, slots[index].generation };
+		}
+
+	private:
+		static constexpr uint32_t NO_POSITION = ~0u;
+
+		struct slot
+		{
+			uint32_t position;
+			uint32_t generation;
+		};
+
+		std::vector<slot> slots;
+		std::vector<uint32_t> free_slots;
+
+		// indexed by position
+		std::vector<T> dense;
+		std::vector<uint32_t> dense_slots;
+	};
+}
@@ -0,0 +1,172 @@
+#include "image_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <vector>
+
+namespace lvk
+{
+	namespace
+	{
+		auto crc32_table() -> const std::array<uint32_t, 256>&
+		{
+			static const auto table = [] {
+				std::array<uint32_t, 256> result{};
+				for (uint32_t n = 0; n < 256; n++)
+				{
+					uint32_t c = n;
+					for (int k = 0; k < 8; k++)
+					{
+						c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+					}
+					result[n] = c;
+				}
+				return result;
+			}();
+			return table;
+		}
+
+		auto crc32(const uint8_t* data, size_t size, uint32_t crc = 0xffffffffu) -> uint32_t
+		{
+			const auto& table = crc32_table();
+			for (size_t i = 0; i < size; i++)
+			{
+				crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+			}
+			return crc;
+		}
+
+		void put_u32_be(std::vector<uint8_t>& out, uint32_t value)
+		{
+			out.push_back(static_cast<uint8_t>(value >> 24));
+			out.push_back(static_cast<uint8_t>(value >> 16));
+			out.push_back(static_cast<uint8_t>(value >> 8));
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		void write_chunk(std::ofstream& file, const char (&type)[5], const std::vector<uint8_t>& data)
+		{
+			std::vector<uint8_t> chunk;
+			chunk.reserve(data.size() + 12);
+			put_u32_be(chunk, static_cast<uint32_t>(data.size()));
+			chunk.insert(chunk.end(), type, type + 4);
+			chunk.insert(chunk.end(), data.begin(), data.end());
+			put_u32_be(chunk, crc32(chunk.data() + 4, data.size() + 4) ^ 0xffffffffu);
+			file.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+		}
+
+		auto pixel_channel(const image_rgba8& image, size_t pixel, int channel) -> uint8_t
+		{
+			if (image.swap_red_blue && channel != 1 && channel != 3)
+			{
+				channel = 2 - channel;
+			}
+			return static_cast<uint8_t>(image.pixels[pixel * 4 + channel]);
+		}
+	}
+
+	bool write_ppm(const std::string& path, const image_rgba8& image)
+	{
+		std::ofstream file{ path, std::ios::binary };
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		file << "P6\n" << image.width << ' ' << image.height << "\n255\n";
+
+		std::vector<uint8_t> row(static_cast<size_t>(image.width) * 3);
+		for (uint32_t y = 0; y < image.height; y++)
+		{
+			for (uint32_t x = 0; x < image.width; x++)
+			{
+				auto pixel = static_cast<size_t>(y) * image.width + x;
+				for (int c = 0; c < 3; c++)
+				{
+					row[x * 3 + c] = pixel_channel(image, pixel, c);
+				}
+			}
+			file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	bool write_png(const std::string& path, const image_rgba8& image)
+	{
+		std::ofstream file{ path, std::ios::binary };
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		constexpr uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+		file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+		std::vector<uint8_t> header;
+		put_u32_be(header, image.width);
+		put_u32_be(header, image.height);
+		header.push_back(8); // bit depth
+		header.push_back(6); // color type: rgba
+		header.push_back(0); // compression
+		header.push_back(0); // filter
+		header.push_back(0); // interlace
+		write_chunk(file, "IHDR", header);
+
+		// raw scanlines, each prefixed with filter type 0
+		auto stride = static_cast<size_t>(image.width) * 4;
+		std::vector<uint8_t> raw;
+		raw.reserve((stride + 1) * image.height);
+		for (uint32_t y = 0; y < image.height; y++)
+		{
+			raw.push_back(0);
+			for (uint32_t x = 0; x < image.width; x++)
+			{
+				auto pixel = static_cast<size_t>(y) * image.width + x;
+				for (int c = 0; c < 4; c++)
+				{
+					raw.push_back(pixel_channel(image, pixel, c));
+				}
+			}
+		}
+
+		// zlib stream made of stored deflate blocks, at most 65535 bytes each
+		std::vector<uint8_t> zlib;
+		zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+		zlib.push_back(0x78);
+		zlib.push_back(0x01);
+
+		uint32_t adler_a = 1, adler_b = 0;
+		for (size_t offset = 0; offset < raw.size() || offset == 0;)
+		{
+			auto block_size = static_cast<uint16_t>(std::min<size_t>(raw.size() - offset, 65535));
+			bool final_block = offset + block_size >= raw.size();
+
+			zlib.push_back(final_block ? 1 : 0);
+			zlib.push_back(static_cast<uint8_t>(block_size));
+			zlib.push_back(static_cast<uint8_t>(block_size >> 8));
+			zlib.push_back(static_cast<uint8_t>(~block_size));
+			zlib.push_back(static_cast<uint8_t>(~block_size >> 8));
+			zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + block_size);
+
+			for (size_t i = offset; i < offset + block_size; i++)
+			{
+				adler_a = (adler_a + raw[i]) % 65521;
+				adler_b = (adler_b + adler_a) % 65521;
+			}
+
+			offset += block_size;
+			if (final_block)
+			{
+				break;
+			}
+		}
+		put_u32_be(zlib, (adler_b << 16) | adler_a);
+
+		write_chunk(file, "IDAT", zlib);
+		write_chunk(file, "IEND", {});
+
+		return static_cast<bool>(file);
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace lvk
+{
+	// tightly packed 8 bit per channel pixels with 4 channels,
+	// swap_red_blue is for the bgra layouts swap chains tend to use
+	struct image_rgba8
+	{
+		uint32_t width, height;
+		std::span<const std::byte> pixels;
+		bool swap_red_blue = false;
+	};
+
+	// binary ppm (P6), alpha is dropped
+	bool write_ppm(const std::string& path, const image_rgba8& image);
+
+	// uncompressed png (stored deflate blocks), so no zlib dependency is needed.
+	// files are big but cheap to produce, which matters when dumping at frame rate
+	bool write_png(const std::string& path, const image_rgba8& image);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "window_wrp.hpp"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace lvk
+{
+	// the vulkan instance and its debug messenger. lives apart from device_wrp so
+	// any number of surfaces (one per window) can be created before picking a device
+	class instance_wrp
+	{
+	public:
+#ifdef NDEBUG
+		const bool enable_validation_layers = false;
+#else
+		const bool enable_validation_layers = true;
+#endif
+
+		instance_wrp();
+		~instance_wrp();
+
+		// Not copyable or movable
+		instance_wrp(const instance_wrp &) = delete;
+		void operator=(const instance_wrp &) = delete;
+		instance_wrp(instance_wrp &&) = delete;
+		instance_wrp &operator=(instance_wrp &&) = delete;
+
+		VkInstance get_instance()
+		{
+			return instance;
+		}
+		const std::vector<const char *> &get_validation_layers()
+		{
+			return validation_layers;
+		}
+		// VK_KHR_get_physical_device_properties2 got enabled
+		bool has_physical_device_properties2()
+		{
+			return physical_device_properties2_enabled;
+		}
+
+	private:
+		void create_instance();
+		void setup_debug_messenger();
+
+		// helper functions
+		std::vector<const char *> get_required_extensions();
+		bool check_validation_layer_support();
+		void populate_debug_messenger_create_info(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
+		std::unordered_set<std::string> get_available_instance_extensions();
+		void has_gflw_required_instance_extensions(
+			const std::unordered_set<std::string> &available, const std::vector<const char *> &requiredExtensions);
+
+		VkInstance instance;
+		VkDebugUtilsMessengerEXT debug_messenger;
+		bool physical_device_properties2_enabled = false;
+
+		const std::vector<const char *> validation_layers = {"VK_LAYER_KHRONOS_validation"};
+	};
+
+} // namespace lvk
@@ -0,0 +1,225 @@
+#include "job_system.hpp"
+
+#include "trace.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace lvk
+{
+	namespace
+	{
+		// how many empty rounds an idle worker spins through before going to sleep
+		constexpr uint32_t SPIN_ROUNDS = 64;
+
+		thread_local const job_system* current_system = nullptr;
+		thread_local uint32_t current_index = job_system::NOT_A_WORKER;
+
+		// xorshift, only used to pick steal victims
+		auto next_random() -> uint32_t
+		{
+			thread_local uint32_t state = 0x9e3779b9u ^ static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+	}
+
+	job_system::job_system(uint32_t worker_count)
+	{
+		if (worker_count == 0)
+		{
+			worker_count = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+
+		workers.reserve(worker_count);
+		for (uint32_t i = 0; i < worker_count; i++)
+		{
+			workers.push_back(std::make_unique<worker>());
+		}
+
+		current_system = this;
+		current_index = 0;
+
+		for (uint32_t i = 1; i < worker_count; i++)
+		{
+			workers[i]->thread = std::thread{ [this, i] { worker_loop(i); } };
+		}
+	}
+
+	job_system::~job_system()
+	{
+		{
+			std::lock_guard lock{ sleep_mutex };
+			stopping = true;
+		}
+		wake.notify_all();
+
+		for (auto& w : workers)
+		{
+			if (w->thread.joinable())
+			{
+				w->thread.join();
+			}
+		}
+
+		if (current_system == this)
+		{
+			current_system = nullptr;
+			current_index = NOT_A_WORKER;
+		}
+	}
+
+	auto job_system::worker_index() const -> uint32_t
+	{
+		return current_system == this ? current_index : NOT_A_WORKER;
+	}
+
+	auto job_system::allocate_job() -> job*
+	{
+		thread_local auto ring = std::make_unique<job[]>(MAX_JOBS_PER_THREAD);
+		thread_local size_t next = 0;
+
+		auto* j = &ring[next++ & (MAX_JOBS_PER_THREAD - 1)];
+		if (j->unfinished.load(std::memory_order_acquire) != 0)
+		{
+			throw std::runtime_error("too many jobs in flight on one thread, the job ring wrapped around");
+		}
+		return j;
+	}
+
+	void job_system::run(job* j)
+	{
+		auto index = worker_index();
+		if (index != NOT_A_WORKER)
+		{
+			// deque is full, so there's plenty to steal already. just do this one now
+			if (!workers[index]->deque.push(j))
+			{
+				execute(j);
+				return;
+			}
+		}
+		else
+		{
+			std::lock_guard lock{ injected_mutex };
+			injected.push_back(j);
+			injected_size.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// pairs with the sleeping/queued check in worker_loop, one of the two always sees the other
+		queued.fetch_add(1);
+		if (sleeping.load() > 0)
+		{
+			std::lock_guard lock{ sleep_mutex };
+			wake.notify_one();
+		}
+	}
+
+	void job_system::wait(const job* j)
+	{
+		auto index = worker_index();
+		while (!is_finished(j))
+		{
+			if (auto* next = find_job(index))
+			{
+				execute(next);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	auto job_system::find_job(uint32_t index) -> job*
+	{
+		job* j = nullptr;
+
+		bool found = index != NOT_A_WORKER && workers[index]->deque.pop(j);
+
+		if (!found && injected_size.load(std::memory_order_relaxed) > 0)
+		{
+			std::lock_guard lock{ injected_mutex };
+			if (!injected.empty())
+			{
+				j = injected.front();
+				injected.pop_front();
+				injected_size.fetch_sub(1, std::memory_order_relaxed);
+				found = true;
+			}
+		}
+
+		if (!found)
+		{
+			auto count = static_cast<uint32_t>(workers.size());
+			auto first = next_random() % count;
+			for (uint32_t i = 0; i < count && !found; i++)
+			{
+				auto victim = (first + i) % count;
+				found = victim != index && workers[victim]->deque.steal(j);
+			}
+		}
+
+		if (!found)
+		{
+			return nullptr;
+		}
+
+		queued.fetch_sub(1, std::memory_order_relaxed);
+		return j;
+	}
+
+	void job_system::execute(job* j)
+	{
+		j->function(*j);
+		finish(j);
+	}
+
+	void job_system::finish(job* j)
+	{
+		while (j != nullptr)
+		{
+			// the slot can be recycled as soon as the count hits zero, so grab the parent first
+			auto* parent = j->parent;
+			if (j->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			{
+				return;
+			}
+			j = parent;
+		}
+	}
+
+	void job_system::worker_loop(uint32_t index)
+	{
+		current_system = this;
+		current_index = index;
+
+		auto name = "job worker " + std::to_string(index);
+		trace::set_thread_name(name.c_str());
+
+		uint32_t idle_rounds = 0;
+		while (!stopping.load(std::memory_order_relaxed))
+		{
+			if (auto* j = find_job(index))
+			{
+				execute(j);
+				idle_rounds = 0;
+				continue;
+			}
+
+			if (++idle_rounds < SPIN_ROUNDS)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock lock{ sleep_mutex };
+			sleeping.fetch_add(1);
+			wake.wait(lock, [this] { return queued.load() > 0 || stopping.load(); });
+			sleeping.fetch_sub(1);
+			idle_rounds = 0;
+		}
+	}
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "work_stealing_deque.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lvk
+{
+	// a single unit of work plus the number of unfinished jobs hanging off it (itself included).
+	// the callable lives inline in data, so creating a job never allocates.
+	// a job counts as finished once it ran and all of its children finished
+	struct alignas(64) job
+	{
+		static constexpr size_t DATA_SIZE = 96;
+
+		void (*function)(job&) = nullptr;
+		job* parent = nullptr;
+		std::atomic<int32_t> unfinished{ 0 };
+		alignas(std::max_align_t) std::byte data[DATA_SIZE];
+	};
+
+	// work stealing scheduler. every worker owns a chase-lev deque it pushes its own jobs onto
+	// and pops from lifo, idle workers steal the oldest jobs from a random other worker.
+	// threads that aren't workers (e.g. the render thread) submit through a shared queue instead.
+	// jobs must not throw, catch inside the job and hand the error back some other way
+	class job_system
+	{
+	public:
+		// jobs are recycled from a per thread ring, so a thread can have at most this many
+		// jobs in flight before it starts handing out slots of unfinished ones (which throws)
+		static constexpr size_t MAX_JOBS_PER_THREAD = 4096;
+		static constexpr size_t DEQUE_CAPACITY = 4096;
+		static constexpr uint32_t NOT_A_WORKER = ~0u;
+
+		// the thread that creates the system is worker 0 and only runs jobs while it waits.
+		// 0 workers means one per hardware thread
+		explicit job_system(uint32_t worker_count = 0);
+		~job_system();
+
+		job_system(const job_system&) = delete;
+		job_system& operator=(const job_system&) = delete;
+
+		// the job doesn't run until it's passed to run(). with a parent, the parent won't
+		// finish before this job did, so children have to be created before the parent runs
+		template<typename F>
+		auto create(F&& function, job* parent = nullptr) -> job*;
+
+		void run(job* j);
+
+		// runs other jobs until j finished
+		void wait(const job* j);
+
+		bool is_finished(const job* j) const
+		{
+			return j->unfinished.load(std::memory_order_acquire) == 0;
+		}
+
+		// calls function(begin, end) over [0, count) in batches of at least batch_size
+		// and returns once every batch is done
+		template<typename F>
+		void parallel_for(size_t count, size_t batch_size, F&& function);
+
+		auto get_worker_count() const -> uint32_t
+		{
+			return static_cast<uint32_t>(workers.size());
+		}
+
+		// index of the calling thread in [0, worker count), or NOT_A_WORKER. handy for
+		// per worker scratch like command pools
+		auto worker_index() const -> uint32_t;
+
+	private:
+		// batches per parallel_for are capped so one call can't eat the whole job ring
+		static constexpr size_t MAX_BATCHES = MAX_JOBS_PER_THREAD / 4;
+
+		struct worker
+		{
+			work_stealing_deque<job*, DEQUE_CAPACITY> deque;
+			std::thread thread;
+		};
+
+		static auto allocate_job() -> job*;
+
+		void worker_loop(uint32_t index);
+		auto find_job(uint32_t index) -> job*;
+		void execute(job* j);
+		void finish(job* j);
+
+		// worker 0 is the creating thread and has no std::thread of its own
+		std::vector<std::unique_ptr<worker>> workers;
+
+		// jobs from threads that aren't workers
+		std::mutex injected_mutex;
+		std::deque<job*> injected;
+		std::atomic<size_t> injected_size{ 0 };
+
+		// jobs sitting in any queue, idle workers sleep while this is zero
+		std::atomic<int64_t> queued{ 0 };
+		std::atomic<uint32_t> sleeping{ 0 };
+		std::mutex sleep_mutex;
+		std::condition_variable wake;
+		std::atomic<bool> stopping{ false };
+	};
+
+	template<typename F>
+	auto job_system::create(F&& function, job* parent) -> job*
+	{
+		using callable = std::decay_t<F>;
+		static_assert(sizeof(callable) <= job::DATA_SIZE, "job captures too much, capture by reference instead");
+		static_assert(alignof(callable) <= alignof(std::max_align_t));
+
+		auto* j = allocate_job();
+		j->parent = parent;
+		j->unfinished.store(1, std::memory_order_relaxed);
+		if (parent != nullptr)
+		{
+			parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		new (j->data) callable{ std::forward<F>(function) };
+		j->function = [](job& self) {
+			auto& call = *std::launder(reinterpret_cast<callable*>(self.data));
+			call();
+			call.~callable();
+		};
+		return j;
+	}
+
+	template<typename F>
+	void job_system::parallel_for(size_t count, size_t batch_size, F&& function)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		batch_size = std::max({ batch_size, size_t{ 1 }, (count + MAX_BATCHES - 1) / MAX_BATCHES });
+
+		auto* root = create([] {});
+		for (size_t begin = 0; begin < count; begin += batch_size)
+		{
+			auto end = std::min(begin + batch_size, count);
+			run(create([&function, begin, end] { function(begin, end); }, root));
+		}
+		run(root);
+		wait(root);
+	}
+}
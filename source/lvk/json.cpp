@@ -0,0 +1,396 @@
+#include "json.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace lvk
+{
+	namespace
+	{
+		const json NULL_VALUE{};
+		const std::string EMPTY_STRING{};
+		const std::vector<json> EMPTY_ITEMS{};
+		const std::vector<std::pair<std::string, json>> EMPTY_MEMBERS{};
+
+		// deep enough for any sane document, shallow enough to never blow the stack
+		constexpr uint32_t MAX_DEPTH = 256;
+
+		void append_utf8(std::string& out, uint32_t code_point)
+		{
+			if (code_point < 0x80)
+			{
+				out += static_cast<char>(code_point);
+			}
+			else if (code_point < 0x800)
+			{
+				out += static_cast<char>(0xc0 | (code_point >> 6));
+				out += static_cast<char>(0x80 | (code_point & 0x3f));
+			}
+			else if (code_point < 0x10000)
+			{
+				out += static_cast<char>(0xe0 | (code_point >> 12));
+				out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+				out += static_cast<char>(0x80 | (code_point & 0x3f));
+			}
+			else
+			{
+				out += static_cast<char>(0xf0 | (code_point >> 18));
+				out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+				out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+				out += static_cast<char>(0x80 | (code_point & 0x3f));
+			}
+		}
+	}
+
+	class json_parser
+	{
+		std::string_view text;
+		size_t position = 0;
+
+	public:
+		explicit json_parser(std::string_view _text) : text{ _text }
+		{
+		}
+
+		auto parse_document() -> json
+		{
+			auto value = parse_value(0);
+			skip_whitespace();
+			if (position != text.size())
+			{
+				fail("trailing characters");
+			}
+			return value;
+		}
+
+	private:
+		[[noreturn]] void fail(const char* what) const
+		{
+			throw std::runtime_error("json: " + std::string{ what } + " at offset " + std::to_string(position));
+		}
+
+		void skip_whitespace()
+		{
+			while (position < text.size())
+			{
+				char c = text[position];
+				if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+				{
+					break;
+				}
+				position++;
+			}
+		}
+
+		auto peek() -> char
+		{
+			skip_whitespace();
+			if (position >= text.size())
+			{
+				fail("unexpected end of input");
+			}
+			return text[position];
+		}
+
+		void expect(char c)
+		{
+			if (peek() != c)
+			{
+				fail("unexpected character");
+			}
+			position++;
+		}
+
+		bool consume_literal(std::string_view literal)
+		{
+			if (text.substr(position, literal.size()) != literal)
+			{
+				return false;
+			}
+			position += literal.size();
+			return true;
+		}
+
+		auto parse_value(uint32_t depth) -> json
+		{
+			if (depth > MAX_DEPTH)
+			{
+				fail("nesting too deep");
+			}
+
+			json value;
+			switch (peek())
+			{
+			case '{':
+				value.type = json::kind::object;
+				parse_object(value, depth);
+				break;
+			case '[':
+				value.type = json::kind::array;
+				parse_array(value, depth);
+				break;
+			case '"':
+				value.type = json::kind::string;
+				value.text = parse_string();
+				break;
+			case 't':
+			case 'f':
+				value.type = json::kind::boolean;
+				value.boolean = consume_literal("true");
+				if (!value.boolean && !consume_literal("false"))
+				{
+					fail("invalid literal");
+				}
+				break;
+			case 'n':
+				if (!consume_literal("null"))
+				{
+					fail("invalid literal");
+				}
+				break;
+			default:
+				value.type = json::kind::number;
+				value.number = parse_number();
+				break;
+			}
+			return value;
+		}
+
+		void parse_object(json& value, uint32_t depth)
+		{
+			expect('{');
+			if (peek() == '}')
+			{
+				position++;
+				return;
+			}
+			while (true)
+			{
+				if (peek() != '"')
+				{
+					fail("expected a key");
+				}
+				auto key = parse_string();
+				expect(':');
+				value.fields.emplace_back(std::move(key), parse_value(depth + 1));
+
+				if (peek() == ',')
+				{
+					position++;
+					continue;
+				}
+				expect('}');
+				return;
+			}
+		}
+
+		void parse_array(json& value, uint32_t depth)
+		{
+			expect('[');
+			if (peek() == ']')
+			{
+				position++;
+				return;
+			}
+			while (true)
+			{
+				value.elements.push_back(parse_value(depth + 1));
+
+				if (peek() == ',')
+				{
+					position++;
+					continue;
+				}
+				expect(']');
+				return;
+			}
+		}
+
+		auto parse_hex4() -> uint32_t
+		{
+			if (position + 4 > text.size())
+			{
+				fail("truncated unicode escape");
+			}
+			uint32_t code = 0;
+			auto result = std::from_chars(text.data() + position, text.data() + position + 4, code, 16);
+			if (result.ptr != text.data() + position + 4)
+			{
+				fail("invalid unicode escape");
+			}
+			position += 4;
+			return code;
+		}
+
+		auto parse_string() -> std::string
+		{
+			expect('"');
+			std::string out;
+			while (true)
+			{
+				if (position >= text.size())
+				{
+					fail("unterminated string");
+				}
+
+				char c = text[position++];
+				if (c == '"')
+				{
+					return out;
+				}
+				if (c != '\\')
+				{
+					out += c;
+					continue;
+				}
+
+				if (position >= text.size())
+				{
+					fail("unterminated string");
+				}
+				switch (text[position++])
+				{
+				case '"': out += '"'; break;
+				case '\\': out += '\\'; break;
+				case '/': out += '/'; break;
+				case 'b': out += '\b'; break;
+				case 'f': out += '\f'; break;
+				case 'n': out += '\n'; break;
+				case 'r': out += '\r'; break;
+				case 't': out += '\t'; break;
+				case 'u':
+				{
+					auto code = parse_hex4();
+					// surrogate pairs spell out everything past the basic multilingual plane, halves
+					// of one on their own aren't characters at all
+					if (code >= 0xdc00 && code < 0xe000)
+					{
+						fail("unpaired low surrogate");
+					}
+					if (code >= 0xd800 && code < 0xdc00)
+					{
+						if (!consume_literal("\\u"))
+						{
+							fail("unpaired high surrogate");
+						}
+						auto low = parse_hex4();
+						if (low < 0xdc00 || low >= 0xe000)
+						{
+							fail("high surrogate not followed by a low one");
+						}
+						code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+					}
+					append_utf8(out, code);
+					break;
+				}
+				default:
+					fail("invalid escape");
+				}
+			}
+		}
+
+		auto parse_number() -> double
+		{
+			double number = 0.0;
+			// from_chars doesn't take a leading plus, which json doesn't allow anyway
+			auto result = std::from_chars(text.data() + position, text.data() + text.size(), number);
+			if (result.ec != std::errc{})
+			{
+				fail("invalid number");
+			}
+			position = static_cast<size_t>(result.ptr - text.data());
+			return number;
+		}
+	};
+
+	auto json::parse(std::string_view text) -> json
+	{
+		return json_parser{ text }.parse_document();
+	}
+
+	auto json::as_bool() const -> bool
+	{
+		return type == kind::boolean && boolean;
+	}
+
+	auto json::as_number() const -> double
+	{
+		if (type != kind::number)
+		{
+			throw std::runtime_error("json: expected a number");
+		}
+		return number;
+	}
+
+	auto json::as_string() const -> const std::string&
+	{
+		return type == kind::string ? text : EMPTY_STRING;
+	}
+
+	auto json::items() const -> const std::vector<json>&
+	{
+		return type == kind::array ? elements : EMPTY_ITEMS;
+	}
+
+	auto json::members() const -> const std::vector<std::pair<std::string, json>>&
+	{
+		return type == kind::object ? fields : EMPTY_MEMBERS;
+	}
+
+	auto json::size() const -> size_t
+	{
+		switch (type)
+		{
+		case kind::array: return elements.size();
+		case kind::object: return fields.size();
+		default: return 0;
+		}
+	}
+
+	auto json::operator[](std::string_view key) const -> const json&
+	{
+		for (const auto& [name, value] : members())
+		{
+			if (name == key)
+			{
+				return value;
+			}
+		}
+		return NULL_VALUE;
+	}
+
+	auto json::operator[](size_t index) const -> const json&
+	{
+		const auto& list = items();
+		return index < list.size() ? list[index] : NULL_VALUE;
+	}
+
+	bool json::contains(std::string_view key) const
+	{
+		return &(*this)[key] != &NULL_VALUE;
+	}
+
+	auto json::number_or(double fallback) const -> double
+	{
+		return type == kind::number ? number : fallback;
+	}
+
+	auto json::uint_or(uint32_t fallback) const -> uint32_t
+	{
+		// counts and offsets come straight from files, anything that isn't exactly a uint32_t would
+		// be undefined behaviour to convert. the comparisons are false for nan too
+		auto representable = type == kind::number && number >= 0.0 && number <= static_cast<double>(UINT32_MAX)
+			&& std::trunc(number) == number;
+		return representable ? static_cast<uint32_t>(number) : fallback;
+	}
+
+	auto json::size_or(size_t fallback) const -> size_t
+	{
+		// SIZE_MAX rounds up to a power of two as a double, so < keeps the conversion in range
+		auto representable = type == kind::number && number >= 0.0 && number < static_cast<double>(SIZE_MAX)
+			&& std::trunc(number) == number;
+		return representable ? static_cast<size_t>(number) : fallback;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace lvk
+{
+	// just enough json to read gltf. no streaming, the whole document becomes a tree
+	class json
+	{
+	public:
+		enum class kind
+		{
+			null,
+			boolean,
+			number,
+			string,
+			array,
+			object,
+		};
+
+		// throws std::runtime_error with the offending offset if text isn't valid json
+		static auto parse(std::string_view text) -> json;
+
+		auto get_kind() const -> kind
+		{
+			return type;
+		}
+		bool is_null() const
+		{
+			return type == kind::null;
+		}
+
+		auto as_bool() const -> bool;
+		auto as_number() const -> double;
+		auto as_string() const -> const std::string&;
+		// array elements, empty for anything that isn't an array
+		auto items() const -> const std::vector<json>&;
+		// object members in document order, empty for anything that isn't an object
+		auto members() const -> const std::vector<std::pair<std::string, json>>&;
+
+		auto size() const -> size_t;
+
+		// missing keys, out of range indices and lookups on the wrong kind all land on a shared null,
+		// so optional fields can be chained without checking every step
+		auto operator[](std::string_view key) const -> const json&;
+		auto operator[](size_t index) const -> const json&;
+		bool contains(std::string_view key) const;
+
+		// the value as a number if there is one, fallback otherwise
+		auto number_or(double fallback) const -> double;
+		// whole numbers that fit only, anything else (negative, fractional, too big, nan) is fallback
+		auto uint_or(uint32_t fallback) const -> uint32_t;
+		auto size_or(size_t fallback) const -> size_t;
+
+	private:
+		friend class json_parser;
+
+		kind type = kind::null;
+		bool boolean = false;
+		double number = 0.0;
+		std::string text;
+		std::vector<json> elements;
+		std::vector<std::pair<std::string, json>> fields;
+	};
+}
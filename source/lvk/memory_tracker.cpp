@@ -0,0 +1,190 @@
+#include "memory_tracker.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace lvk
+{
+	namespace
+	{
+		auto to_mb(VkDeviceSize bytes) -> double
+		{
+			return static_cast<double>(bytes) / (1024.0 * 1024.0);
+		}
+	}
+
+	auto memory_category_name(memory_category category) -> const char*
+	{
+		switch (category)
+		{
+		case memory_category::buffer: return "buffers";
+		case memory_category::image: return "images";
+		case memory_category::depth: return "depth";
+		case memory_category::staging: return "staging";
+		case memory_category::readback: return "readback";
+		}
+		return "unknown";
+	}
+
+	auto memory_snapshot::fullest_heap() const -> const memory_heap_snapshot*
+	{
+		const memory_heap_snapshot* fullest = nullptr;
+		for (const auto& heap : heaps)
+		{
+			if (!fullest || heap.used_fraction() > fullest->used_fraction())
+			{
+				fullest = &heap;
+			}
+		}
+		return fullest;
+	}
+
+	auto memory_snapshot::summary() const -> std::string
+	{
+		std::string line = "gpu memory:";
+		char buffer[128];
+		for (size_t i = 0; i < heaps.size(); i++)
+		{
+			const auto& heap = heaps[i];
+			std::snprintf(buffer, sizeof(buffer), " heap %zu%s %.1f/%.1f mb (%.0f%%, %.1f mb ours),",
+				i, heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT ? " (vram)" : "",
+				to_mb(heap.usage), to_mb(heap.budget), heap.used_fraction() * 100.0, to_mb(heap.tracked.bytes));
+			line += buffer;
+		}
+		for (size_t i = 0; i < categories.size(); i++)
+		{
+			std::snprintf(buffer, sizeof(buffer), " %s %.1f mb,",
+				memory_category_name(static_cast<memory_category>(i)), to_mb(categories[i].bytes));
+			line += buffer;
+		}
+		std::snprintf(buffer, sizeof(buffer), " %u/%u allocations%s",
+			allocations, max_allocations, has_budget ? "" : " (no budget extension, usage is ours only)");
+		line += buffer;
+		return line;
+	}
+
+	memory_tracker::memory_tracker(
+		VkPhysicalDevice physical_device,
+		uint32_t max_allocations,
+		PFN_vkGetPhysicalDeviceMemoryProperties2KHR get_properties2
+	)
+		: physical_device{ physical_device }, get_properties2{ get_properties2 }, max_allocations{ max_allocations }
+	{
+		vkGetPhysicalDeviceMemoryProperties(physical_device, &properties);
+		heaps.resize(properties.memoryHeapCount);
+		types.resize(properties.memoryTypeCount);
+	}
+
+	auto memory_tracker::find_type(uint32_t type_filter, VkMemoryPropertyFlags flags) const -> std::optional<uint32_t>
+	{
+		for (uint32_t i = 0; i < properties.memoryTypeCount; i++)
+		{
+			if ((type_filter & (1u << i)) && (properties.memoryTypes[i].propertyFlags & flags) == flags)
+			{
+				return i;
+			}
+		}
+		return std::nullopt;
+	}
+
+	auto memory_tracker::allocate(VkDevice device, const VkMemoryRequirements& requirements, uint32_t type, memory_category category) -> VkDeviceMemory
+	{
+		auto alloc_info = VkMemoryAllocateInfo{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+			.allocationSize = requirements.size,
+			.memoryTypeIndex = type,
+		};
+
+		VkDeviceMemory memory;
+		if (auto result = vkAllocateMemory(device, &alloc_info, nullptr, &memory); result != VK_SUCCESS)
+		{
+			// the whole point of tracking is knowing why this happened
+			auto heap = properties.memoryTypes[type].heapIndex;
+			auto state = snapshot();
+			char message[256];
+			std::snprintf(message, sizeof(message), "failed to allocate %.1f mb of %s memory (error %d, heap %u has %.1f mb of ours in %u allocations)",
+				to_mb(requirements.size), memory_category_name(category), static_cast<int>(result), heap,
+				to_mb(state.heaps[heap].tracked.bytes), state.allocations);
+			throw std::runtime_error(message);
+		}
+
+		std::lock_guard lock{ mutex };
+		allocations.emplace(memory, allocation{ requirements.size, type, category });
+		add(heaps[properties.memoryTypes[type].heapIndex], requirements.size);
+		add(types[type], requirements.size);
+		add(categories[static_cast<size_t>(category)], requirements.size);
+		return memory;
+	}
+
+	void memory_tracker::free(VkDevice device, VkDeviceMemory memory)
+	{
+		if (memory == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		// the record goes before the memory does. once it's freed the driver can hand the same
+		// handle to another thread's allocate, which would then find this one still there
+		{
+			std::lock_guard lock{ mutex };
+			if (auto it = allocations.find(memory); it != allocations.end())
+			{
+				const auto& freed = it->second;
+				remove(heaps[properties.memoryTypes[freed.type].heapIndex], freed.size);
+				remove(types[freed.type], freed.size);
+				remove(categories[static_cast<size_t>(freed.category)], freed.size);
+				allocations.erase(it);
+			}
+		}
+
+		vkFreeMemory(device, memory, nullptr);
+	}
+
+	auto memory_tracker::snapshot() const -> memory_snapshot
+	{
+		memory_snapshot result;
+		result.has_budget = has_budget();
+		result.max_allocations = max_allocations;
+
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = {};
+		budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+		if (has_budget())
+		{
+			VkPhysicalDeviceMemoryProperties2 properties2 = {};
+			properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+			properties2.pNext = &budget;
+			get_properties2(physical_device, &properties2);
+		}
+
+		std::lock_guard lock{ mutex };
+		result.heaps.resize(properties.memoryHeapCount);
+		for (uint32_t i = 0; i < properties.memoryHeapCount; i++)
+		{
+			auto& heap = result.heaps[i];
+			heap.size = properties.memoryHeaps[i].size;
+			heap.flags = properties.memoryHeaps[i].flags;
+			heap.tracked = heaps[i];
+			heap.usage = has_budget() ? budget.heapUsage[i] : heaps[i].bytes;
+			// some drivers report 0 for heaps they don't track
+			heap.budget = has_budget() && budget.heapBudget[i] > 0 ? budget.heapBudget[i] : heap.size;
+		}
+		result.types = types;
+		result.categories = categories;
+		result.allocations = static_cast<uint32_t>(allocations.size());
+		return result;
+	}
+
+	void memory_tracker::add(memory_usage& usage, VkDeviceSize size)
+	{
+		usage.bytes += size;
+		usage.allocations++;
+		usage.peak_bytes = std::max(usage.peak_bytes, usage.bytes);
+	}
+
+	void memory_tracker::remove(memory_usage& usage, VkDeviceSize size)
+	{
+		usage.bytes -= size;
+		usage.allocations--;
+	}
+}
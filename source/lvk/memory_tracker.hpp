@@ -0,0 +1,130 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lvk
+{
+	// what an allocation is for, only used for the statistics
+	enum class memory_category : uint8_t
+	{
+		buffer,
+		image,
+		depth,
+		staging,
+		readback,
+	};
+
+	constexpr size_t MEMORY_CATEGORY_COUNT = 5;
+
+	auto memory_category_name(memory_category category) -> const char*;
+
+	struct memory_usage
+	{
+		VkDeviceSize bytes = 0;
+		uint32_t allocations = 0;
+		// most bytes there ever were at once
+		VkDeviceSize peak_bytes = 0;
+	};
+
+	struct memory_heap_snapshot
+	{
+		VkDeviceSize size = 0;
+		VkMemoryHeapFlags flags = 0;
+		// what went through memory_tracker
+		memory_usage tracked;
+		// with VK_EXT_memory_budget this is what the driver reports for the whole process, other apis and
+		// implicit allocations included, and how much it thinks the process can use before things go bad.
+		// without it the tracked bytes and the heap size are all there is
+		VkDeviceSize usage = 0;
+		VkDeviceSize budget = 0;
+
+		auto used_fraction() const -> double
+		{
+			return budget > 0 ? static_cast<double>(usage) / static_cast<double>(budget) : 0.0;
+		}
+	};
+
+	struct memory_snapshot
+	{
+		bool has_budget = false;
+		std::vector<memory_heap_snapshot> heaps;
+		// indexed by memory type
+		std::vector<memory_usage> types;
+		std::array<memory_usage, MEMORY_CATEGORY_COUNT> categories{};
+		uint32_t allocations = 0;
+		// vkAllocateMemory fails past this no matter how much memory is left
+		uint32_t max_allocations = 0;
+
+		// heap with the highest usage relative to its budget
+		auto fullest_heap() const -> const memory_heap_snapshot*;
+		// one line, e.g. for logging every few seconds
+		auto summary() const -> std::string;
+	};
+
+	// every device memory allocation goes through here, so there's always an up to date picture of
+	// what's allocated where. also caches the memory properties, which find_memory_type used to
+	// query on every call. thread safe
+	class memory_tracker
+	{
+	public:
+		// get_properties2 is only used for the budget and can be null
+		memory_tracker(
+			VkPhysicalDevice physical_device,
+			uint32_t max_allocations,
+			PFN_vkGetPhysicalDeviceMemoryProperties2KHR get_properties2 = nullptr
+		);
+
+		memory_tracker(const memory_tracker&) = delete;
+		memory_tracker& operator=(const memory_tracker&) = delete;
+
+		auto get_properties() const -> const VkPhysicalDeviceMemoryProperties&
+		{
+			return properties;
+		}
+		auto has_budget() const -> bool
+		{
+			return get_properties2 != nullptr;
+		}
+
+		// first type in filter that has all the flags
+		auto find_type(uint32_t type_filter, VkMemoryPropertyFlags flags) const -> std::optional<uint32_t>;
+
+		// throws when vkAllocateMemory fails, with the heap's state in the message
+		auto allocate(VkDevice device, const VkMemoryRequirements& requirements, uint32_t type, memory_category category) -> VkDeviceMemory;
+		void free(VkDevice device, VkDeviceMemory memory);
+
+		// queries the budget again when it's available, so it's not free but fine a few times a second
+		auto snapshot() const -> memory_snapshot;
+
+	private:
+		struct allocation
+		{
+			VkDeviceSize size;
+			uint32_t type;
+			memory_category category;
+		};
+
+		static void add(memory_usage& usage, VkDeviceSize size);
+		static void remove(memory_usage& usage, VkDeviceSize size);
+
+		VkPhysicalDevice physical_device;
+		PFN_vkGetPhysicalDeviceMemoryProperties2KHR get_properties2;
+		VkPhysicalDeviceMemoryProperties properties;
+		uint32_t max_allocations;
+
+		mutable std::mutex mutex;
+		std::unordered_map<VkDeviceMemory, allocation> allocations;
+		std::vector<memory_usage> heaps;
+		std::vector<memory_usage> types;
+		std::array<memory_usage, MEMORY_CATEGORY_COUNT> categories{};
+	};
+}
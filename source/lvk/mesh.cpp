@@ -0,0 +1,109 @@
+#include "mesh.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace lvk
+{
+	void compute_bounds(mesh_data& mesh)
+	{
+		if (mesh.vertices.empty())
+		{
+			mesh.center = glm::vec3{ 0.0f };
+			mesh.radius = 0.0f;
+			return;
+		}
+
+		auto min = mesh.vertices.front().position;
+		auto max = min;
+		for (const auto& v : mesh.vertices)
+		{
+			min = glm::min(min, v.position);
+			max = glm::max(max, v.position);
+		}
+
+		mesh.center = (min + max) * 0.5f;
+		mesh.radius = 0.0f;
+		for (const auto& v : mesh.vertices)
+		{
+			mesh.radius = std::max(mesh.radius, glm::length(v.position - mesh.center));
+		}
+	}
+
+	void compute_normals(mesh_data& mesh)
+	{
+		auto index_count = mesh.lods.empty() ? mesh.indices.size() : mesh.lods.front().index_count;
+		auto first = mesh.lods.empty() ? 0u : mesh.lods.front().first_index;
+
+		std::vector<glm::vec3> normals(mesh.vertices.size(), glm::vec3{ 0.0f });
+		for (size_t i = first; i + 2 < first + index_count; i += 3)
+		{
+			auto a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+			// the cross product's length is twice the triangle's area, which does the weighting
+			auto normal = glm::cross(
+				mesh.vertices[b].position - mesh.vertices[a].position,
+				mesh.vertices[c].position - mesh.vertices[a].position
+			);
+			normals[a] += normal;
+			normals[b] += normal;
+			normals[c] += normal;
+		}
+
+		for (size_t i = 0; i < normals.size(); i++)
+		{
+			auto length = glm::length(normals[i]);
+			mesh.vertices[i].normal = length > 0.0f ? normals[i] / length : glm::vec3{ 0.0f, 1.0f, 0.0f };
+		}
+	}
+
+	auto make_uv_sphere(uint32_t rings, uint32_t segments) -> mesh_data
+	{
+		rings = std::max(rings, 2u);
+		segments = std::max(segments, 3u);
+
+		mesh_data mesh;
+
+		// the seam column is duplicated so the uvs can wrap around
+		for (uint32_t ring = 0; ring <= rings; ring++)
+		{
+			float v = static_cast<float>(ring) / static_cast<float>(rings);
+			float theta = v * std::numbers::pi_v<float>;
+			for (uint32_t segment = 0; segment <= segments; segment++)
+			{
+				float u = static_cast<float>(segment) / static_cast<float>(segments);
+				float phi = u * 2.0f * std::numbers::pi_v<float>;
+
+				glm::vec3 normal{ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) };
+				mesh.vertices.push_back({ normal, normal, { u, v } });
+			}
+		}
+
+		auto stride = segments + 1;
+		for (uint32_t ring = 0; ring < rings; ring++)
+		{
+			for (uint32_t segment = 0; segment < segments; segment++)
+			{
+				auto a = ring * stride + segment;
+				auto b = a + stride;
+
+				// the rows at the poles collapse into a point, skip their degenerate halves
+				if (ring != 0)
+				{
+					mesh.indices.insert(mesh.indices.end(), { a, a + 1, b });
+				}
+				if (ring != rings - 1)
+				{
+					mesh.indices.insert(mesh.indices.end(), { a + 1, b + 1, b });
+				}
+			}
+		}
+
+		mesh.lods.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()), 0.0f });
+		compute_bounds(mesh);
+		return mesh;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace lvk
+{
+	// interleaved vertex as it sits in the vertex buffer
+	struct vertex
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 uv;
+	};
+
+	// one level of detail, a slice of the mesh's index buffer. every level indexes the same
+	// vertices, so they all share one vertex buffer
+	struct lod_range
+	{
+		uint32_t first_index = 0;
+		uint32_t index_count = 0;
+		// how far the simplified surface strays from the original, relative to the bounding radius
+		float error = 0.0f;
+	};
+
+	// non owning mesh, e.g. pointing straight into a mapped cache file, see mesh_cache.hpp
+	struct mesh_view
+	{
+		std::span<const vertex> vertices;
+		std::span<const uint32_t> indices;
+		std::span<const lod_range> lods;
+
+		glm::vec3 center{ 0.0f };
+		float radius = 0.0f;
+	};
+
+	struct mesh_data
+	{
+		std::vector<vertex> vertices;
+		// every lod's indices back to back, lod 0 is the full mesh
+		std::vector<uint32_t> indices;
+		std::vector<lod_range> lods;
+
+		// bounding sphere in model space
+		glm::vec3 center{ 0.0f };
+		float radius = 0.0f;
+
+		auto view() const -> mesh_view
+		{
+			return { vertices, indices, lods, center, radius };
+		}
+	};
+
+	// fills in the bounding sphere, centered on the bounding box
+	void compute_bounds(mesh_data& mesh);
+
+	// smooth area weighted normals from lod 0, for meshes that come without any
+	void compute_normals(mesh_data& mesh);
+
+	// uv sphere of radius 1 with a single lod, handy as test geometry
+	auto make_uv_sphere(uint32_t rings, uint32_t segments) -> mesh_data;
+}
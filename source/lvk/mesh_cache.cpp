@@ -0,0 +1,212 @@
+#include "mesh_cache.hpp"
+
+#include "mesh_import.hpp"
+#include "mesh_lod.hpp"
+#include "mesh_optimize.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace lvk
+{
+	namespace
+	{
+		// vertices start on a 16 byte boundary, which is plenty for anything in them
+		constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+		auto align_up(uint64_t value) -> uint64_t
+		{
+			return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+		}
+
+		auto fits(uint64_t offset, uint64_t size, uint64_t file_size) -> bool
+		{
+			return offset <= file_size && size <= file_size - offset;
+		}
+	}
+
+	auto mesh_cache_path(const std::string& source, const std::string& cache_dir) -> std::string
+	{
+		// files with the same name in different directories mustn't share a cache
+		auto absolute = std::filesystem::absolute(source).lexically_normal().string();
+		uint64_t hash = 14695981039346656037ull;
+		for (char c : absolute)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 1099511628211ull;
+		}
+
+		char suffix[17];
+		std::snprintf(suffix, sizeof(suffix), "%016llx", static_cast<unsigned long long>(hash));
+		auto name = std::filesystem::path{ source }.filename().string() + "." + suffix + ".lvkmesh";
+		return (std::filesystem::path{ cache_dir } / name).string();
+	}
+
+	auto mesh_cache_options_of(const mesh_load_options& options) -> uint32_t
+	{
+		return (options.generate_lods ? MESH_CACHE_LODS : 0u) | (options.optimize ? MESH_CACHE_OPTIMIZED : 0u);
+	}
+
+	auto mesh_source_stamp::of(const std::string& path) -> mesh_source_stamp
+	{
+		return {
+			.size = std::filesystem::file_size(path),
+			.time = static_cast<int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count()),
+		};
+	}
+
+	void write_mesh_cache(const std::string& path, const mesh_view& mesh, const mesh_source_stamp& source, const mesh_load_options& options)
+	{
+		LVK_TRACE_SCOPE("write mesh cache");
+
+		mesh_cache_header header;
+		header.vertex_count = static_cast<uint32_t>(mesh.vertices.size());
+		header.index_count = static_cast<uint32_t>(mesh.indices.size());
+		header.lod_count = static_cast<uint32_t>(mesh.lods.size());
+		header.options = mesh_cache_options_of(options);
+		header.source_size = source.size;
+		header.source_time = source.time;
+		header.center[0] = mesh.center.x;
+		header.center[1] = mesh.center.y;
+		header.center[2] = mesh.center.z;
+		header.radius = mesh.radius;
+		header.lods_offset = align_up(sizeof(header));
+		header.vertices_offset = align_up(header.lods_offset + mesh.lods.size_bytes());
+		header.indices_offset = align_up(header.vertices_offset + mesh.vertices.size_bytes());
+
+		auto temporary = path + ".tmp";
+		{
+			std::ofstream file{ temporary, std::ios::binary | std::ios::trunc };
+			if (!file)
+			{
+				throw std::runtime_error("failed to create " + temporary);
+			}
+
+			auto write_at = [&](uint64_t offset, const void* data, size_t size) {
+				static const char zeros[SECTION_ALIGNMENT] = {};
+				auto padding = offset - static_cast<uint64_t>(file.tellp());
+				file.write(zeros, static_cast<std::streamsize>(padding));
+				file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+			};
+
+			write_at(0, &header, sizeof(header));
+			write_at(header.lods_offset, mesh.lods.data(), mesh.lods.size_bytes());
+			write_at(header.vertices_offset, mesh.vertices.data(), mesh.vertices.size_bytes());
+			write_at(header.indices_offset, mesh.indices.data(), mesh.indices.size_bytes());
+
+			if (!file.flush())
+			{
+				throw std::runtime_error("failed to write " + temporary);
+			}
+		}
+		std::filesystem::rename(temporary, path);
+	}
+
+	auto open_mesh_cache(const std::string& path, const mesh_source_stamp& source, const mesh_load_options& options)
+		-> std::optional<loaded_mesh>
+	{
+		if (!std::filesystem::exists(path))
+		{
+			return std::nullopt;
+		}
+
+		LVK_TRACE_SCOPE("open mesh cache");
+
+		file_view file{ path };
+		auto bytes = file.bytes();
+
+		mesh_cache_header header;
+		if (bytes.size() < sizeof(header))
+		{
+			return std::nullopt;
+		}
+		std::memcpy(&header, bytes.data(), sizeof(header));
+
+		if (std::memcmp(header.magic, mesh_cache_header{}.magic, sizeof(header.magic)) != 0
+			|| header.version != MESH_CACHE_VERSION
+			|| header.vertex_stride != sizeof(vertex)
+			|| header.options != mesh_cache_options_of(options)
+			|| header.source_size != source.size
+			|| header.source_time != source.time)
+		{
+			return std::nullopt;
+		}
+
+		// offsets come straight from the file, so check everything lands inside it and is aligned
+		if (header.lods_offset % alignof(lod_range) != 0
+			|| header.vertices_offset % alignof(vertex) != 0
+			|| header.indices_offset % alignof(uint32_t) != 0
+			|| !fits(header.lods_offset, uint64_t{ header.lod_count } * sizeof(lod_range), bytes.size())
+			|| !fits(header.vertices_offset, uint64_t{ header.vertex_count } * sizeof(vertex), bytes.size())
+			|| !fits(header.indices_offset, uint64_t{ header.index_count } * sizeof(uint32_t), bytes.size()))
+		{
+			return std::nullopt;
+		}
+
+		mesh_view mesh{
+			.vertices = { reinterpret_cast<const vertex*>(bytes.data() + header.vertices_offset), header.vertex_count },
+			.indices = { reinterpret_cast<const uint32_t*>(bytes.data() + header.indices_offset), header.index_count },
+			.lods = { reinterpret_cast<const lod_range*>(bytes.data() + header.lods_offset), header.lod_count },
+			.center = { header.center[0], header.center[1], header.center[2] },
+			.radius = header.radius,
+		};
+
+		// an index past the vertices would make the gpu read out of bounds, so that much gets checked
+		auto lods_valid = std::all_of(mesh.lods.begin(), mesh.lods.end(), [&](const lod_range& lod) {
+			return uint64_t{ lod.first_index } + lod.index_count <= header.index_count;
+		});
+		auto max_index = std::max_element(mesh.indices.begin(), mesh.indices.end());
+		if (mesh.lods.empty() || !lods_valid || (max_index != mesh.indices.end() && *max_index >= header.vertex_count))
+		{
+			return std::nullopt;
+		}
+
+		return loaded_mesh{ std::move(file), mesh };
+	}
+
+	auto load_mesh(const std::string& path, job_system& jobs, const mesh_load_options& options) -> loaded_mesh
+	{
+		LVK_TRACE_SCOPE("load mesh");
+
+		auto source = mesh_source_stamp::of(path);
+		auto cache = mesh_cache_path(path, options.cache_dir);
+		if (options.use_cache)
+		{
+			if (auto cached = open_mesh_cache(cache, source, options))
+			{
+				return std::move(*cached);
+			}
+		}
+
+		auto mesh = import_mesh(path, jobs);
+		if (options.generate_lods)
+		{
+			LVK_TRACE_SCOPE("generate lods");
+			generate_lods(mesh);
+		}
+		if (options.optimize)
+		{
+			optimize_mesh(mesh);
+		}
+
+		if (options.use_cache)
+		{
+			try
+			{
+				std::filesystem::create_directories(options.cache_dir);
+				write_mesh_cache(cache, mesh.view(), source, options);
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << "couldn't write mesh cache: " << e.what() << std::endl;
+			}
+		}
+		return loaded_mesh{ std::move(mesh) };
+	}
+}
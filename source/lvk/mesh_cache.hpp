@@ -0,0 +1,122 @@
+#pragma once
+
+#include "file_view.hpp"
+#include "mesh.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace lvk
+{
+	class job_system;
+
+	// bumped whenever the layout below, lvk::vertex or what load_mesh does before writing changes,
+	// caches from other versions just get rebuilt
+	constexpr uint32_t MESH_CACHE_VERSION = 3;
+
+	struct mesh_load_options
+	{
+		// caches go here, named after the source file
+		std::string cache_dir = "mesh_cache";
+		bool use_cache = true;
+		// lods are generated before the cache gets written, so they're free on every later run
+		bool generate_lods = true;
+		// vertex cache, overdraw and fetch order, see mesh_optimize.hpp
+		bool optimize = true;
+	};
+
+	// which of mesh_load_options' processing steps a cache went through, a cache is only any use
+	// to loads asking for the same ones
+	enum mesh_cache_options : uint32_t
+	{
+		MESH_CACHE_LODS = 1 << 0,
+		MESH_CACHE_OPTIMIZED = 1 << 1,
+	};
+
+	auto mesh_cache_options_of(const mesh_load_options& options) -> uint32_t;
+
+	// start of a .lvkmesh file. the lods, vertices and indices follow at the given offsets, laid out
+	// exactly like the vertex and index buffers so loading is a map and a memcpy into the staging buffer
+	struct mesh_cache_header
+	{
+		char magic[4] = { 'L', 'V', 'K', 'M' };
+		uint32_t version = MESH_CACHE_VERSION;
+		uint32_t vertex_stride = sizeof(vertex);
+		uint32_t vertex_count = 0;
+		uint32_t index_count = 0;
+		uint32_t lod_count = 0;
+		// mesh_cache_options bits
+		uint32_t options = 0;
+		uint32_t reserved = 0;
+
+		// size and modification time of the file the cache was built from, a mismatch means it's stale
+		uint64_t source_size = 0;
+		int64_t source_time = 0;
+
+		float center[3] = {};
+		float radius = 0.0f;
+
+		uint64_t lods_offset = 0;
+		uint64_t vertices_offset = 0;
+		uint64_t indices_offset = 0;
+	};
+
+	struct mesh_source_stamp
+	{
+		uint64_t size = 0;
+		int64_t time = 0;
+
+		// throws if the file doesn't exist
+		static auto of(const std::string& path) -> mesh_source_stamp;
+	};
+
+	// where load_mesh keeps the cache of source
+	auto mesh_cache_path(const std::string& source, const std::string& cache_dir) -> std::string;
+
+	// writes to a temporary file first and renames it over path, so a crash never leaves half a cache behind
+	// options are the ones mesh was processed with
+	void write_mesh_cache(const std::string& path, const mesh_view& mesh, const mesh_source_stamp& source, const mesh_load_options& options);
+
+	// a mesh that either points into a mapped cache file or owns its data
+	class loaded_mesh
+	{
+	public:
+		explicit loaded_mesh(file_view _file, const mesh_view& _mesh) : file{ std::move(_file) }, mesh{ _mesh }
+		{
+		}
+		explicit loaded_mesh(mesh_data _data) : data{ std::move(_data) }, mesh{ data.view() }
+		{
+		}
+
+		loaded_mesh(const loaded_mesh&) = delete;
+		loaded_mesh& operator=(const loaded_mesh&) = delete;
+		// neither a file_view's mapping nor a vector's storage moves along with it, so the view stays valid
+		loaded_mesh(loaded_mesh&&) = default;
+		loaded_mesh& operator=(loaded_mesh&&) = default;
+
+		auto view() const -> const mesh_view&
+		{
+			return mesh;
+		}
+		bool is_cached() const
+		{
+			return file.has_value();
+		}
+
+	private:
+		std::optional<file_view> file;
+		mesh_data data;
+		mesh_view mesh;
+	};
+
+	// maps a cache file and checks it against source. nullopt if it's missing, stale, from another
+	// version, built with other options or doesn't add up
+	auto open_mesh_cache(const std::string& path, const mesh_source_stamp& source, const mesh_load_options& options)
+		-> std::optional<loaded_mesh>;
+
+	// loads a mesh through its cache, importing it (see mesh_import.hpp) and writing a new cache if
+	// there's no valid one yet. failing to write the cache is only logged
+	auto load_mesh(const std::string& path, job_system& jobs, const mesh_load_options& options = {}) -> loaded_mesh;
+}
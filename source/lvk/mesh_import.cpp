@@ -0,0 +1,1083 @@
+#include "mesh_import.hpp"
+
+#include "file_view.hpp"
+#include "job_system.hpp"
+#include "json.hpp"
+#include "trace.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/matrix.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+
+namespace lvk
+{
+	namespace
+	{
+		constexpr uint32_t EMPTY_SLOT = ~0u;
+
+		// murmur3's finalizer, spreads the bits of ids and float patterns over the whole word
+		auto mix(uint64_t h) -> uint64_t
+		{
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdull;
+			h ^= h >> 33;
+			h *= 0xc4ceb9fe1a85ec53ull;
+			h ^= h >> 33;
+			return h;
+		}
+
+		// merges equal items with an open addressing table of item ids. unique gets the id of
+		// the first item of every group, the result maps every item to its group
+		template<typename Hash, typename Equal>
+		auto weld(size_t count, Hash&& hash, Equal&& equal, std::vector<uint32_t>& unique) -> std::vector<uint32_t>
+		{
+			if (count >= EMPTY_SLOT)
+			{
+				throw std::runtime_error("mesh has too many vertices for 32 bit indices");
+			}
+
+			auto mask = std::bit_ceil(std::max<size_t>(count * 2, 16)) - 1;
+			std::vector<uint32_t> slots(mask + 1, EMPTY_SLOT);
+			std::vector<uint32_t> remap(count);
+			unique.clear();
+
+			for (size_t i = 0; i < count; i++)
+			{
+				for (auto slot = hash(i) & mask;; slot = (slot + 1) & mask)
+				{
+					auto group = slots[slot];
+					if (group == EMPTY_SLOT)
+					{
+						group = static_cast<uint32_t>(unique.size());
+						slots[slot] = group;
+						unique.push_back(static_cast<uint32_t>(i));
+					}
+					else if (!equal(unique[group], i))
+					{
+						continue;
+					}
+					remap[i] = group;
+					break;
+				}
+			}
+			return remap;
+		}
+
+		void finish_mesh(mesh_data& mesh, const std::string& path)
+		{
+			if (mesh.indices.empty())
+			{
+				throw std::runtime_error("no triangles in " + path);
+			}
+			mesh.lods = { { 0, static_cast<uint32_t>(mesh.indices.size()), 0.0f } };
+			compute_bounds(mesh);
+		}
+
+		auto read_text(const file_view& file) -> std::string_view
+		{
+			auto bytes = file.bytes();
+			return { reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+		}
+
+		//
+		// obj
+		//
+
+		// lines past the first megabyte of a chunk go to the next one
+		constexpr size_t OBJ_CHUNK_SIZE = 1 << 20;
+
+		// obj indices are 1 based, 0 never shows up in a valid file
+		constexpr int64_t OBJ_MISSING = -1;
+
+		// one face corner as position/uv/normal indices. negative obj indices count back from the
+		// end of what's been read so far, which chunks only know about their own part of. those get
+		// stored relative to the chunk and flagged, then fixed up once every chunk's size is known
+		struct obj_corner
+		{
+			std::array<int64_t, 3> index{ OBJ_MISSING, OBJ_MISSING, OBJ_MISSING };
+			uint8_t relative = 0;
+		};
+
+		struct obj_chunk
+		{
+			std::string_view text;
+
+			std::vector<glm::vec3> positions;
+			std::vector<glm::vec2> uvs;
+			std::vector<glm::vec3> normals;
+			// already triangulated, three per triangle
+			std::vector<obj_corner> corners;
+
+			// where this chunk's attributes and corners start in the whole file
+			std::array<size_t, 3> attribute_offsets{};
+			size_t corner_offset = 0;
+		};
+
+		auto is_space(char c) -> bool
+		{
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		auto skip_spaces(const char* p, const char* end) -> const char*
+		{
+			while (p < end && is_space(*p))
+			{
+				p++;
+			}
+			return p;
+		}
+
+		auto parse_float(const char*& p, const char* end, float& value) -> bool
+		{
+			p = skip_spaces(p, end);
+			if (p < end && *p == '+')
+			{
+				p++;
+			}
+			auto result = std::from_chars(p, end, value);
+			if (result.ec != std::errc{})
+			{
+				return false;
+			}
+			p = result.ptr;
+			return true;
+		}
+
+		auto parse_index(const char*& p, const char* end, int64_t& value) -> bool
+		{
+			auto result = std::from_chars(p, end, value);
+			if (result.ec != std::errc{} || value == 0)
+			{
+				return false;
+			}
+			p = result.ptr;
+			return true;
+		}
+
+		void parse_obj_line(obj_chunk& chunk, const char* p, const char* end, std::vector<obj_corner>& face)
+		{
+			p = skip_spaces(p, end);
+			auto keyword_end = p;
+			while (keyword_end < end && !is_space(*keyword_end))
+			{
+				keyword_end++;
+			}
+			std::string_view keyword{ p, static_cast<size_t>(keyword_end - p) };
+			p = keyword_end;
+
+			if (keyword == "v")
+			{
+				// anything past xyz (w or vertex colors) gets ignored
+				glm::vec3 position;
+				if (!parse_float(p, end, position.x) || !parse_float(p, end, position.y) || !parse_float(p, end, position.z))
+				{
+					throw std::runtime_error("obj: invalid vertex position");
+				}
+				chunk.positions.push_back(position);
+			}
+			else if (keyword == "vt")
+			{
+				glm::vec2 uv{ 0.0f };
+				if (!parse_float(p, end, uv.x))
+				{
+					throw std::runtime_error("obj: invalid texture coordinate");
+				}
+				parse_float(p, end, uv.y);
+				// obj puts the origin at the bottom left, vulkan samples from the top left
+				chunk.uvs.push_back({ uv.x, 1.0f - uv.y });
+			}
+			else if (keyword == "vn")
+			{
+				glm::vec3 normal;
+				if (!parse_float(p, end, normal.x) || !parse_float(p, end, normal.y) || !parse_float(p, end, normal.z))
+				{
+					throw std::runtime_error("obj: invalid vertex normal");
+				}
+				chunk.normals.push_back(normal);
+			}
+			else if (keyword == "f")
+			{
+				std::array<size_t, 3> counts{ chunk.positions.size(), chunk.uvs.size(), chunk.normals.size() };
+
+				face.clear();
+				while ((p = skip_spaces(p, end)) < end)
+				{
+					// v, v/vt, v//vn or v/vt/vn
+					obj_corner corner;
+					for (size_t attribute = 0; attribute < 3; attribute++)
+					{
+						if (attribute != 0)
+						{
+							if (p == end || *p != '/')
+							{
+								break;
+							}
+							p++;
+							if (attribute == 1 && p < end && *p == '/')
+							{
+								continue;
+							}
+						}
+
+						int64_t value = 0;
+						if (!parse_index(p, end, value))
+						{
+							throw std::runtime_error("obj: invalid face index");
+						}
+						if (value > 0)
+						{
+							corner.index[attribute] = value - 1;
+						}
+						else
+						{
+							corner.index[attribute] = static_cast<int64_t>(counts[attribute]) + value;
+							corner.relative |= 1 << attribute;
+						}
+					}
+					face.push_back(corner);
+				}
+
+				for (size_t i = 1; i + 1 < face.size(); i++)
+				{
+					chunk.corners.insert(chunk.corners.end(), { face[0], face[i], face[i + 1] });
+				}
+			}
+		}
+
+		void parse_obj_chunk(obj_chunk& chunk)
+		{
+			const char* p = chunk.text.data();
+			const char* end = p + chunk.text.size();
+			std::vector<obj_corner> face;
+			while (p < end)
+			{
+				auto line_end = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+				if (line_end == nullptr)
+				{
+					line_end = end;
+				}
+				if (line_end != p && *p != '#')
+				{
+					parse_obj_line(chunk, p, line_end, face);
+				}
+				p = line_end + 1;
+			}
+		}
+
+		// runs f on every chunk on the job workers. jobs can't throw, so the first error
+		// gets carried out of the job and rethrown here
+		template<typename T, typename F>
+		void for_each_chunk(job_system& jobs, std::vector<T>& chunks, F&& f)
+		{
+			std::vector<std::exception_ptr> errors(chunks.size());
+			jobs.parallel_for(chunks.size(), 1, [&](size_t begin, size_t end) {
+				for (auto i = begin; i < end; i++)
+				{
+					try
+					{
+						f(chunks[i]);
+					}
+					catch (...)
+					{
+						errors[i] = std::current_exception();
+					}
+				}
+			});
+			for (const auto& error : errors)
+			{
+				if (error)
+				{
+					std::rethrow_exception(error);
+				}
+			}
+		}
+
+		//
+		// gltf
+		//
+
+		constexpr uint32_t GLB_MAGIC = 0x46546c67;
+		constexpr uint32_t GLB_CHUNK_JSON = 0x4e4f534a;
+		constexpr uint32_t GLB_CHUNK_BIN = 0x004e4942;
+
+		constexpr uint32_t GLTF_BYTE = 5120;
+		constexpr uint32_t GLTF_UNSIGNED_BYTE = 5121;
+		constexpr uint32_t GLTF_SHORT = 5122;
+		constexpr uint32_t GLTF_UNSIGNED_SHORT = 5123;
+		constexpr uint32_t GLTF_UNSIGNED_INT = 5125;
+		constexpr uint32_t GLTF_FLOAT = 5126;
+
+		constexpr uint32_t GLTF_TRIANGLES = 4;
+		constexpr uint32_t GLTF_TRIANGLE_STRIP = 5;
+		constexpr uint32_t GLTF_TRIANGLE_FAN = 6;
+
+		constexpr uint32_t MAX_NODE_DEPTH = 256;
+
+		// the document plus every buffer it references. buffers point into mapped files where
+		// possible, only base64 data uris get decoded into memory
+		struct gltf_asset
+		{
+			json document;
+			std::vector<file_view> files;
+			std::vector<std::vector<std::byte>> decoded;
+			std::vector<std::span<const std::byte>> buffers;
+		};
+
+		// a primitive together with the transform of the node that draws it
+		struct gltf_instance
+		{
+			const json* primitive;
+			glm::mat4 transform;
+		};
+
+		struct accessor_view
+		{
+			// null for accessors without a buffer view, which read as all zeros
+			const std::byte* data = nullptr;
+			size_t stride = 0;
+			size_t count = 0;
+			uint32_t component_type = GLTF_FLOAT;
+			uint32_t components = 1;
+			bool normalized = false;
+		};
+
+		// byteOffset and byteLength, 0 when they're missing. anything that isn't a size would turn into
+		// garbage offsets, so it's an error rather than a fallback
+		auto byte_size(const json& value, const std::string& what) -> size_t
+		{
+			if (value.is_null())
+			{
+				return 0;
+			}
+			constexpr auto INVALID = std::numeric_limits<size_t>::max();
+			auto size = value.size_or(INVALID);
+			if (size == INVALID)
+			{
+				throw std::runtime_error("gltf: " + what + " isn't a valid byte count");
+			}
+			return size;
+		}
+
+		auto read_u32(const std::byte* p) -> uint32_t
+		{
+			uint32_t value;
+			std::memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		auto decode_base64(std::string_view text) -> std::vector<std::byte>
+		{
+			auto sextet = [](char c) -> int {
+				if (c >= 'A' && c <= 'Z') return c - 'A';
+				if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+				if (c >= '0' && c <= '9') return c - '0' + 52;
+				if (c == '+') return 62;
+				if (c == '/') return 63;
+				return -1;
+			};
+
+			std::vector<std::byte> out;
+			out.reserve(text.size() / 4 * 3);
+			uint32_t bits = 0;
+			int bit_count = 0;
+			for (char c : text)
+			{
+				if (c == '=')
+				{
+					break;
+				}
+				auto value = sextet(c);
+				if (value < 0)
+				{
+					throw std::runtime_error("gltf: invalid base64 data");
+				}
+				bits = (bits << 6) | static_cast<uint32_t>(value);
+				bit_count += 6;
+				if (bit_count >= 8)
+				{
+					bit_count -= 8;
+					out.push_back(static_cast<std::byte>((bits >> bit_count) & 0xff));
+				}
+			}
+			return out;
+		}
+
+		auto decode_uri(std::string_view uri) -> std::string
+		{
+			std::string out;
+			for (size_t i = 0; i < uri.size(); i++)
+			{
+				uint32_t code = 0;
+				if (uri[i] == '%' && i + 2 < uri.size()
+					&& std::from_chars(uri.data() + i + 1, uri.data() + i + 3, code, 16).ptr == uri.data() + i + 3)
+				{
+					out += static_cast<char>(code);
+					i += 2;
+				}
+				else
+				{
+					out += uri[i];
+				}
+			}
+			return out;
+		}
+
+		auto load_gltf(const std::string& path) -> gltf_asset
+		{
+			gltf_asset asset;
+			auto& file = asset.files.emplace_back(path);
+			auto bytes = file.bytes();
+
+			std::span<const std::byte> binary_chunk;
+			if (bytes.size() >= 12 && read_u32(bytes.data()) == GLB_MAGIC)
+			{
+				// glb: a 12 byte header, then the json chunk and optionally one binary chunk
+				if (read_u32(bytes.data() + 4) != 2)
+				{
+					throw std::runtime_error("gltf: only version 2 glb files are supported");
+				}
+
+				std::string_view text;
+				for (size_t offset = 12; offset + 8 <= bytes.size();)
+				{
+					auto length = read_u32(bytes.data() + offset);
+					auto type = read_u32(bytes.data() + offset + 4);
+					if (offset + 8 + length > bytes.size())
+					{
+						throw std::runtime_error("gltf: truncated glb chunk");
+					}
+
+					auto chunk = bytes.subspan(offset + 8, length);
+					if (type == GLB_CHUNK_JSON && text.empty())
+					{
+						text = { reinterpret_cast<const char*>(chunk.data()), chunk.size() };
+					}
+					else if (type == GLB_CHUNK_BIN && binary_chunk.empty())
+					{
+						binary_chunk = chunk;
+					}
+					offset += 8 + ((length + 3) & ~size_t{ 3 });
+				}
+				asset.document = json::parse(text);
+			}
+			else
+			{
+				asset.document = json::parse(read_text(file));
+			}
+
+			if (asset.document["asset"]["version"].as_string().substr(0, 2) != "2.")
+			{
+				throw std::runtime_error("gltf: only version 2.x is supported");
+			}
+
+			auto directory = std::filesystem::path{ path }.parent_path();
+			const auto& buffers = asset.document["buffers"].items();
+			for (size_t i = 0; i < buffers.size(); i++)
+			{
+				std::span<const std::byte> data;
+				if (!buffers[i].contains("uri"))
+				{
+					// only a glb's first buffer can live in its binary chunk
+					if (i != 0)
+					{
+						throw std::runtime_error("gltf: buffer without uri");
+					}
+					data = binary_chunk;
+				}
+				else if (const auto& uri = buffers[i]["uri"].as_string(); uri.starts_with("data:"))
+				{
+					auto comma = uri.find(',');
+					if (comma == std::string::npos || uri.substr(0, comma).find(";base64") == std::string::npos)
+					{
+						throw std::runtime_error("gltf: only base64 data uris are supported");
+					}
+					auto& decoded = asset.decoded.emplace_back(decode_base64(std::string_view{ uri }.substr(comma + 1)));
+					data = decoded;
+				}
+				else
+				{
+					// moving a file_view keeps its data where it is, so the span survives the vector growing
+					data = asset.files.emplace_back((directory / decode_uri(uri)).string()).bytes();
+				}
+
+				auto length = byte_size(buffers[i]["byteLength"], "byteLength of buffer " + std::to_string(i));
+				if (data.size() < length)
+				{
+					throw std::runtime_error("gltf: buffer " + std::to_string(i) + " is shorter than its byteLength");
+				}
+				asset.buffers.push_back(data.first(length));
+			}
+			return asset;
+		}
+
+		auto component_size(uint32_t component_type) -> size_t
+		{
+			switch (component_type)
+			{
+			case GLTF_BYTE:
+			case GLTF_UNSIGNED_BYTE:
+				return 1;
+			case GLTF_SHORT:
+			case GLTF_UNSIGNED_SHORT:
+				return 2;
+			case GLTF_UNSIGNED_INT:
+			case GLTF_FLOAT:
+				return 4;
+			default:
+				throw std::runtime_error("gltf: unknown component type " + std::to_string(component_type));
+			}
+		}
+
+		auto component_count(const std::string& type) -> uint32_t
+		{
+			if (type == "SCALAR") return 1;
+			if (type == "VEC2") return 2;
+			if (type == "VEC3") return 3;
+			if (type == "VEC4") return 4;
+			throw std::runtime_error("gltf: unsupported accessor type " + type);
+		}
+
+		auto get_accessor(const gltf_asset& asset, uint32_t index) -> accessor_view
+		{
+			const auto& accessor = asset.document["accessors"][index];
+			if (accessor.is_null())
+			{
+				throw std::runtime_error("gltf: accessor " + std::to_string(index) + " doesn't exist");
+			}
+			if (accessor.contains("sparse"))
+			{
+				throw std::runtime_error("gltf: sparse accessors aren't supported");
+			}
+
+			accessor_view view;
+			view.count = accessor["count"].uint_or(0);
+			view.component_type = accessor["componentType"].uint_or(0);
+			view.components = component_count(accessor["type"].as_string());
+			view.normalized = accessor["normalized"].as_bool();
+
+			auto element_size = component_size(view.component_type) * view.components;
+			view.stride = element_size;
+			if (!accessor.contains("bufferView"))
+			{
+				return view;
+			}
+
+			const auto& buffer_view = asset.document["bufferViews"][accessor["bufferView"].uint_or(~0u)];
+			auto buffer = buffer_view["buffer"].uint_or(~0u);
+			if (buffer_view.is_null() || buffer >= asset.buffers.size())
+			{
+				throw std::runtime_error("gltf: accessor " + std::to_string(index) + " points at a missing buffer");
+			}
+
+			auto name = "accessor " + std::to_string(index);
+			auto view_offset = byte_size(buffer_view["byteOffset"], "byteOffset of the buffer view of " + name);
+			auto view_length = byte_size(buffer_view["byteLength"], "byteLength of the buffer view of " + name);
+			auto offset = byte_size(accessor["byteOffset"], "byteOffset of " + name);
+			view.stride = buffer_view["byteStride"].uint_or(static_cast<uint32_t>(element_size));
+
+			// written so nothing can wrap around. stride and count are at most 32 bits each, so their
+			// product fits in 64
+			auto buffer_size = asset.buffers[buffer].size();
+			if (view_offset > buffer_size || view_length > buffer_size - view_offset
+				|| (view.count != 0
+					&& (offset > view_length
+						|| uint64_t{ view.stride } * (view.count - 1) + element_size > view_length - offset)))
+			{
+				throw std::runtime_error("gltf: " + name + " reads past its buffer");
+			}
+
+			view.data = asset.buffers[buffer].data() + view_offset + offset;
+			return view;
+		}
+
+		auto read_float(const accessor_view& view, size_t element, uint32_t component) -> float
+		{
+			if (view.data == nullptr || component >= view.components)
+			{
+				return 0.0f;
+			}
+
+			auto p = view.data + element * view.stride + component * component_size(view.component_type);
+			switch (view.component_type)
+			{
+			case GLTF_FLOAT:
+			{
+				float value;
+				std::memcpy(&value, p, sizeof(value));
+				return value;
+			}
+			case GLTF_UNSIGNED_BYTE:
+			{
+				auto value = static_cast<float>(std::to_integer<uint8_t>(*p));
+				return view.normalized ? value / 255.0f : value;
+			}
+			case GLTF_BYTE:
+			{
+				auto value = static_cast<float>(static_cast<int8_t>(std::to_integer<uint8_t>(*p)));
+				return view.normalized ? std::max(value / 127.0f, -1.0f) : value;
+			}
+			case GLTF_UNSIGNED_SHORT:
+			{
+				uint16_t value;
+				std::memcpy(&value, p, sizeof(value));
+				return view.normalized ? static_cast<float>(value) / 65535.0f : static_cast<float>(value);
+			}
+			case GLTF_SHORT:
+			{
+				int16_t value;
+				std::memcpy(&value, p, sizeof(value));
+				return view.normalized ? std::max(static_cast<float>(value) / 32767.0f, -1.0f) : static_cast<float>(value);
+			}
+			default:
+			{
+				uint32_t value;
+				std::memcpy(&value, p, sizeof(value));
+				return static_cast<float>(value);
+			}
+			}
+		}
+
+		auto read_index(const accessor_view& view, size_t element) -> uint32_t
+		{
+			if (view.data == nullptr)
+			{
+				return 0;
+			}
+
+			auto p = view.data + element * view.stride;
+			switch (view.component_type)
+			{
+			case GLTF_UNSIGNED_BYTE:
+				return std::to_integer<uint32_t>(*p);
+			case GLTF_UNSIGNED_SHORT:
+			{
+				uint16_t value;
+				std::memcpy(&value, p, sizeof(value));
+				return value;
+			}
+			case GLTF_UNSIGNED_INT:
+				return read_u32(p);
+			default:
+				throw std::runtime_error("gltf: indices have to be unsigned integers");
+			}
+		}
+
+		auto local_transform(const json& node) -> glm::mat4
+		{
+			if (const auto& matrix = node["matrix"]; matrix.size() == 16)
+			{
+				// gltf matrices are column major, same as glm
+				std::array<float, 16> values;
+				for (size_t i = 0; i < values.size(); i++)
+				{
+					values[i] = static_cast<float>(matrix[i].number_or(0.0));
+				}
+				return glm::make_mat4(values.data());
+			}
+
+			auto vector = [](const json& value, glm::vec4 fallback) {
+				for (size_t i = 0; i < 4 && i < value.size(); i++)
+				{
+					fallback[static_cast<glm::length_t>(i)] = static_cast<float>(value[i].number_or(fallback[static_cast<glm::length_t>(i)]));
+				}
+				return fallback;
+			};
+			auto translation = vector(node["translation"], glm::vec4{ 0.0f });
+			auto rotation = vector(node["rotation"], glm::vec4{ 0.0f, 0.0f, 0.0f, 1.0f });
+			auto scale = vector(node["scale"], glm::vec4{ 1.0f });
+
+			return glm::translate(glm::mat4{ 1.0f }, glm::vec3{ translation })
+				 * glm::mat4_cast(glm::quat{ rotation.w, rotation.x, rotation.y, rotation.z })
+				 * glm::scale(glm::mat4{ 1.0f }, glm::vec3{ scale });
+		}
+
+		void collect_node(const json& document, uint32_t index, const glm::mat4& parent, uint32_t depth, std::vector<gltf_instance>& instances)
+		{
+			const auto& node = document["nodes"][index];
+			if (node.is_null() || depth > MAX_NODE_DEPTH)
+			{
+				throw std::runtime_error("gltf: broken node hierarchy");
+			}
+
+			auto transform = parent * local_transform(node);
+			if (node.contains("mesh"))
+			{
+				for (const auto& primitive : document["meshes"][node["mesh"].uint_or(~0u)]["primitives"].items())
+				{
+					instances.push_back({ &primitive, transform });
+				}
+			}
+			for (const auto& child : node["children"].items())
+			{
+				collect_node(document, child.uint_or(~0u), transform, depth + 1, instances);
+			}
+		}
+
+		auto collect_instances(const json& document) -> std::vector<gltf_instance>
+		{
+			std::vector<gltf_instance> instances;
+			glm::mat4 identity{ 1.0f };
+
+			const auto& nodes = document["nodes"];
+			if (nodes.size() == 0)
+			{
+				// no scene graph at all, every mesh sits at the origin
+				for (const auto& mesh : document["meshes"].items())
+				{
+					for (const auto& primitive : mesh["primitives"].items())
+					{
+						instances.push_back({ &primitive, identity });
+					}
+				}
+				return instances;
+			}
+
+			if (const auto& scenes = document["scenes"]; scenes.size() != 0)
+			{
+				for (const auto& root : scenes[document["scene"].uint_or(0)]["nodes"].items())
+				{
+					collect_node(document, root.uint_or(~0u), identity, 0, instances);
+				}
+				return instances;
+			}
+
+			// no scenes, so every node that isn't somebody's child is a root
+			std::vector<bool> is_child(nodes.size(), false);
+			for (const auto& node : nodes.items())
+			{
+				for (const auto& child : node["children"].items())
+				{
+					if (auto index = child.uint_or(~0u); index < is_child.size())
+					{
+						is_child[index] = true;
+					}
+				}
+			}
+			for (uint32_t i = 0; i < nodes.size(); i++)
+			{
+				if (!is_child[i])
+				{
+					collect_node(document, i, identity, 0, instances);
+				}
+			}
+			return instances;
+		}
+
+		// one primitive in model space as a standalone indexed triangle list
+		auto decode_primitive(const gltf_asset& asset, const gltf_instance& instance) -> mesh_data
+		{
+			const auto& primitive = *instance.primitive;
+			const auto& attributes = primitive["attributes"];
+			auto mode = primitive["mode"].uint_or(GLTF_TRIANGLES);
+
+			mesh_data part;
+			if (!attributes.contains("POSITION") || (mode != GLTF_TRIANGLES && mode != GLTF_TRIANGLE_STRIP && mode != GLTF_TRIANGLE_FAN))
+			{
+				// points and lines have nothing to draw here
+				return part;
+			}
+
+			auto positions = get_accessor(asset, attributes["POSITION"].uint_or(~0u));
+			auto has_normals = attributes.contains("NORMAL");
+			auto normals = has_normals ? get_accessor(asset, attributes["NORMAL"].uint_or(~0u)) : accessor_view{};
+			auto uvs = attributes.contains("TEXCOORD_0") ? get_accessor(asset, attributes["TEXCOORD_0"].uint_or(~0u)) : accessor_view{};
+			if ((has_normals && normals.count != positions.count) || (uvs.data != nullptr && uvs.count != positions.count))
+			{
+				throw std::runtime_error("gltf: primitive attributes have different counts");
+			}
+
+			auto normal_matrix = glm::transpose(glm::inverse(glm::mat3{ instance.transform }));
+			part.vertices.resize(positions.count);
+			for (size_t i = 0; i < positions.count; i++)
+			{
+				auto& v = part.vertices[i];
+				glm::vec4 position{ read_float(positions, i, 0), read_float(positions, i, 1), read_float(positions, i, 2), 1.0f };
+				v.position = glm::vec3{ instance.transform * position };
+
+				glm::vec3 normal{ read_float(normals, i, 0), read_float(normals, i, 1), read_float(normals, i, 2) };
+				auto length = glm::length(normal);
+				v.normal = length > 0.0f ? glm::normalize(normal_matrix * (normal / length)) : normal;
+
+				v.uv = { read_float(uvs, i, 0), read_float(uvs, i, 1) };
+			}
+
+			std::vector<uint32_t> indices;
+			if (primitive.contains("indices"))
+			{
+				auto accessor = get_accessor(asset, primitive["indices"].uint_or(~0u));
+				indices.resize(accessor.count);
+				for (size_t i = 0; i < accessor.count; i++)
+				{
+					indices[i] = read_index(accessor, i);
+					if (indices[i] >= positions.count)
+					{
+						throw std::runtime_error("gltf: index out of range");
+					}
+				}
+			}
+			else
+			{
+				indices.resize(positions.count);
+				std::iota(indices.begin(), indices.end(), 0u);
+			}
+
+			// a mirroring transform flips the winding, flip it back
+			auto mirrored = glm::determinant(glm::mat3{ instance.transform }) < 0.0f;
+			auto add_triangle = [&](uint32_t a, uint32_t b, uint32_t c) {
+				if (mirrored)
+				{
+					std::swap(b, c);
+				}
+				part.indices.insert(part.indices.end(), { a, b, c });
+			};
+
+			if (mode == GLTF_TRIANGLES)
+			{
+				for (size_t i = 0; i + 2 < indices.size(); i += 3)
+				{
+					add_triangle(indices[i], indices[i + 1], indices[i + 2]);
+				}
+			}
+			else
+			{
+				for (size_t i = 0; i + 2 < indices.size(); i++)
+				{
+					if (mode == GLTF_TRIANGLE_FAN)
+					{
+						add_triangle(indices[0], indices[i + 1], indices[i + 2]);
+					}
+					else if (i % 2 == 0)
+					{
+						add_triangle(indices[i], indices[i + 1], indices[i + 2]);
+					}
+					else
+					{
+						add_triangle(indices[i + 1], indices[i], indices[i + 2]);
+					}
+				}
+			}
+
+			if (!has_normals)
+			{
+				compute_normals(part);
+			}
+			return part;
+		}
+
+		// merges vertices that are identical down to the bit
+		void weld_vertices(mesh_data& mesh)
+		{
+			constexpr size_t WORDS = sizeof(vertex) / sizeof(uint32_t);
+			static_assert(sizeof(vertex) % sizeof(uint32_t) == 0);
+
+			auto hash = [&](size_t i) {
+				std::array<uint32_t, WORDS> words;
+				std::memcpy(words.data(), &mesh.vertices[i], sizeof(vertex));
+				uint64_t h = 0;
+				for (auto word : words)
+				{
+					h = mix(h ^ word);
+				}
+				return h;
+			};
+			auto equal = [&](size_t a, size_t b) {
+				return std::memcmp(&mesh.vertices[a], &mesh.vertices[b], sizeof(vertex)) == 0;
+			};
+
+			std::vector<uint32_t> unique;
+			auto remap = weld(mesh.vertices.size(), hash, equal, unique);
+
+			std::vector<vertex> vertices(unique.size());
+			for (size_t i = 0; i < unique.size(); i++)
+			{
+				vertices[i] = mesh.vertices[unique[i]];
+			}
+			mesh.vertices = std::move(vertices);
+			for (auto& index : mesh.indices)
+			{
+				index = remap[index];
+			}
+		}
+	}
+
+	auto import_obj(const std::string& path, job_system& jobs) -> mesh_data
+	{
+		LVK_TRACE_SCOPE("import obj");
+
+		file_view file{ path };
+		auto text = read_text(file);
+
+		std::vector<obj_chunk> chunks;
+		for (size_t begin = 0; begin < text.size();)
+		{
+			auto end = std::min(begin + OBJ_CHUNK_SIZE, text.size());
+			end = std::min(text.find('\n', end), text.size());
+			chunks.emplace_back().text = text.substr(begin, end - begin);
+			begin = end + 1;
+		}
+
+		{
+			LVK_TRACE_SCOPE("parse chunks");
+			for_each_chunk(jobs, chunks, parse_obj_chunk);
+		}
+
+		std::array<size_t, 3> totals{};
+		size_t corner_count = 0;
+		for (auto& chunk : chunks)
+		{
+			chunk.attribute_offsets = totals;
+			chunk.corner_offset = corner_count;
+			totals[0] += chunk.positions.size();
+			totals[1] += chunk.uvs.size();
+			totals[2] += chunk.normals.size();
+			corner_count += chunk.corners.size();
+		}
+
+		// every chunk copies its part into the whole file's arrays and resolves its relative indices
+		std::vector<glm::vec3> positions(totals[0]);
+		std::vector<glm::vec2> uvs(totals[1]);
+		std::vector<glm::vec3> normals(totals[2]);
+		std::vector<obj_corner> corners(corner_count);
+		{
+			LVK_TRACE_SCOPE("resolve indices");
+			for_each_chunk(jobs, chunks, [&](obj_chunk& chunk) {
+				std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.attribute_offsets[0]);
+				std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + chunk.attribute_offsets[1]);
+				std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.attribute_offsets[2]);
+
+				for (size_t i = 0; i < chunk.corners.size(); i++)
+				{
+					auto corner = chunk.corners[i];
+					for (size_t attribute = 0; attribute < 3; attribute++)
+					{
+						auto& index = corner.index[attribute];
+						if (corner.relative & (1 << attribute))
+						{
+							index += static_cast<int64_t>(chunk.attribute_offsets[attribute]);
+						}
+						else if (index == OBJ_MISSING && attribute != 0)
+						{
+							continue;
+						}
+						if (index < 0 || static_cast<size_t>(index) >= totals[attribute])
+						{
+							throw std::runtime_error("obj: face index out of range");
+						}
+					}
+					corners[chunk.corner_offset + i] = corner;
+				}
+				chunk = obj_chunk{};
+			});
+		}
+
+		mesh_data mesh;
+		bool has_normals = true;
+		{
+			LVK_TRACE_SCOPE("weld vertices");
+			auto hash = [&](size_t i) {
+				const auto& index = corners[i].index;
+				return mix(mix(mix(static_cast<uint64_t>(index[0])) ^ static_cast<uint64_t>(index[1])) ^ static_cast<uint64_t>(index[2]));
+			};
+			auto equal = [&](size_t a, size_t b) {
+				return corners[a].index == corners[b].index;
+			};
+
+			std::vector<uint32_t> unique;
+			mesh.indices = weld(corners.size(), hash, equal, unique);
+
+			mesh.vertices.resize(unique.size());
+			jobs.parallel_for(unique.size(), 4096, [&](size_t begin, size_t end) {
+				for (auto i = begin; i < end; i++)
+				{
+					const auto& index = corners[unique[i]].index;
+					auto& v = mesh.vertices[i];
+					v.position = positions[static_cast<size_t>(index[0])];
+					v.uv = index[1] != OBJ_MISSING ? uvs[static_cast<size_t>(index[1])] : glm::vec2{ 0.0f };
+					v.normal = index[2] != OBJ_MISSING ? normals[static_cast<size_t>(index[2])] : glm::vec3{ 0.0f };
+				}
+			});
+
+			has_normals = std::all_of(corners.begin(), corners.end(), [](const obj_corner& corner) {
+				return corner.index[2] != OBJ_MISSING;
+			});
+		}
+
+		if (!has_normals)
+		{
+			compute_normals(mesh);
+		}
+		finish_mesh(mesh, path);
+		return mesh;
+	}
+
+	auto import_gltf(const std::string& path, job_system& jobs) -> mesh_data
+	{
+		LVK_TRACE_SCOPE("import gltf");
+
+		auto asset = load_gltf(path);
+		auto instances = collect_instances(asset.document);
+
+		std::vector<mesh_data> parts(instances.size());
+		{
+			LVK_TRACE_SCOPE("decode primitives");
+			std::vector<size_t> order(instances.size());
+			std::iota(order.begin(), order.end(), size_t{ 0 });
+			for_each_chunk(jobs, order, [&](size_t i) {
+				parts[i] = decode_primitive(asset, instances[i]);
+			});
+		}
+
+		mesh_data mesh;
+		for (const auto& part : parts)
+		{
+			auto base = static_cast<uint32_t>(mesh.vertices.size());
+			mesh.vertices.insert(mesh.vertices.end(), part.vertices.begin(), part.vertices.end());
+			for (auto index : part.indices)
+			{
+				mesh.indices.push_back(base + index);
+			}
+		}
+
+		{
+			LVK_TRACE_SCOPE("weld vertices");
+			weld_vertices(mesh);
+		}
+		finish_mesh(mesh, path);
+		return mesh;
+	}
+
+	auto import_mesh(const std::string& path, job_system& jobs) -> mesh_data
+	{
+		auto extension = std::filesystem::path{ path }.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+			return static_cast<char>(std::tolower(c));
+		});
+
+		if (extension == ".obj")
+		{
+			return import_obj(path, jobs);
+		}
+		if (extension == ".gltf" || extension == ".glb")
+		{
+			return import_gltf(path, jobs);
+		}
+		throw std::runtime_error("don't know how to import " + path);
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "mesh.hpp"
+
+#include <string>
+
+namespace lvk
+{
+	class job_system;
+
+	// wavefront obj. the file is split into line aligned chunks that get parsed on the job workers,
+	// faces are triangulated as fans and vertices sharing the same position/uv/normal are merged.
+	// materials, groups and anything that isn't v/vt/vn/f get skipped
+	auto import_obj(const std::string& path, job_system& jobs) -> mesh_data;
+
+	// gltf 2.0, both .gltf (external or base64 buffers) and .glb. every triangle primitive in the
+	// default scene gets decoded on the job workers, baked into model space and merged into one mesh,
+	// identical vertices are welded afterwards. materials, skins and morph targets are ignored
+	auto import_gltf(const std::string& path, job_system& jobs) -> mesh_data;
+
+	// picks the importer by extension. the result has a single lod and its bounds filled in
+	auto import_mesh(const std::string& path, job_system& jobs) -> mesh_data;
+}
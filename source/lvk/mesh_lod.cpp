@@ -0,0 +1,422 @@
+#include "mesh_lod.hpp"
+
+#include "trace.hpp"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace lvk
+{
+	namespace
+	{
+		// sum of squared distances to a set of planes, as the upper triangle of the symmetric 4x4.
+		// planes are weighted by triangle area, weight keeps the total so errors come out as a mean
+		struct quadric
+		{
+			double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+			double a11 = 0, a12 = 0, a13 = 0;
+			double a22 = 0, a23 = 0;
+			double a33 = 0;
+			double weight = 0;
+
+			void add_plane(glm::vec3 normal, float distance, double w)
+			{
+				double x = normal.x, y = normal.y, z = normal.z, d = distance;
+				a00 += w * x * x; a01 += w * x * y; a02 += w * x * z; a03 += w * x * d;
+				a11 += w * y * y; a12 += w * y * z; a13 += w * y * d;
+				a22 += w * z * z; a23 += w * z * d;
+				a33 += w * d * d;
+				weight += w;
+			}
+
+			void add(const quadric& other)
+			{
+				a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+				a11 += other.a11; a12 += other.a12; a13 += other.a13;
+				a22 += other.a22; a23 += other.a23;
+				a33 += other.a33;
+				weight += other.weight;
+			}
+
+			// mean squared distance of p to the planes
+			auto error(glm::vec3 p) const -> double
+			{
+				double x = p.x, y = p.y, z = p.z;
+				double e = a00 * x * x + a11 * y * y + a22 * z * z + a33
+					+ 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z + a03 * x + a13 * y + a23 * z);
+				return weight > 0.0 ? std::max(e, 0.0) / weight : 0.0;
+			}
+		};
+
+		struct position_hash
+		{
+			size_t operator()(const glm::vec3& p) const
+			{
+				uint32_t bits[3];
+				std::memcpy(bits, &p, sizeof(bits));
+				return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+			}
+		};
+
+		struct position_equal
+		{
+			bool operator()(const glm::vec3& a, const glm::vec3& b) const
+			{
+				return a.x == b.x && a.y == b.y && a.z == b.z;
+			}
+		};
+
+		struct edge
+		{
+			uint32_t a, b;
+			bool border;
+		};
+
+		struct collapse
+		{
+			double cost;
+			uint32_t from, to;
+		};
+
+		constexpr auto edge_key(uint32_t a, uint32_t b) -> uint64_t
+		{
+			return a < b ? (uint64_t{ a } << 32) | b : (uint64_t{ b } << 32) | a;
+		}
+	}
+
+	auto simplify_mesh(
+		std::span<const vertex> vertices,
+		std::span<const uint32_t> indices,
+		size_t target_index_count,
+		float max_error,
+		float* result_error) -> std::vector<uint32_t>
+	{
+		LVK_TRACE_SCOPE("simplify mesh");
+
+		std::vector<uint32_t> result(indices.begin(), indices.end());
+		if (result_error)
+		{
+			*result_error = 0.0f;
+		}
+		if (result.size() <= target_index_count)
+		{
+			return result;
+		}
+
+		// vertices sharing a position (uv seams, hard edges) only differ in attributes, so the
+		// topology works on classes of them named after their first vertex
+		auto vertex_count = static_cast<uint32_t>(vertices.size());
+		std::vector<uint32_t> classes(vertex_count);
+		{
+			std::unordered_map<glm::vec3, uint32_t, position_hash, position_equal> first_with_position;
+			first_with_position.reserve(vertex_count);
+			for (uint32_t v = 0; v < vertex_count; v++)
+			{
+				classes[v] = first_with_position.try_emplace(vertices[v].position, v).first->second;
+			}
+		}
+
+		auto position = [&](uint32_t c) { return vertices[c].position; };
+
+		std::vector<quadric> quadrics(vertex_count);
+		for (size_t t = 0; t < result.size(); t += 3)
+		{
+			auto c0 = classes[result[t]], c1 = classes[result[t + 1]], c2 = classes[result[t + 2]];
+			auto normal = glm::cross(position(c1) - position(c0), position(c2) - position(c0));
+			auto length = glm::length(normal);
+			if (length == 0.0f)
+			{
+				continue;
+			}
+
+			normal /= length;
+			auto distance = -glm::dot(normal, position(c0));
+			for (auto c : { c0, c1, c2 })
+			{
+				quadrics[c].add_plane(normal, distance, length * 0.5);
+			}
+		}
+
+		const double max_cost = static_cast<double>(max_error) * max_error;
+		double worst_cost = 0.0;
+
+		std::vector<uint32_t> collapse_to(vertex_count);
+		std::vector<uint32_t> adjacency_offsets(vertex_count + 1);
+		std::vector<uint32_t> adjacency;
+		std::vector<uint64_t> edges;
+		std::vector<edge> unique_edges;
+		std::vector<collapse> candidates;
+		std::vector<uint8_t> border(vertex_count);
+		std::vector<uint8_t> locked(vertex_count);
+
+		// every pass collapses a batch of independent edges, then rebuilds the topology
+		while (result.size() > target_index_count)
+		{
+			auto triangle_count = result.size() / 3;
+
+			// triangles around every class
+			std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+			for (auto index : result)
+			{
+				adjacency_offsets[classes[index] + 1]++;
+			}
+			for (uint32_t c = 0; c < vertex_count; c++)
+			{
+				adjacency_offsets[c + 1] += adjacency_offsets[c];
+			}
+			adjacency.resize(result.size());
+			{
+				auto cursor = adjacency_offsets;
+				for (size_t i = 0; i < result.size(); i++)
+				{
+					adjacency[cursor[classes[result[i]]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			// edges used by a single triangle are on the border, which mustn't shrink
+			edges.clear();
+			for (size_t t = 0; t < result.size(); t += 3)
+			{
+				for (size_t k = 0; k < 3; k++)
+				{
+					edges.push_back(edge_key(classes[result[t + k]], classes[result[t + (k + 1) % 3]]));
+				}
+			}
+			std::sort(edges.begin(), edges.end());
+
+			std::fill(border.begin(), border.end(), 0);
+			unique_edges.clear();
+			for (size_t i = 0; i < edges.size();)
+			{
+				auto key = edges[i];
+				size_t uses = 0;
+				for (; i < edges.size() && edges[i] == key; i++)
+				{
+					uses++;
+				}
+
+				edge e{ static_cast<uint32_t>(key >> 32), static_cast<uint32_t>(key & 0xffffffffu), uses == 1 };
+				if (e.border)
+				{
+					border[e.a] = border[e.b] = 1;
+				}
+				unique_edges.push_back(e);
+			}
+
+			// a border vertex may only slide along a border edge
+			candidates.clear();
+			for (const auto& e : unique_edges)
+			{
+				quadric merged = quadrics[e.a];
+				merged.add(quadrics[e.b]);
+
+				auto infinity = std::numeric_limits<double>::infinity();
+				auto a_to_b = !border[e.a] || e.border ? merged.error(position(e.b)) : infinity;
+				auto b_to_a = !border[e.b] || e.border ? merged.error(position(e.a)) : infinity;
+
+				candidates.push_back(a_to_b <= b_to_a ? collapse{ a_to_b, e.a, e.b } : collapse{ b_to_a, e.b, e.a });
+			}
+			std::sort(candidates.begin(), candidates.end(), [](const collapse& l, const collapse& r) {
+				return l.cost < r.cost;
+			});
+
+			for (uint32_t c = 0; c < vertex_count; c++)
+			{
+				collapse_to[c] = c;
+			}
+			std::fill(locked.begin(), locked.end(), 0);
+
+			auto triangles_to_remove = (result.size() - target_index_count + 2) / 3;
+			size_t removed = 0;
+			size_t collapses = 0;
+
+			for (const auto& candidate : candidates)
+			{
+				if (removed >= triangles_to_remove || candidate.cost > max_cost)
+				{
+					break;
+				}
+
+				auto from = candidate.from, to = candidate.to;
+				if (locked[from] || locked[to])
+				{
+					continue;
+				}
+
+				// moving from onto to must not turn any remaining triangle around
+				bool flips = false;
+				size_t shared = 0;
+				for (auto a = adjacency_offsets[from]; a < adjacency_offsets[from + 1] && !flips; a++)
+				{
+					auto t = adjacency[a] * 3;
+					uint32_t corner[3] = { classes[result[t]], classes[result[t + 1]], classes[result[t + 2]] };
+					if (corner[0] == to || corner[1] == to || corner[2] == to)
+					{
+						shared++;
+						continue;
+					}
+
+					glm::vec3 before[3], after[3];
+					for (size_t k = 0; k < 3; k++)
+					{
+						before[k] = position(corner[k]);
+						after[k] = corner[k] == from ? position(to) : before[k];
+					}
+					auto normal_before = glm::cross(before[1] - before[0], before[2] - before[0]);
+					auto normal_after = glm::cross(after[1] - after[0], after[2] - after[0]);
+					flips = glm::dot(normal_before, normal_after) <= 0.0f;
+				}
+				if (flips)
+				{
+					continue;
+				}
+
+				collapse_to[from] = to;
+				quadrics[to].add(quadrics[from]);
+				worst_cost = std::max(worst_cost, candidate.cost);
+				removed += shared;
+				collapses++;
+
+				// everything around from changes shape, so none of it can collapse again this pass
+				for (auto a = adjacency_offsets[from]; a < adjacency_offsets[from + 1]; a++)
+				{
+					auto t = adjacency[a] * 3;
+					for (size_t k = 0; k < 3; k++)
+					{
+						locked[classes[result[t + k]]] = 1;
+					}
+				}
+			}
+
+			if (collapses == 0)
+			{
+				break;
+			}
+
+			// collapsed vertices point at the target class's own vertex, the rest keep their attributes
+			size_t write = 0;
+			for (size_t t = 0; t < triangle_count * 3; t += 3)
+			{
+				uint32_t triangle[3];
+				for (size_t k = 0; k < 3; k++)
+				{
+					auto v = result[t + k];
+					auto target = collapse_to[classes[v]];
+					triangle[k] = target == classes[v] ? v : target;
+				}
+
+				auto c0 = classes[triangle[0]], c1 = classes[triangle[1]], c2 = classes[triangle[2]];
+				if (c0 != c1 && c1 != c2 && c0 != c2)
+				{
+					result[write++] = triangle[0];
+					result[write++] = triangle[1];
+					result[write++] = triangle[2];
+				}
+			}
+			result.resize(write);
+		}
+
+		if (result_error)
+		{
+			*result_error = static_cast<float>(std::sqrt(worst_cost));
+		}
+		return result;
+	}
+
+	void generate_lods(mesh_data& mesh, uint32_t max_lods, float reduction)
+	{
+		LVK_TRACE_SCOPE("generate lods");
+
+		if (mesh.lods.empty())
+		{
+			mesh.lods.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()), 0.0f });
+		}
+		if (mesh.radius <= 0.0f)
+		{
+			compute_bounds(mesh);
+		}
+
+		// every level starts from the full mesh so its error is measured against the original
+		auto base = mesh.lods.front();
+		std::vector<uint32_t> source(
+			mesh.indices.begin() + base.first_index,
+			mesh.indices.begin() + base.first_index + base.index_count
+		);
+
+		// a dozen triangles is as coarse as it's worth going
+		constexpr size_t MIN_INDEX_COUNT = 36;
+
+		for (auto level = static_cast<uint32_t>(mesh.lods.size()); level < max_lods; level++)
+		{
+			auto target = static_cast<size_t>(static_cast<double>(base.index_count) * std::pow(reduction, level)) / 3 * 3;
+			if (target < MIN_INDEX_COUNT)
+			{
+				break;
+			}
+
+			float error = 0.0f;
+			auto lod = simplify_mesh(mesh.vertices, source, target, std::numeric_limits<float>::max(), &error);
+
+			// stalled, another level would look the same
+			const auto& previous = mesh.lods.back();
+			if (lod.size() * 20 >= static_cast<size_t>(previous.index_count) * 19)
+			{
+				break;
+			}
+
+			auto relative_error = mesh.radius > 0.0f ? error / mesh.radius : 0.0f;
+			lod_range range{
+				.first_index = static_cast<uint32_t>(mesh.indices.size()),
+				.index_count = static_cast<uint32_t>(lod.size()),
+				.error = std::max(relative_error, previous.error),
+			};
+			mesh.indices.insert(mesh.indices.end(), lod.begin(), lod.end());
+			mesh.lods.push_back(range);
+		}
+	}
+
+	auto projection_scale(float vertical_fov, float viewport_height) -> float
+	{
+		return viewport_height / (2.0f * std::tan(vertical_fov * 0.5f));
+	}
+
+	void lod_selector::resize(size_t object_count)
+	{
+		current.resize(object_count, 0);
+	}
+
+	auto lod_selector::select(uint32_t object, std::span<const lod_range> lods, float radius, float distance, float scale) -> uint32_t
+	{
+		if (lods.empty())
+		{
+			return 0;
+		}
+
+		// the camera inside the bounds always gets full detail
+		if (distance <= radius)
+		{
+			current[object] = 0;
+			return 0;
+		}
+
+		auto pixels = [&](uint32_t lod) { return lods[lod].error * radius / distance * scale; };
+		auto lod = std::min<uint32_t>(current[object], static_cast<uint32_t>(lods.size() - 1));
+
+		while (lod > 0 && pixels(lod) > settings.max_pixel_error)
+		{
+			lod--;
+		}
+		while (lod + 1 < lods.size() && pixels(lod + 1) <= settings.max_pixel_error * (1.0f - settings.hysteresis))
+		{
+			lod++;
+		}
+
+		current[object] = static_cast<uint8_t>(lod);
+		return lod;
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "mesh.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace lvk
+{
+	// quadric error edge collapse. keeps collapsing the cheapest edges until the index count drops
+	// to target_index_count or the next collapse would cost more than max_error (in model units).
+	// vertices only ever move onto other existing vertices, so the result indexes the same vertex
+	// buffer as the input. result_error gets the largest error that was introduced
+	auto simplify_mesh(
+		std::span<const vertex> vertices,
+		std::span<const uint32_t> indices,
+		size_t target_index_count,
+		float max_error,
+		float* result_error = nullptr
+	) -> std::vector<uint32_t>;
+
+	// appends up to max_lods - 1 coarser levels to the mesh, each with about reduction times the
+	// triangles of the one before. stops early once the mesh won't simplify any further
+	void generate_lods(mesh_data& mesh, uint32_t max_lods = 5, float reduction = 0.5f);
+
+	// converts world space sizes at distance 1 into pixels
+	auto projection_scale(float vertical_fov, float viewport_height) -> float;
+
+	struct lod_settings
+	{
+		// the coarsest lod whose error projects to at most this many pixels wins
+		float max_pixel_error = 1.0f;
+		// switching to a coarser lod needs its error this much below the limit, so objects
+		// sitting right on a threshold don't flicker between two lods
+		float hysteresis = 0.25f;
+	};
+
+	// picks a lod per object by projected screen size, remembering every object's last pick
+	class lod_selector
+	{
+		std::vector<uint8_t> current;
+
+	public:
+		lod_settings settings;
+
+		void resize(size_t object_count);
+
+		// radius is the object's world space bounding radius, distance how far its center is from the camera
+		auto select(uint32_t object, std::span<const lod_range> lods, float radius, float distance, float scale) -> uint32_t;
+	};
+}
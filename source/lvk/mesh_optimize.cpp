@@ -0,0 +1,633 @@
+#include "mesh_optimize.hpp"
+
+#include "trace.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace lvk
+{
+	namespace
+	{
+		// forsyth's scoring model, tuned for a 32 entry lru cache
+		constexpr uint32_t SCORE_CACHE_SIZE = 32;
+		constexpr float CACHE_DECAY_POWER = 1.5f;
+		constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+		constexpr float VALENCE_BOOST_SCALE = 2.0f;
+		constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+		// the fifo the overdraw pass measures its clusters against
+		constexpr uint32_t OVERDRAW_CACHE_SIZE = 16;
+
+		constexpr uint32_t NO_TRIANGLE = ~0u;
+
+		constexpr size_t FETCH_LINE_SIZE = 64;
+		constexpr uint32_t FETCH_CACHE_LINES = 256;
+
+		constexpr int OVERDRAW_RESOLUTION = 256;
+
+		auto vertex_score(int32_t cache_position, uint32_t remaining) -> float
+		{
+			if (remaining == 0)
+			{
+				return -1.0f;
+			}
+
+			float score = 0.0f;
+			if (cache_position >= 0)
+			{
+				// the last triangle's vertices get a fixed score, so it doesn't pay to reuse the same edge right away
+				if (cache_position < 3)
+				{
+					score = LAST_TRIANGLE_SCORE;
+				}
+				else
+				{
+					auto scale = 1.0f - static_cast<float>(cache_position - 3) / static_cast<float>(SCORE_CACHE_SIZE - 3);
+					score = std::pow(scale, CACHE_DECAY_POWER);
+				}
+			}
+
+			// vertices with few triangles left get finished off before they turn into stragglers
+			return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remaining), -VALENCE_BOOST_POWER);
+		}
+
+		// fifo cache keyed by the time every vertex went in, nothing to clear between runs
+		class fifo_cache
+		{
+			std::vector<uint32_t> inserted;
+			uint32_t time;
+			uint32_t size;
+
+		public:
+			fifo_cache(size_t vertex_count, uint32_t _size) : inserted(vertex_count, 0), time{ _size + 1 }, size{ _size }
+			{
+			}
+
+			// true on a miss
+			auto touch(uint32_t v) -> bool
+			{
+				if (time - inserted[v] <= size)
+				{
+					return false;
+				}
+				inserted[v] = time++;
+				return true;
+			}
+
+			// as if the cache was empty again
+			void flush()
+			{
+				time += size + 1;
+			}
+		};
+
+		auto triangle_normal(std::span<const vertex> vertices, const uint32_t* triangle) -> glm::vec3
+		{
+			auto a = vertices[triangle[0]].position;
+			return glm::cross(vertices[triangle[1]].position - a, vertices[triangle[2]].position - a);
+		}
+	}
+
+	auto optimize_vertex_cache(std::span<const uint32_t> indices, size_t vertex_count) -> std::vector<uint32_t>
+	{
+		LVK_TRACE_SCOPE("optimize vertex cache");
+
+		auto triangle_count = indices.size() / 3;
+		std::vector<uint32_t> result;
+		result.reserve(triangle_count * 3);
+		if (triangle_count == 0)
+		{
+			return result;
+		}
+
+		// live triangles around every vertex. emitted ones get swapped out of the end of the range
+		std::vector<uint32_t> remaining(vertex_count, 0);
+		for (size_t i = 0; i < triangle_count * 3; i++)
+		{
+			remaining[indices[i]]++;
+		}
+		std::vector<uint32_t> offsets(vertex_count + 1, 0);
+		std::inclusive_scan(remaining.begin(), remaining.end(), offsets.begin() + 1);
+		std::vector<uint32_t> adjacency(triangle_count * 3);
+		{
+			auto cursor = offsets;
+			for (size_t i = 0; i < triangle_count * 3; i++)
+			{
+				adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		std::vector<int32_t> cache_position(vertex_count, -1);
+		std::vector<float> vertex_scores(vertex_count);
+		for (size_t v = 0; v < vertex_count; v++)
+		{
+			vertex_scores[v] = vertex_score(-1, remaining[v]);
+		}
+
+		std::vector<float> triangle_scores(triangle_count);
+		std::vector<uint8_t> emitted(triangle_count, 0);
+		auto best = NO_TRIANGLE;
+		for (size_t t = 0; t < triangle_count; t++)
+		{
+			triangle_scores[t] = vertex_scores[indices[t * 3]] + vertex_scores[indices[t * 3 + 1]] + vertex_scores[indices[t * 3 + 2]];
+			if (best == NO_TRIANGLE || triangle_scores[t] > triangle_scores[best])
+			{
+				best = static_cast<uint32_t>(t);
+			}
+		}
+
+		std::array<uint32_t, SCORE_CACHE_SIZE + 3> cache{};
+		std::array<uint32_t, SCORE_CACHE_SIZE + 3> next{};
+		size_t cache_size = 0;
+		size_t scan_cursor = 0;
+
+		for (size_t emitted_count = 0; emitted_count < triangle_count; emitted_count++)
+		{
+			// nothing in the cache has triangles left, continue with the next unused one in input order
+			if (best == NO_TRIANGLE)
+			{
+				while (emitted[scan_cursor])
+				{
+					scan_cursor++;
+				}
+				best = static_cast<uint32_t>(scan_cursor);
+			}
+
+			auto t = best;
+			const auto* triangle = &indices[t * 3];
+			result.insert(result.end(), triangle, triangle + 3);
+			emitted[t] = 1;
+
+			for (size_t k = 0; k < 3; k++)
+			{
+				auto v = triangle[k];
+				auto begin = adjacency.begin() + offsets[v];
+				auto end = begin + remaining[v];
+				std::iter_swap(std::find(begin, end, t), end - 1);
+				remaining[v]--;
+			}
+
+			// the triangle's vertices move to the front, everything else shifts back
+			size_t next_size = 0;
+			for (size_t k = 0; k < 3; k++)
+			{
+				if (std::find(next.begin(), next.begin() + next_size, triangle[k]) == next.begin() + next_size)
+				{
+					next[next_size++] = triangle[k];
+				}
+			}
+			for (size_t i = 0; i < cache_size; i++)
+			{
+				auto v = cache[i];
+				if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+				{
+					next[next_size++] = v;
+				}
+			}
+
+			// rescore everything that moved, including what just fell out, and find the best triangle around them
+			best = NO_TRIANGLE;
+			float best_score = -std::numeric_limits<float>::infinity();
+			for (size_t i = 0; i < next_size; i++)
+			{
+				auto v = next[i];
+				cache_position[v] = i < SCORE_CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+
+				auto score = vertex_score(cache_position[v], remaining[v]);
+				auto delta = score - vertex_scores[v];
+				vertex_scores[v] = score;
+
+				for (auto j = offsets[v]; j < offsets[v] + remaining[v]; j++)
+				{
+					auto neighbour = adjacency[j];
+					triangle_scores[neighbour] += delta;
+					if (triangle_scores[neighbour] > best_score)
+					{
+						best_score = triangle_scores[neighbour];
+						best = neighbour;
+					}
+				}
+			}
+
+			cache_size = std::min<size_t>(next_size, SCORE_CACHE_SIZE);
+			std::copy_n(next.begin(), cache_size, cache.begin());
+		}
+		return result;
+	}
+
+	auto optimize_overdraw(std::span<const uint32_t> indices, std::span<const vertex> vertices, float threshold) -> std::vector<uint32_t>
+	{
+		LVK_TRACE_SCOPE("optimize overdraw");
+
+		auto triangle_count = indices.size() / 3;
+		if (triangle_count == 0)
+		{
+			return {};
+		}
+
+		// hard boundaries sit where all three vertices miss, the cache starts over there anyway
+		std::vector<uint32_t> hard_starts;
+		{
+			fifo_cache cache{ vertices.size(), OVERDRAW_CACHE_SIZE };
+			for (size_t t = 0; t < triangle_count; t++)
+			{
+				uint32_t misses = 0;
+				for (size_t k = 0; k < 3; k++)
+				{
+					misses += cache.touch(indices[t * 3 + k]);
+				}
+				if (t == 0 || misses == 3)
+				{
+					hard_starts.push_back(static_cast<uint32_t>(t));
+				}
+			}
+			hard_starts.push_back(static_cast<uint32_t>(triangle_count));
+		}
+
+		// moving a cluster means it starts with a cold cache, so a hard cluster only gets cut once
+		// the misses since the last cut, counted from a cold cache, are within threshold of its own rate
+		std::vector<uint32_t> cluster_starts;
+		fifo_cache cache{ vertices.size(), OVERDRAW_CACHE_SIZE };
+		for (size_t c = 0; c + 1 < hard_starts.size(); c++)
+		{
+			auto begin = hard_starts[c], end = hard_starts[c + 1];
+
+			uint32_t misses = 0;
+			cache.flush();
+			for (auto t = begin; t < end; t++)
+			{
+				for (size_t k = 0; k < 3; k++)
+				{
+					misses += cache.touch(indices[t * 3 + k]);
+				}
+			}
+			auto budget = threshold * static_cast<float>(misses) / static_cast<float>(end - begin);
+
+			cluster_starts.push_back(begin);
+			cache.flush();
+			misses = 0;
+			uint32_t count = 0;
+			for (auto t = begin; t < end; t++)
+			{
+				for (size_t k = 0; k < 3; k++)
+				{
+					misses += cache.touch(indices[t * 3 + k]);
+				}
+				count++;
+				if (t + 1 < end && static_cast<float>(misses) <= budget * static_cast<float>(count))
+				{
+					cluster_starts.push_back(t + 1);
+					cache.flush();
+					misses = 0;
+					count = 0;
+				}
+			}
+		}
+		cluster_starts.push_back(static_cast<uint32_t>(triangle_count));
+		auto cluster_count = cluster_starts.size() - 1;
+
+		// clusters pointing away from the middle of the mesh are likely in front of the rest, so they go first
+		std::vector<glm::vec3> centroids(cluster_count, glm::vec3{ 0.0f });
+		std::vector<glm::vec3> normals(cluster_count, glm::vec3{ 0.0f });
+		glm::vec3 mesh_centroid{ 0.0f };
+		float mesh_area = 0.0f;
+		for (size_t c = 0; c < cluster_count; c++)
+		{
+			float area = 0.0f;
+			for (auto t = cluster_starts[c]; t < cluster_starts[c + 1]; t++)
+			{
+				const auto* triangle = &indices[t * 3];
+				auto normal = triangle_normal(vertices, triangle);
+				auto weight = glm::length(normal);
+				auto center = (vertices[triangle[0]].position + vertices[triangle[1]].position + vertices[triangle[2]].position) / 3.0f;
+
+				centroids[c] += center * weight;
+				normals[c] += normal;
+				area += weight;
+			}
+			mesh_centroid += centroids[c];
+			mesh_area += area;
+			centroids[c] = area > 0.0f ? centroids[c] / area : centroids[c];
+		}
+		mesh_centroid = mesh_area > 0.0f ? mesh_centroid / mesh_area : mesh_centroid;
+
+		std::vector<float> keys(cluster_count);
+		for (size_t c = 0; c < cluster_count; c++)
+		{
+			auto length = glm::length(normals[c]);
+			keys[c] = length > 0.0f ? glm::dot(centroids[c] - mesh_centroid, normals[c] / length) : 0.0f;
+		}
+
+		std::vector<uint32_t> order(cluster_count);
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] > keys[b]; });
+
+		std::vector<uint32_t> result;
+		result.reserve(triangle_count * 3);
+		for (auto c : order)
+		{
+			result.insert(result.end(), indices.begin() + cluster_starts[c] * 3, indices.begin() + cluster_starts[c + 1] * 3);
+		}
+		return result;
+	}
+
+	auto optimize_vertex_fetch(std::vector<vertex>& vertices, std::span<uint32_t> indices) -> size_t
+	{
+		LVK_TRACE_SCOPE("optimize vertex fetch");
+
+		std::vector<uint32_t> remap(vertices.size(), ~0u);
+		std::vector<vertex> ordered;
+		ordered.reserve(vertices.size());
+		for (auto& index : indices)
+		{
+			if (remap[index] == ~0u)
+			{
+				remap[index] = static_cast<uint32_t>(ordered.size());
+				ordered.push_back(vertices[index]);
+			}
+			index = remap[index];
+		}
+		vertices = std::move(ordered);
+		return vertices.size();
+	}
+
+	void optimize_mesh(mesh_data& mesh, float overdraw_threshold)
+	{
+		LVK_TRACE_SCOPE("optimize mesh");
+
+		if (mesh.lods.empty())
+		{
+			mesh.lods.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()), 0.0f });
+		}
+
+		for (const auto& lod : mesh.lods)
+		{
+			std::span<uint32_t> range{ mesh.indices.data() + lod.first_index, lod.index_count };
+			auto ordered = optimize_vertex_cache(range, mesh.vertices.size());
+			ordered = optimize_overdraw(ordered, mesh.vertices, overdraw_threshold);
+			std::copy(ordered.begin(), ordered.end(), range.begin());
+		}
+
+		optimize_vertex_fetch(mesh.vertices, mesh.indices);
+	}
+
+	auto analyze_vertex_cache(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size) -> vertex_cache_stats
+	{
+		auto triangle_count = indices.size() / 3;
+		if (triangle_count == 0)
+		{
+			return {};
+		}
+
+		fifo_cache cache{ vertex_count, cache_size };
+		std::vector<uint8_t> used(vertex_count, 0);
+		size_t misses = 0;
+		size_t used_count = 0;
+		for (size_t i = 0; i < triangle_count * 3; i++)
+		{
+			auto v = indices[i];
+			misses += cache.touch(v);
+			used_count += used[v] == 0;
+			used[v] = 1;
+		}
+
+		return {
+			.acmr = static_cast<float>(misses) / static_cast<float>(triangle_count),
+			.atvr = static_cast<float>(misses) / static_cast<float>(used_count),
+		};
+	}
+
+	auto analyze_vertex_fetch(std::span<const uint32_t> indices, size_t vertex_count, size_t vertex_size) -> float
+	{
+		// one timestamp per line of the vertex buffer, same trick as the fifo above
+		std::vector<uint32_t> line_times((vertex_count * vertex_size + FETCH_LINE_SIZE - 1) / FETCH_LINE_SIZE, 0);
+		std::vector<uint8_t> used(vertex_count, 0);
+		uint32_t time = FETCH_CACHE_LINES + 1;
+		size_t fetched = 0;
+		size_t used_count = 0;
+		for (auto v : indices)
+		{
+			used_count += used[v] == 0;
+			used[v] = 1;
+
+			auto first_line = v * vertex_size / FETCH_LINE_SIZE;
+			auto last_line = ((v + 1) * vertex_size - 1) / FETCH_LINE_SIZE;
+			for (auto line = first_line; line <= last_line; line++)
+			{
+				if (time - line_times[line] > FETCH_CACHE_LINES)
+				{
+					line_times[line] = time++;
+					fetched += FETCH_LINE_SIZE;
+				}
+			}
+		}
+		return used_count == 0 ? 0.0f : static_cast<float>(fetched) / static_cast<float>(used_count * vertex_size);
+	}
+
+	auto analyze_overdraw(std::span<const uint32_t> indices, std::span<const vertex> vertices) -> float
+	{
+		LVK_TRACE_SCOPE("analyze overdraw");
+
+		if (indices.size() < 3 || vertices.empty())
+		{
+			return 0.0f;
+		}
+
+		auto min = vertices.front().position;
+		auto max = min;
+		for (const auto& v : vertices)
+		{
+			min = glm::min(min, v.position);
+			max = glm::max(max, v.position);
+		}
+		auto extent = std::max({ max.x - min.x, max.y - min.y, max.z - min.z, 1e-20f });
+		auto scale = static_cast<float>(OVERDRAW_RESOLUTION) / extent;
+
+		std::vector<float> depth(OVERDRAW_RESOLUTION * OVERDRAW_RESOLUTION);
+		size_t shaded = 0;
+		size_t covered = 0;
+
+		// looking down every axis from both sides, orthographic
+		for (int axis = 0; axis < 3; axis++)
+		{
+			for (float direction : { 1.0f, -1.0f })
+			{
+				std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::infinity());
+
+				auto project = [&](uint32_t v) {
+					auto p = (vertices[v].position - min) * scale;
+					return glm::vec3{ p[(axis + 1) % 3], p[(axis + 2) % 3], p[axis] * direction };
+				};
+
+				for (size_t i = 0; i + 2 < indices.size(); i += 3)
+				{
+					auto a = project(indices[i]), b = project(indices[i + 1]), c = project(indices[i + 2]);
+					auto edge = [](glm::vec3 p, glm::vec3 q, float x, float y) {
+						return (q.x - p.x) * (y - p.y) - (q.y - p.y) * (x - p.x);
+					};
+
+					auto area = edge(a, b, c.x, c.y);
+					if (area == 0.0f)
+					{
+						continue;
+					}
+					// both windings get drawn, nothing is culled
+					auto sign = area > 0.0f ? 1.0f : -1.0f;
+
+					auto x0 = std::max(static_cast<int>(std::floor(std::min({ a.x, b.x, c.x }))), 0);
+					auto x1 = std::min(static_cast<int>(std::ceil(std::max({ a.x, b.x, c.x }))), OVERDRAW_RESOLUTION - 1);
+					auto y0 = std::max(static_cast<int>(std::floor(std::min({ a.y, b.y, c.y }))), 0);
+					auto y1 = std::min(static_cast<int>(std::ceil(std::max({ a.y, b.y, c.y }))), OVERDRAW_RESOLUTION - 1);
+
+					for (int y = y0; y <= y1; y++)
+					{
+						for (int x = x0; x <= x1; x++)
+						{
+							auto px = static_cast<float>(x) + 0.5f, py = static_cast<float>(y) + 0.5f;
+							auto wa = edge(b, c, px, py) * sign;
+							auto wb = edge(c, a, px, py) * sign;
+							auto wc = edge(a, b, px, py) * sign;
+							if (wa < 0.0f || wb < 0.0f || wc < 0.0f)
+							{
+								continue;
+							}
+
+							auto z = (wa * a.z + wb * b.z + wc * c.z) / (area * sign);
+							auto& stored = depth[y * OVERDRAW_RESOLUTION + x];
+							if (z < stored)
+							{
+								stored = z;
+								shaded++;
+							}
+						}
+					}
+				}
+
+				covered += std::count_if(depth.begin(), depth.end(), [](float z) { return std::isfinite(z); });
+			}
+		}
+		return covered == 0 ? 0.0f : static_cast<float>(shaded) / static_cast<float>(covered);
+	}
+
+	auto build_meshlets(
+		std::span<const vertex> vertices,
+		std::span<const uint32_t> indices,
+		uint32_t max_vertices,
+		uint32_t max_triangles) -> meshlet_data
+	{
+		LVK_TRACE_SCOPE("build meshlets");
+
+		// local indices are bytes
+		max_vertices = std::clamp(max_vertices, 3u, 256u);
+		max_triangles = std::max(max_triangles, 1u);
+
+		meshlet_data result;
+		std::vector<int32_t> local(vertices.size(), -1);
+		meshlet current;
+
+		auto finish = [&] {
+			if (current.triangle_count == 0)
+			{
+				return;
+			}
+
+			std::span<const uint32_t> used{ result.vertices.data() + current.vertex_offset, current.vertex_count };
+			auto min = vertices[used.front()].position;
+			auto max = min;
+			for (auto v : used)
+			{
+				min = glm::min(min, vertices[v].position);
+				max = glm::max(max, vertices[v].position);
+				local[v] = -1;
+			}
+			current.center = (min + max) * 0.5f;
+			current.radius = 0.0f;
+			for (auto v : used)
+			{
+				current.radius = std::max(current.radius, glm::length(vertices[v].position - current.center));
+			}
+
+			// the cone has to contain every triangle's normal. its half angle is acos(min_dot), the test
+			// in is_backfacing wants the cosine of the complementary angle
+			std::vector<glm::vec3> normals;
+			glm::vec3 axis{ 0.0f };
+			for (uint32_t t = 0; t < current.triangle_count; t++)
+			{
+				const auto* triangle = &result.triangles[(current.triangle_offset + t) * 3];
+				std::array<uint32_t, 3> corners{ used[triangle[0]], used[triangle[1]], used[triangle[2]] };
+				auto normal = triangle_normal(vertices, corners.data());
+				auto length = glm::length(normal);
+				if (length > 0.0f)
+				{
+					normals.push_back(normal / length);
+					axis += normal / length;
+				}
+			}
+
+			current.cone_cutoff = 1.0f;
+			current.cone_axis = glm::vec3{ 0.0f, 0.0f, 1.0f };
+			if (auto length = glm::length(axis); length > 0.0f)
+			{
+				current.cone_axis = axis / length;
+				auto min_dot = 1.0f;
+				for (auto normal : normals)
+				{
+					min_dot = std::min(min_dot, glm::dot(normal, current.cone_axis));
+				}
+				// a cone wider than a hemisphere can't ever be culled
+				if (min_dot > 0.0f)
+				{
+					current.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+				}
+			}
+
+			result.meshlets.push_back(current);
+			current = meshlet{
+				.vertex_offset = static_cast<uint32_t>(result.vertices.size()),
+				.triangle_offset = static_cast<uint32_t>(result.triangles.size() / 3),
+			};
+		};
+
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			uint32_t new_vertices = 0;
+			for (size_t k = 0; k < 3; k++)
+			{
+				auto v = indices[i + k];
+				auto repeated = (k > 0 && v == indices[i]) || (k > 1 && v == indices[i + 1]);
+				new_vertices += local[v] < 0 && !repeated;
+			}
+			if (current.vertex_count + new_vertices > max_vertices || current.triangle_count + 1 > max_triangles)
+			{
+				finish();
+			}
+
+			for (size_t k = 0; k < 3; k++)
+			{
+				auto v = indices[i + k];
+				if (local[v] < 0)
+				{
+					local[v] = static_cast<int32_t>(current.vertex_count++);
+					result.vertices.push_back(v);
+				}
+				result.triangles.push_back(static_cast<uint8_t>(local[v]));
+			}
+			current.triangle_count++;
+		}
+		finish();
+		return result;
+	}
+
+	auto is_backfacing(const meshlet& m, glm::vec3 camera) -> bool
+	{
+		auto offset = m.center - camera;
+		return glm::dot(offset, m.cone_axis) >= m.cone_cutoff * glm::length(offset) + m.radius;
+	}
+}
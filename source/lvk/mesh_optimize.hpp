@@ -0,0 +1,89 @@
+#pragma once
+
+#include "mesh.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace lvk
+{
+	// reorders triangles so vertices get reused while they're still in the post transform cache
+	// (tom forsyth's linear speed vertex cache optimisation). works for any cache size
+	auto optimize_vertex_cache(std::span<const uint32_t> indices, size_t vertex_count) -> std::vector<uint32_t>;
+
+	// reorders clusters of an already cache optimised index buffer so triangles facing outwards get
+	// drawn first, which lets the depth test reject more of what's behind them. clusters are cut where
+	// that costs at most threshold times the vertex cache misses (sander et al., "fast triangle
+	// reordering for vertex locality and reduced overdraw")
+	auto optimize_overdraw(std::span<const uint32_t> indices, std::span<const vertex> vertices, float threshold = 1.05f) -> std::vector<uint32_t>;
+
+	// renumbers vertices in the order the indices first touch them and drops unused ones, so the
+	// vertex buffer gets read front to back. returns the new vertex count
+	auto optimize_vertex_fetch(std::vector<vertex>& vertices, std::span<uint32_t> indices) -> size_t;
+
+	// all of the above: every lod gets its own cache and overdraw pass, then the shared vertex buffer
+	// is laid out in the order lod 0 uses it
+	void optimize_mesh(mesh_data& mesh, float overdraw_threshold = 1.05f);
+
+	struct vertex_cache_stats
+	{
+		// transformed vertices per triangle, 0.5 is the best a regular grid can do and 3 the worst
+		float acmr = 0.0f;
+		// transformed vertices per vertex, 1 is perfect
+		float atvr = 0.0f;
+	};
+
+	// simulates a fifo post transform cache, which is roughly what current gpus have
+	auto analyze_vertex_cache(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size = 16) -> vertex_cache_stats;
+
+	// bytes fetched through a small cache of 64 byte lines divided by the size of the used vertices, 1 is perfect
+	auto analyze_vertex_fetch(std::span<const uint32_t> indices, size_t vertex_count, size_t vertex_size) -> float;
+
+	// rasterises the mesh from the six axis directions and returns shaded pixels per covered pixel, 1 is perfect
+	auto analyze_overdraw(std::span<const uint32_t> indices, std::span<const vertex> vertices) -> float;
+
+	// limits that fit mesh shader workgroups on every vendor
+	constexpr uint32_t MAX_MESHLET_VERTICES = 64;
+	constexpr uint32_t MAX_MESHLET_TRIANGLES = 124;
+
+	struct meshlet
+	{
+		// ranges in meshlet_data's vertices and triangles
+		uint32_t vertex_offset = 0;
+		uint32_t triangle_offset = 0;
+		uint32_t vertex_count = 0;
+		uint32_t triangle_count = 0;
+
+		// bounding sphere in model space
+		glm::vec3 center{ 0.0f };
+		float radius = 0.0f;
+
+		// every triangle's normal is within the cone around axis, see is_backfacing
+		glm::vec3 cone_axis{ 0.0f };
+		float cone_cutoff = 1.0f;
+	};
+
+	struct meshlet_data
+	{
+		std::vector<meshlet> meshlets;
+		// indices into the mesh's vertex buffer
+		std::vector<uint32_t> vertices;
+		// three meshlet local vertex indices per triangle
+		std::vector<uint8_t> triangles;
+	};
+
+	// splits an index buffer into meshlets in order, so it's best run on cache optimised indices
+	auto build_meshlets(
+		std::span<const vertex> vertices,
+		std::span<const uint32_t> indices,
+		uint32_t max_vertices = MAX_MESHLET_VERTICES,
+		uint32_t max_triangles = MAX_MESHLET_TRIANGLES
+	) -> meshlet_data;
+
+	// true when every triangle of the meshlet faces away from the camera, camera in model space
+	auto is_backfacing(const meshlet& m, glm::vec3 camera) -> bool;
+}
@@ -0,0 +1,147 @@
+#include "mesh_wrp.hpp"
+#include "trace.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace lvk
+{
+	namespace
+	{
+		auto to_vk_format(attribute_format format) -> VkFormat
+		{
+			switch (format)
+			{
+			case attribute_format::float32x2: return VK_FORMAT_R32G32_SFLOAT;
+			case attribute_format::float32x3: return VK_FORMAT_R32G32B32_SFLOAT;
+			case attribute_format::float16x2: return VK_FORMAT_R16G16_SFLOAT;
+			case attribute_format::float16x4: return VK_FORMAT_R16G16B16A16_SFLOAT;
+			case attribute_format::snorm8x2: return VK_FORMAT_R8G8_SNORM;
+			case attribute_format::snorm16x2: return VK_FORMAT_R16G16_SNORM;
+			case attribute_format::snorm16x4: return VK_FORMAT_R16G16B16A16_SNORM;
+			case attribute_format::unorm16x2: return VK_FORMAT_R16G16_UNORM;
+			}
+			throw std::runtime_error("unknown vertex attribute format");
+		}
+	}
+
+	mesh_wrp::mesh_wrp(device_wrp& _device, const mesh_view& mesh, vertex_layout _layout)
+		: device{ _device }, lods{ mesh.lods.begin(), mesh.lods.end() }, center{ mesh.center }, radius{ mesh.radius },
+		  layout{ fit_vertex_layout(mesh.vertices, _layout) },
+		  dequantization{ make_position_dequantization(mesh.vertices, layout.position) }
+	{
+		LVK_TRACE_SCOPE("upload mesh");
+
+		if (mesh.vertices.empty() || mesh.indices.empty())
+		{
+			throw std::runtime_error("can't upload an empty mesh");
+		}
+		if (lods.empty())
+		{
+			lods.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()), 0.0f });
+		}
+
+		vertex_bytes = VkDeviceSize{ layout.stride() } * mesh.vertices.size();
+		index_bytes = mesh.indices.size_bytes();
+
+		vertex_buffer = upload(vertex_bytes, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, [&](std::byte* staging) {
+			if (layout == vertex_layout::full())
+			{
+				std::memcpy(staging, mesh.vertices.data(), mesh.vertices.size_bytes());
+			}
+			else
+			{
+				encode_vertices(mesh.vertices, layout, dequantization, { staging, static_cast<size_t>(vertex_bytes) });
+			}
+		});
+		index_buffer = upload(index_bytes, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, [&](std::byte* staging) {
+			std::memcpy(staging, mesh.indices.data(), mesh.indices.size_bytes());
+		});
+	}
+
+	mesh_wrp::~mesh_wrp()
+	{
+		// streamed out meshes can still be drawn by frames in flight, the pool defers the actual destruction
+		device.get_resources().destroy(index_buffer);
+		device.get_resources().destroy(vertex_buffer);
+	}
+
+	auto mesh_wrp::binding_descriptions() const -> std::vector<VkVertexInputBindingDescription>
+	{
+		return {
+			VkVertexInputBindingDescription{
+				.binding = 0,
+				.stride = layout.stride(),
+				.inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+			},
+		};
+	}
+
+	auto mesh_wrp::attribute_descriptions() const -> std::vector<VkVertexInputAttributeDescription>
+	{
+		std::vector<VkVertexInputAttributeDescription> descriptions;
+		for (const auto& attribute : layout.attributes())
+		{
+			descriptions.push_back({
+				.location = attribute.location,
+				.binding = 0,
+				.format = to_vk_format(attribute.format),
+				.offset = attribute.offset,
+			});
+		}
+		return descriptions;
+	}
+
+	auto mesh_wrp::get_dequantization() const -> glm::mat4
+	{
+		return glm::scale(glm::translate(glm::mat4{ 1.0f }, dequantization.offset), dequantization.scale);
+	}
+
+	void mesh_wrp::bind(VkCommandBuffer command_buffer)
+	{
+		auto& resources = device.get_resources();
+		VkDeviceSize offset = 0;
+		vkCmdBindVertexBuffers(command_buffer, 0, 1, &resources.get(vertex_buffer)->buffer, &offset);
+		vkCmdBindIndexBuffer(command_buffer, resources.get(index_buffer)->buffer, 0, VK_INDEX_TYPE_UINT32);
+	}
+
+	void mesh_wrp::draw(VkCommandBuffer command_buffer, uint32_t lod, uint32_t instance_count, uint32_t first_instance)
+	{
+		const auto& range = lods[lod < lods.size() ? lod : lods.size() - 1];
+		vkCmdDrawIndexed(command_buffer, range.index_count, instance_count, range.first_index, 0, first_instance);
+	}
+
+	auto mesh_wrp::upload(VkDeviceSize size, VkBufferUsageFlags usage, const std::function<void(std::byte*)>& fill) -> buffer_handle
+	{
+		// the staging buffer is gone again before this returns, so it stays a raw buffer
+		VkBuffer staging_buffer;
+		VkDeviceMemory staging_memory;
+		device.createBuffer(
+			size,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			staging_buffer,
+			staging_memory,
+			memory_category::staging
+		);
+
+		void* mapped;
+		vkMapMemory(device.get_device(), staging_memory, 0, size, 0, &mapped);
+		fill(static_cast<std::byte*>(mapped));
+		vkUnmapMemory(device.get_device(), staging_memory);
+
+		auto buffer = device.get_resources().create_buffer({
+			.size = size,
+			.usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			.memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		});
+		device.copyBuffer(staging_buffer, device.get_resources().get(buffer)->buffer, size);
+
+		vkDestroyBuffer(device.get_device(), staging_buffer, nullptr);
+		device.free_memory(staging_memory);
+		return buffer;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "device_wrp.hpp"
+#include "mesh.hpp"
+#include "vertex_format.hpp"
+
+#include <glm/mat4x4.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace lvk
+{
+	// a mesh uploaded to device local memory. every lod lives in the same index buffer
+	// and indexes the same vertex buffer, so switching lods is just a different draw range.
+	// the view can point straight into a mapped mesh cache, it gets copied into the staging buffer as is
+	// or encoded into the requested vertex layout on the way there
+	class mesh_wrp
+	{
+	public:
+		mesh_wrp(device_wrp& _device, const mesh_view& mesh, vertex_layout _layout = vertex_layout::full());
+		~mesh_wrp();
+
+		mesh_wrp(const mesh_wrp&) = delete;
+		mesh_wrp& operator=(const mesh_wrp&) = delete;
+
+		// vertex input matching the layout the vertices were encoded with, for pipeline_config_info
+		auto binding_descriptions() const -> std::vector<VkVertexInputBindingDescription>;
+		auto attribute_descriptions() const -> std::vector<VkVertexInputAttributeDescription>;
+
+		void bind(VkCommandBuffer command_buffer);
+		void draw(VkCommandBuffer command_buffer, uint32_t lod, uint32_t instance_count = 1, uint32_t first_instance = 0);
+
+		auto get_lods() const -> std::span<const lod_range>
+		{
+			return lods;
+		}
+		auto get_center() const -> glm::vec3
+		{
+			return center;
+		}
+		auto get_radius() const -> float
+		{
+			return radius;
+		}
+		// can differ from the requested one when the mesh doesn't fit it, see fit_vertex_layout
+		auto get_layout() const -> const vertex_layout&
+		{
+			return layout;
+		}
+		// model matrices have to be multiplied by this for quantised positions
+		auto get_dequantization() const -> glm::mat4;
+		auto get_vertex_bytes() const -> VkDeviceSize
+		{
+			return vertex_bytes;
+		}
+		auto get_index_bytes() const -> VkDeviceSize
+		{
+			return index_bytes;
+		}
+
+	private:
+		// fill writes size bytes into the mapped staging buffer, which then gets copied into a new device local buffer
+		auto upload(VkDeviceSize size, VkBufferUsageFlags usage, const std::function<void(std::byte*)>& fill) -> buffer_handle;
+
+		device_wrp& device;
+		buffer_handle vertex_buffer;
+		buffer_handle index_buffer;
+
+		std::vector<lod_range> lods;
+		glm::vec3 center;
+		float radius;
+
+		vertex_layout layout;
+		position_dequantization dequantization;
+		VkDeviceSize vertex_bytes = 0;
+		VkDeviceSize index_bytes = 0;
+	};
+}
@@ -0,0 +1,547 @@
+#include "occlusion_culler.hpp"
+#include "shader_library.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace lvk
+{
+	namespace
+	{
+		constexpr uint32_t DOWNSAMPLE_GROUP_SIZE = 8;
+		constexpr uint32_t CULL_GROUP_SIZE = 64;
+		// x visible, y occluded, z late, w unused
+		constexpr uint32_t STATS_STRIDE = 4;
+
+		auto group_count(uint32_t size, uint32_t group_size) -> uint32_t
+		{
+			return (size + group_size - 1) / group_size;
+		}
+	}
+
+	occlusion_culler::occlusion_culler(device_wrp& _device, swap_chain_wrp& _swap_chain, const sphere_bounds& bounds)
+		: device{ _device }, swap_chain{ _swap_chain }, object_count{ static_cast<uint32_t>(bounds.size()) }
+	{
+		if (!is_supported(device))
+		{
+			throw std::runtime_error("occlusion culling needs VK_EXT_conditional_rendering and compute on the graphics queue");
+		}
+		if (object_count == 0)
+		{
+			throw std::runtime_error("occlusion culling needs at least one object");
+		}
+
+		begin_conditional_rendering = (PFN_vkCmdBeginConditionalRenderingEXT)vkGetDeviceProcAddr(
+			device.get_device(), "vkCmdBeginConditionalRenderingEXT");
+		end_conditional_rendering = (PFN_vkCmdEndConditionalRenderingEXT)vkGetDeviceProcAddr(
+			device.get_device(), "vkCmdEndConditionalRenderingEXT");
+
+		create_buffers(bounds);
+		create_pyramid();
+		create_descriptors();
+		create_pipelines();
+	}
+
+	occlusion_culler::~occlusion_culler()
+	{
+		auto& resources = device.get_resources();
+		resources.destroy(bounds_buffer);
+		resources.destroy(visibility_buffer);
+		resources.destroy(late_buffer);
+		resources.destroy(stats_buffer);
+		resources.destroy(pyramid);
+
+		// descriptor sets go with their pool
+		device.get_deletion_queue().defer(
+			[device = device.get_device(),
+			 level_views = std::move(level_views),
+			 sampler = sampler,
+			 set_layouts = std::array{ downsample_set_layout, cull_set_layout },
+			 descriptor_pool = descriptor_pool,
+			 layouts = std::array{ downsample_layout, cull_layout },
+			 pipelines = std::array{ downsample_pipeline, cull_pipeline }] {
+				for (auto pipeline : pipelines)
+				{
+					vkDestroyPipeline(device, pipeline, nullptr);
+				}
+				for (auto layout : layouts)
+				{
+					vkDestroyPipelineLayout(device, layout, nullptr);
+				}
+				vkDestroyDescriptorPool(device, descriptor_pool, nullptr);
+				for (auto set_layout : set_layouts)
+				{
+					vkDestroyDescriptorSetLayout(device, set_layout, nullptr);
+				}
+				vkDestroySampler(device, sampler, nullptr);
+				for (auto view : level_views)
+				{
+					vkDestroyImageView(device, view, nullptr);
+				}
+			});
+	}
+
+	bool occlusion_culler::is_supported(device_wrp& device)
+	{
+		return device.get_optional_features().conditional_rendering && device.find_physical_queue_families().graphics_has_compute;
+	}
+
+	void occlusion_culler::begin_early(VkCommandBuffer command_buffer, uint32_t object)
+	{
+		begin(command_buffer, visibility_buffer, object);
+	}
+
+	void occlusion_culler::begin_late(VkCommandBuffer command_buffer, uint32_t object)
+	{
+		begin(command_buffer, late_buffer, object);
+	}
+
+	void occlusion_culler::end(VkCommandBuffer command_buffer)
+	{
+		end_conditional_rendering(command_buffer);
+	}
+
+	void occlusion_culler::begin(VkCommandBuffer command_buffer, buffer_handle predicates, uint32_t object)
+	{
+		auto begin_info = VkConditionalRenderingBeginInfoEXT{
+			.sType = VK_STRUCTURE_TYPE_CONDITIONAL_RENDERING_BEGIN_INFO_EXT,
+			.buffer = device.get_resources().get(predicates)->buffer,
+			.offset = static_cast<VkDeviceSize>(object) * sizeof(uint32_t),
+		};
+		begin_conditional_rendering(command_buffer, &begin_info);
+	}
+
+	void occlusion_culler::record_cull(VkCommandBuffer command_buffer, uint32_t image_index, const glm::mat4& view_projection)
+	{
+		LVK_TRACE_SCOPE("record occlusion cull");
+
+		auto& barriers = device.get_barriers();
+		auto& resources = device.get_resources();
+		auto pyramid_image = resources.get(pyramid)->image;
+		auto pyramid_range = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, pyramid_levels, 0, 1 };
+
+		// level 0 is built from the early pass' depth. the levels are tracked as one image, so every
+		// level waits for the one before it, and the first one for the previous frame's test
+		barriers.use(
+			resources.get(swap_chain.get_depth_image(static_cast<int>(image_index)))->image,
+			swap_chain.get_depth_range(),
+			{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, VK_ACCESS_2_SHADER_READ_BIT_KHR, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL });
+
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, downsample_pipeline);
+		auto source_width = swap_chain.width(), source_height = swap_chain.height();
+		for (uint32_t level = 0; level < pyramid_levels; level++)
+		{
+			auto constants = downsample_constants{
+				.source_width = source_width,
+				.source_height = source_height,
+				.width = std::max(pyramid_width >> level, 1u),
+				.height = std::max(pyramid_height >> level, 1u),
+			};
+			auto set = level == 0 ? downsample_sets[image_index] : downsample_sets[swap_chain.image_count() + level - 1];
+
+			barriers.use(
+				pyramid_image,
+				pyramid_range,
+				{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, VK_ACCESS_2_SHADER_READ_BIT_KHR | VK_ACCESS_2_SHADER_WRITE_BIT_KHR, VK_IMAGE_LAYOUT_GENERAL });
+			barriers.flush(command_buffer);
+
+			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, downsample_layout, 0, 1, &set, 0, nullptr);
+			vkCmdPushConstants(command_buffer, downsample_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+			vkCmdDispatch(
+				command_buffer,
+				group_count(constants.width, DOWNSAMPLE_GROUP_SIZE),
+				group_count(constants.height, DOWNSAMPLE_GROUP_SIZE),
+				1);
+
+			source_width = constants.width;
+			source_height = constants.height;
+		}
+
+		auto constants = cull_constants{
+			.view_projection = view_projection,
+			.pyramid_width = pyramid_width,
+			.pyramid_height = pyramid_height,
+			.pyramid_levels = pyramid_levels,
+			.object_count = object_count,
+			.stats_slot = static_cast<uint32_t>(swap_chain.get_current_frame()),
+		};
+
+		auto read = resource_access{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, VK_ACCESS_2_SHADER_READ_BIT_KHR };
+		auto write = resource_access{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, VK_ACCESS_2_SHADER_WRITE_BIT_KHR };
+		auto read_write = resource_access{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, read.access | write.access };
+		barriers.use(pyramid_image, pyramid_range, { read.stages, read.access, VK_IMAGE_LAYOUT_GENERAL });
+		barriers.use(resources.get(bounds_buffer)->buffer, read);
+		barriers.use(resources.get(visibility_buffer)->buffer, read_write);
+		barriers.use(resources.get(late_buffer)->buffer, write);
+		barriers.use(resources.get(stats_buffer)->buffer, read_write);
+		barriers.flush(command_buffer);
+
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, cull_pipeline);
+		vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, cull_layout, 0, 1, &cull_set, 0, nullptr);
+		vkCmdPushConstants(command_buffer, cull_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+		vkCmdDispatch(command_buffer, group_count(object_count, CULL_GROUP_SIZE), 1, 1);
+
+		// the late pass reads late right away, the next frame's early pass reads visibility. these
+		// get recorded along with the late pass' own barriers
+		auto predicate_read = resource_access{ VK_PIPELINE_STAGE_2_CONDITIONAL_RENDERING_BIT_EXT, VK_ACCESS_2_CONDITIONAL_RENDERING_READ_BIT_EXT };
+		barriers.use(resources.get(late_buffer)->buffer, predicate_read);
+		barriers.use(resources.get(visibility_buffer)->buffer, predicate_read);
+		barriers.use(resources.get(stats_buffer)->buffer, { VK_PIPELINE_STAGE_2_HOST_BIT_KHR, VK_ACCESS_2_HOST_READ_BIT_KHR });
+	}
+
+	auto occlusion_culler::collect_stats() -> occlusion_stats
+	{
+		// the slot's fence was waited on by acquiring, and the counters have to start at 0 again
+		auto* slot = mapped_stats + swap_chain.get_current_frame() * STATS_STRIDE;
+		auto stats = occlusion_stats{ .visible = slot[0], .occluded = slot[1], .late = slot[2] };
+		std::fill_n(slot, STATS_STRIDE, 0u);
+		return stats;
+	}
+
+	void occlusion_culler::create_buffers(const sphere_bounds& bounds)
+	{
+		auto& resources = device.get_resources();
+		auto predicate_bytes = static_cast<VkDeviceSize>(object_count) * sizeof(uint32_t);
+		VkBufferUsageFlags predicate_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_CONDITIONAL_RENDERING_BIT_EXT
+			| VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		visibility_buffer = resources.create_buffer({ .size = predicate_bytes, .usage = predicate_usage });
+		late_buffer = resources.create_buffer({ .size = predicate_bytes, .usage = predicate_usage });
+
+		auto stats_bytes = static_cast<VkDeviceSize>(swap_chain_wrp::MAX_FRAMES_IN_FLIGHT) * STATS_STRIDE * sizeof(uint32_t);
+		stats_buffer = resources.create_buffer({
+			.size = stats_bytes,
+			.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			.memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			.category = memory_category::readback,
+		});
+		void* mapped;
+		vkMapMemory(device.get_device(), resources.get(stats_buffer)->memory, 0, stats_bytes, 0, &mapped);
+		mapped_stats = static_cast<uint32_t*>(mapped);
+		std::memset(mapped_stats, 0, stats_bytes);
+
+		// the bounds don't change, so they go through a staging buffer once
+		std::vector<float> packed(static_cast<size_t>(object_count) * 4);
+		for (uint32_t i = 0; i < object_count; i++)
+		{
+			packed[i * 4 + 0] = bounds.x[i];
+			packed[i * 4 + 1] = bounds.y[i];
+			packed[i * 4 + 2] = bounds.z[i];
+			packed[i * 4 + 3] = bounds.radius[i];
+		}
+		auto bounds_bytes = static_cast<VkDeviceSize>(packed.size() * sizeof(float));
+		bounds_buffer = resources.create_buffer({
+			.size = bounds_bytes,
+			.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		});
+
+		VkBuffer staging_buffer;
+		VkDeviceMemory staging_memory;
+		device.createBuffer(
+			bounds_bytes,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			staging_buffer,
+			staging_memory,
+			memory_category::staging);
+		void* staging;
+		vkMapMemory(device.get_device(), staging_memory, 0, bounds_bytes, 0, &staging);
+		std::memcpy(staging, packed.data(), bounds_bytes);
+		vkUnmapMemory(device.get_device(), staging_memory);
+
+		device.copyBuffer(staging_buffer, resources.get(bounds_buffer)->buffer, bounds_bytes);
+		// copyBuffer waited for the copy, its writes still have to be made visible to the test
+		device.get_barriers().assume(
+			resources.get(bounds_buffer)->buffer, { VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR, VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR });
+		vkDestroyBuffer(device.get_device(), staging_buffer, nullptr);
+		device.free_memory(staging_memory);
+	}
+
+	void occlusion_culler::create_pyramid()
+	{
+		pyramid_width = std::bit_floor(swap_chain.width());
+		pyramid_height = std::bit_floor(swap_chain.height());
+		pyramid_levels = static_cast<uint32_t>(std::bit_width(std::max(pyramid_width, pyramid_height)));
+
+		auto image_info = VkImageCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.imageType = VK_IMAGE_TYPE_2D,
+			.format = VK_FORMAT_R32_SFLOAT,
+			.extent = { pyramid_width, pyramid_height, 1 },
+			.mipLevels = pyramid_levels,
+			.arrayLayers = 1,
+			.samples = VK_SAMPLE_COUNT_1_BIT,
+			.tiling = VK_IMAGE_TILING_OPTIMAL,
+			.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+		};
+		pyramid = device.get_resources().create_image({
+			.info = image_info,
+			.category = memory_category::image,
+			.view_aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+		});
+		auto pyramid_image = device.get_resources().get(pyramid)->image;
+
+		level_views.resize(pyramid_levels);
+		for (uint32_t level = 0; level < pyramid_levels; level++)
+		{
+			auto view_info = VkImageViewCreateInfo{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+				.image = pyramid_image,
+				.viewType = VK_IMAGE_VIEW_TYPE_2D,
+				.format = VK_FORMAT_R32_SFLOAT,
+				.subresourceRange = {
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.baseMipLevel = level,
+					.levelCount = 1,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+			};
+			if (vkCreateImageView(device.get_device(), &view_info, nullptr, &level_views[level]) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to create depth pyramid view");
+			}
+		}
+
+		auto sampler_info = VkSamplerCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+			.magFilter = VK_FILTER_NEAREST,
+			.minFilter = VK_FILTER_NEAREST,
+			.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+			.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+			.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+			.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+			.maxLod = VK_LOD_CLAMP_NONE,
+		};
+		if (vkCreateSampler(device.get_device(), &sampler_info, nullptr, &sampler) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create depth pyramid sampler");
+		}
+
+		// nothing has been drawn yet, so the first early pass draws nothing and the late pass
+		// everything that's in view. the pyramid gets its layout from the first record_cull
+		auto& barriers = device.get_barriers();
+		auto visibility = device.get_resources().get(visibility_buffer)->buffer;
+		auto late = device.get_resources().get(late_buffer)->buffer;
+		auto fill = resource_access{ VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR, VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR };
+
+		auto command_buffer = device.begin_single_time_commands();
+		barriers.use(visibility, fill);
+		barriers.use(late, fill);
+		barriers.flush(command_buffer);
+		vkCmdFillBuffer(command_buffer, visibility, 0, VK_WHOLE_SIZE, 0);
+		vkCmdFillBuffer(command_buffer, late, 0, VK_WHOLE_SIZE, 0);
+		barriers.use(visibility, { VK_PIPELINE_STAGE_2_CONDITIONAL_RENDERING_BIT_EXT, VK_ACCESS_2_CONDITIONAL_RENDERING_READ_BIT_EXT });
+		barriers.flush(command_buffer);
+		device.end_single_time_commands(command_buffer);
+	}
+
+	void occlusion_culler::create_descriptors()
+	{
+		auto sampled = [](uint32_t binding) {
+			return VkDescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			};
+		};
+		auto storage = [](uint32_t binding, VkDescriptorType type) {
+			return VkDescriptorSetLayoutBinding{
+				.binding = binding,
+				.descriptorType = type,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			};
+		};
+
+		auto downsample_bindings = std::array{ sampled(0), storage(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE) };
+		auto cull_bindings = std::array{
+			sampled(0),
+			storage(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+			storage(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+			storage(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+			storage(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+		};
+
+		auto layout_info = VkDescriptorSetLayoutCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+			.bindingCount = static_cast<uint32_t>(downsample_bindings.size()),
+			.pBindings = downsample_bindings.data(),
+		};
+		if (vkCreateDescriptorSetLayout(device.get_device(), &layout_info, nullptr, &downsample_set_layout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create descriptor set layout");
+		}
+		layout_info.bindingCount = static_cast<uint32_t>(cull_bindings.size());
+		layout_info.pBindings = cull_bindings.data();
+		if (vkCreateDescriptorSetLayout(device.get_device(), &layout_info, nullptr, &cull_set_layout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create descriptor set layout");
+		}
+
+		auto image_count = static_cast<uint32_t>(swap_chain.image_count());
+		auto downsample_count = image_count + pyramid_levels - 1;
+		auto pool_sizes = std::array{
+			VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, downsample_count + 1 },
+			VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, downsample_count },
+			VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4 },
+		};
+		auto pool_info = VkDescriptorPoolCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+			.maxSets = downsample_count + 1,
+			.poolSizeCount = static_cast<uint32_t>(pool_sizes.size()),
+			.pPoolSizes = pool_sizes.data(),
+		};
+		if (vkCreateDescriptorPool(device.get_device(), &pool_info, nullptr, &descriptor_pool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create descriptor pool");
+		}
+
+		std::vector<VkDescriptorSetLayout> set_layouts(downsample_count, downsample_set_layout);
+		set_layouts.push_back(cull_set_layout);
+		std::vector<VkDescriptorSet> sets(set_layouts.size());
+		auto alloc_info = VkDescriptorSetAllocateInfo{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+			.descriptorPool = descriptor_pool,
+			.descriptorSetCount = static_cast<uint32_t>(sets.size()),
+			.pSetLayouts = set_layouts.data(),
+		};
+		if (vkAllocateDescriptorSets(device.get_device(), &alloc_info, sets.data()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate descriptor sets");
+		}
+		cull_set = sets.back();
+		sets.pop_back();
+		downsample_sets = std::move(sets);
+
+		// level 0 reads the depth image of whichever swap chain image is being drawn, every
+		// other level the one before it
+		auto& resources = device.get_resources();
+		std::vector<VkDescriptorImageInfo> sources, destinations;
+		sources.reserve(downsample_count);
+		destinations.reserve(downsample_count);
+		for (uint32_t i = 0; i < downsample_count; i++)
+		{
+			auto level = i < image_count ? 0 : i - image_count + 1;
+			if (level == 0)
+			{
+				auto depth_view = resources.get(swap_chain.get_depth_image(static_cast<int>(i)))->view;
+				sources.push_back({ sampler, depth_view, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL });
+			}
+			else
+			{
+				sources.push_back({ sampler, level_views[level - 1], VK_IMAGE_LAYOUT_GENERAL });
+			}
+			destinations.push_back({ VK_NULL_HANDLE, level_views[level], VK_IMAGE_LAYOUT_GENERAL });
+		}
+
+		auto pyramid_info = VkDescriptorImageInfo{ sampler, resources.get(pyramid)->view, VK_IMAGE_LAYOUT_GENERAL };
+		auto buffer_info = [&](buffer_handle buffer) {
+			return VkDescriptorBufferInfo{ resources.get(buffer)->buffer, 0, VK_WHOLE_SIZE };
+		};
+		auto buffer_infos = std::array{
+			buffer_info(bounds_buffer),
+			buffer_info(visibility_buffer),
+			buffer_info(late_buffer),
+			buffer_info(stats_buffer),
+		};
+
+		std::vector<VkWriteDescriptorSet> writes;
+		auto write = [&](VkDescriptorSet set, uint32_t binding, VkDescriptorType type) {
+			return VkWriteDescriptorSet{
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.dstSet = set,
+				.dstBinding = binding,
+				.descriptorCount = 1,
+				.descriptorType = type,
+			};
+		};
+		for (uint32_t i = 0; i < downsample_count; i++)
+		{
+			auto& source = writes.emplace_back(write(downsample_sets[i], 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER));
+			source.pImageInfo = &sources[i];
+			auto& destination = writes.emplace_back(write(downsample_sets[i], 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE));
+			destination.pImageInfo = &destinations[i];
+		}
+		writes.emplace_back(write(cull_set, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)).pImageInfo = &pyramid_info;
+		for (uint32_t i = 0; i < buffer_infos.size(); i++)
+		{
+			writes.emplace_back(write(cull_set, i + 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)).pBufferInfo = &buffer_infos[i];
+		}
+
+		vkUpdateDescriptorSets(device.get_device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+	}
+
+	void occlusion_culler::create_pipelines()
+	{
+		auto create_layout = [&](VkDescriptorSetLayout set_layout, uint32_t constants_size) {
+			auto push_constant_range = VkPushConstantRange{
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+				.offset = 0,
+				.size = constants_size,
+			};
+			auto layout_info = VkPipelineLayoutCreateInfo{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+				.setLayoutCount = 1,
+				.pSetLayouts = &set_layout,
+				.pushConstantRangeCount = 1,
+				.pPushConstantRanges = &push_constant_range,
+			};
+			VkPipelineLayout layout;
+			if (vkCreatePipelineLayout(device.get_device(), &layout_info, nullptr, &layout) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to create pipeline layout");
+			}
+			return layout;
+		};
+
+		downsample_layout = create_layout(downsample_set_layout, sizeof(downsample_constants));
+		cull_layout = create_layout(cull_set_layout, sizeof(cull_constants));
+		downsample_pipeline = create_compute_pipeline("shaders/spv/hiz_downsample.comp.spv", downsample_layout);
+		cull_pipeline = create_compute_pipeline("shaders/spv/occlusion_cull.comp.spv", cull_layout);
+	}
+
+	auto occlusion_culler::create_compute_pipeline(const char* path, VkPipelineLayout layout) -> VkPipeline
+	{
+		// words only points into the loaded file, which has to outlive vkCreateShaderModule
+		auto shader = load_shader(path);
+		auto code = shader.words();
+		auto module_info = VkShaderModuleCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+			.codeSize = code.size_bytes(),
+			.pCode = code.data(),
+		};
+		VkShaderModule module;
+		if (vkCreateShaderModule(device.get_device(), &module_info, nullptr, &module) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create shader module");
+		}
+
+		auto pipeline_info = VkComputePipelineCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+			.stage = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+				.module = module,
+				.pName = "main",
+			},
+			.layout = layout,
+		};
+		VkPipeline pipeline;
+		auto result = vkCreateComputePipelines(device.get_device(), VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline);
+		// the pipeline doesn't need the module once it's built
+		vkDestroyShaderModule(device.get_device(), module, nullptr);
+		if (result != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::string{ "failed to create compute pipeline for " } + path);
+		}
+		return pipeline;
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "device_wrp.hpp"
+#include "swap_chain_wrp.hpp"
+#include "culling.hpp"
+
+#include <glm/mat4x4.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace lvk
+{
+	// what the last finished frame's occlusion test found, counted on the gpu. objects outside
+	// the view are in neither visible nor occluded
+	struct occlusion_stats
+	{
+		uint32_t visible = 0;
+		uint32_t occluded = 0;
+		// visible now but not in the frame before, drawn by the late pass
+		uint32_t late = 0;
+	};
+
+	// hierarchical z occlusion culling on top of the cpu frustum culling. the frame is split in two:
+	//   early pass: draws what was visible last frame, which is a good guess of what's visible now
+	//   record_cull: builds a max depth pyramid from that depth and tests every object against it
+	//   late pass: draws what passed the test but wasn't drawn by the early pass
+	// draws stay recorded on the cpu, each one is just wrapped in VK_EXT_conditional_rendering
+	// on the gpu's verdict, so nothing has to come back to the cpu.
+	//
+	// per frame usage, all in the command buffer of swap_chain's image_index:
+	//   early render pass with every draw inside begin_early/end, then record_cull,
+	//   then late render pass with every draw inside begin_late/end
+	class occlusion_culler
+	{
+	public:
+		// bounds are indexed by object, the same indices go to begin_early and begin_late
+		occlusion_culler(device_wrp& _device, swap_chain_wrp& _swap_chain, const sphere_bounds& bounds);
+		~occlusion_culler();
+
+		occlusion_culler(const occlusion_culler&) = delete;
+		occlusion_culler& operator=(const occlusion_culler&) = delete;
+
+		// needs VK_EXT_conditional_rendering and compute on the graphics queue
+		static bool is_supported(device_wrp& device);
+
+		void begin_early(VkCommandBuffer command_buffer, uint32_t object);
+		void begin_late(VkCommandBuffer command_buffer, uint32_t object);
+		void end(VkCommandBuffer command_buffer);
+
+		// goes between the two render passes
+		void record_cull(VkCommandBuffer command_buffer, uint32_t image_index, const glm::mat4& view_projection);
+
+		// results of the frame that last used the current frame in flight's slot, so call it after
+		// acquiring and before record_cull
+		auto collect_stats() -> occlusion_stats;
+
+		auto get_pyramid_levels() const -> uint32_t
+		{
+			return pyramid_levels;
+		}
+
+	private:
+		struct downsample_constants
+		{
+			uint32_t source_width, source_height;
+			uint32_t width, height;
+		};
+
+		struct cull_constants
+		{
+			glm::mat4 view_projection;
+			uint32_t pyramid_width, pyramid_height;
+			uint32_t pyramid_levels;
+			uint32_t object_count;
+			uint32_t stats_slot;
+		};
+
+		void create_buffers(const sphere_bounds& bounds);
+		void create_pyramid();
+		void create_descriptors();
+		void create_pipelines();
+		auto create_compute_pipeline(const char* path, VkPipelineLayout layout) -> VkPipeline;
+		void begin(VkCommandBuffer command_buffer, buffer_handle predicates, uint32_t object);
+
+		device_wrp& device;
+		swap_chain_wrp& swap_chain;
+		uint32_t object_count;
+
+		PFN_vkCmdBeginConditionalRenderingEXT begin_conditional_rendering;
+		PFN_vkCmdEndConditionalRenderingEXT end_conditional_rendering;
+
+		// one vec4 of center and radius per object
+		buffer_handle bounds_buffer;
+		// one uint per object. visibility is what the last test found and decides the early pass,
+		// late is visible now but not before and decides the late pass
+		buffer_handle visibility_buffer;
+		buffer_handle late_buffer;
+		// 4 uints of occlusion_stats per frame in flight, host visible and persistently mapped
+		buffer_handle stats_buffer;
+		uint32_t* mapped_stats = nullptr;
+
+		// r32f, always in the general layout. mip 0 is the swap chain's size rounded down to
+		// powers of two, so every further level halves cleanly
+		image_handle pyramid;
+		uint32_t pyramid_width = 0, pyramid_height = 0, pyramid_levels = 0;
+		// one view per level for writing it and reading it while building the next one
+		std::vector<VkImageView> level_views;
+		VkSampler sampler = VK_NULL_HANDLE;
+
+		VkDescriptorSetLayout downsample_set_layout = VK_NULL_HANDLE;
+		VkDescriptorSetLayout cull_set_layout = VK_NULL_HANDLE;
+		VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+		// per swap chain image for level 0 (reading its depth image), then one per further level
+		std::vector<VkDescriptorSet> downsample_sets;
+		VkDescriptorSet cull_set = VK_NULL_HANDLE;
+
+		VkPipelineLayout downsample_layout = VK_NULL_HANDLE;
+		VkPipelineLayout cull_layout = VK_NULL_HANDLE;
+		VkPipeline downsample_pipeline = VK_NULL_HANDLE;
+		VkPipeline cull_pipeline = VK_NULL_HANDLE;
+	};
+}
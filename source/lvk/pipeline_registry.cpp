@@ -0,0 +1,295 @@
+#include "pipeline_registry.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace lvk
+{
+	namespace
+	{
+		constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+		constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+		auto fnv1a(const char* data, size_t size, uint64_t hash = FNV_OFFSET_BASIS) -> uint64_t
+		{
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= static_cast<uint8_t>(data[i]);
+				hash *= FNV_PRIME;
+			}
+			return hash;
+		}
+
+		// appends plain values field by field, so padding bytes and pointers
+		// (sType/pNext/pAttachments) never end up in the key
+		struct state_writer
+		{
+			std::string& out;
+
+			template<typename T>
+			void put(const T& value)
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+			}
+
+			void put_stencil_op(const VkStencilOpState& op)
+			{
+				put(op.failOp);
+				put(op.passOp);
+				put(op.depthFailOp);
+				put(op.compareOp);
+				put(op.compareMask);
+				put(op.writeMask);
+				put(op.reference);
+			}
+
+			void put_specialization(const specialization_info& info)
+			{
+				put(static_cast<uint32_t>(info.map_entries.size()));
+				for (const auto& entry : info.map_entries)
+				{
+					put(entry.constantID);
+					put(entry.offset);
+					put(static_cast<uint64_t>(entry.size));
+				}
+				put(static_cast<uint64_t>(info.data.size()));
+				out.append(info.data.data(), info.data.size());
+			}
+
+			void put_shader(std::span<const uint32_t> code)
+			{
+				// the module identity is its content, not the path it was loaded from
+				put(static_cast<uint64_t>(code.size_bytes()));
+				put(fnv1a(reinterpret_cast<const char*>(code.data()), code.size_bytes()));
+			}
+		};
+	}
+
+	pipeline_registry::pipeline_registry(device_wrp& _device) : device{ _device }
+	{
+	}
+
+	size_t pipeline_registry::state_hash::operator()(const std::string& state) const
+	{
+		return static_cast<size_t>(fnv1a(state.data(), state.size()));
+	}
+
+	auto pipeline_registry::serialize_state(
+		const pipeline_config_info& config_info,
+		std::span<const uint32_t> vert_code,
+		std::span<const uint32_t> frag_code) -> std::string
+	{
+		std::string state;
+		state_writer writer{ state };
+
+		writer.put(static_cast<uint32_t>(config_info.binding_descriptions.size()));
+		for (const auto& binding : config_info.binding_descriptions)
+		{
+			writer.put(binding.binding);
+			writer.put(binding.stride);
+			writer.put(binding.inputRate);
+		}
+		writer.put(static_cast<uint32_t>(config_info.attribute_descriptions.size()));
+		for (const auto& attribute : config_info.attribute_descriptions)
+		{
+			writer.put(attribute.location);
+			writer.put(attribute.binding);
+			writer.put(attribute.format);
+			writer.put(attribute.offset);
+		}
+
+		writer.put(config_info.viewport);
+		writer.put(config_info.scissor);
+
+		const auto& input_assembly = config_info.input_assembly_info;
+		writer.put(input_assembly.flags);
+		writer.put(input_assembly.topology);
+		writer.put(input_assembly.primitiveRestartEnable);
+
+		const auto& rasterization = config_info.rasterization_info;
+		writer.put(rasterization.flags);
+		writer.put(rasterization.depthClampEnable);
+		writer.put(rasterization.rasterizerDiscardEnable);
+		writer.put(rasterization.polygonMode);
+		writer.put(rasterization.cullMode);
+		writer.put(rasterization.frontFace);
+		writer.put(rasterization.depthBiasEnable);
+		writer.put(rasterization.depthBiasConstantFactor);
+		writer.put(rasterization.depthBiasClamp);
+		writer.put(rasterization.depthBiasSlopeFactor);
+		writer.put(rasterization.lineWidth);
+
+		const auto& multisample = config_info.multisample_info;
+		writer.put(multisample.flags);
+		writer.put(multisample.rasterizationSamples);
+		writer.put(multisample.sampleShadingEnable);
+		writer.put(multisample.minSampleShading);
+		writer.put(multisample.pSampleMask != nullptr);
+		if (multisample.pSampleMask != nullptr)
+		{
+			auto mask_words = (static_cast<uint32_t>(multisample.rasterizationSamples) + 31) / 32;
+			for (uint32_t i = 0; i < mask_words; i++)
+			{
+				writer.put(multisample.pSampleMask[i]);
+			}
+		}
+		writer.put(multisample.alphaToCoverageEnable);
+		writer.put(multisample.alphaToOneEnable);
+
+		// pAttachments may point at a config that has since been copied,
+		// so the single attachment is read from the config itself
+		const auto& blend_attachment = config_info.color_blend_attachment;
+		writer.put(blend_attachment.blendEnable);
+		writer.put(blend_attachment.srcColorBlendFactor);
+		writer.put(blend_attachment.dstColorBlendFactor);
+		writer.put(blend_attachment.colorBlendOp);
+		writer.put(blend_attachment.srcAlphaBlendFactor);
+		writer.put(blend_attachment.dstAlphaBlendFactor);
+		writer.put(blend_attachment.alphaBlendOp);
+		writer.put(blend_attachment.colorWriteMask);
+
+		const auto& color_blend = config_info.color_blend_info;
+		writer.put(color_blend.flags);
+		writer.put(color_blend.logicOpEnable);
+		writer.put(color_blend.logicOp);
+		writer.put(color_blend.attachmentCount);
+		writer.put(color_blend.blendConstants);
+
+		const auto& depth_stencil = config_info.depth_stencil_info;
+		writer.put(depth_stencil.flags);
+		writer.put(depth_stencil.depthTestEnable);
+		writer.put(depth_stencil.depthWriteEnable);
+		writer.put(depth_stencil.depthCompareOp);
+		writer.put(depth_stencil.depthBoundsTestEnable);
+		writer.put(depth_stencil.stencilTestEnable);
+		writer.put_stencil_op(depth_stencil.front);
+		writer.put_stencil_op(depth_stencil.back);
+		writer.put(depth_stencil.minDepthBounds);
+		writer.put(depth_stencil.maxDepthBounds);
+
+		// pipelines are only interchangeable within the same layout and render pass/subpass,
+		// or attachment formats without a render pass
+		writer.put(config_info.pipeline_layout);
+		writer.put(config_info.render_pass);
+		writer.put(config_info.subpass);
+		writer.put(config_info.color_format);
+		writer.put(config_info.depth_format);
+
+		writer.put_shader(vert_code);
+		writer.put_specialization(config_info.vert_specialization);
+		writer.put_shader(frag_code);
+		writer.put_specialization(config_info.frag_specialization);
+
+		return state;
+	}
+
+	auto pipeline_registry::get(
+		const pipeline_config_info& config_info,
+		const std::string& vert_path,
+		const std::string& frag_path) -> std::shared_ptr<pipeline_wrp>
+	{
+		auto vert_code = load_shader(vert_path, PREFER_DISK_SHADERS);
+		auto frag_code = load_shader(frag_path, PREFER_DISK_SHADERS);
+		auto pipeline = get(config_info, vert_code.words(), frag_code.words());
+
+		auto known = std::any_of(sources.begin(), sources.end(), [&](const pipeline_source& source) {
+			return source.pipeline.lock() == pipeline;
+		});
+		if (!known)
+		{
+			sources.push_back({ config_info, vert_path, frag_path, pipeline });
+		}
+
+		return pipeline;
+	}
+
+	auto pipeline_registry::get(
+		const pipeline_config_info& config_info,
+		std::span<const uint32_t> vert_code,
+		std::span<const uint32_t> frag_code) -> std::shared_ptr<pipeline_wrp>
+	{
+		auto state = serialize_state(config_info, vert_code, frag_code);
+
+		if (auto it = pipelines.find(state); it != pipelines.end())
+		{
+			stats.hits++;
+			return it->second;
+		}
+
+		stats.misses++;
+		auto pipeline = std::make_shared<pipeline_wrp>(device, config_info, vert_code, frag_code);
+		pipelines.emplace(std::move(state), pipeline);
+
+		return pipeline;
+	}
+
+	auto pipeline_registry::reload(const std::vector<std::string>& changed_paths) -> std::vector<pipeline_reload>
+	{
+		auto is_changed = [&](const std::string& path) {
+			return std::any_of(changed_paths.begin(), changed_paths.end(), [&](const std::string& changed) {
+				std::error_code error;
+				return std::filesystem::equivalent(path, changed, error);
+			});
+		};
+
+		std::vector<pipeline_reload> reloads;
+		for (auto& source : sources)
+		{
+			auto old_pipeline = source.pipeline.lock();
+			if (!old_pipeline || !(is_changed(source.vert_path) || is_changed(source.frag_path)))
+			{
+				continue;
+			}
+
+			try
+			{
+				// reloads always come from disk, that's where the recompiled shaders end up
+				auto vert_code = map_shader_file(source.vert_path);
+				auto frag_code = map_shader_file(source.frag_path);
+				auto new_pipeline = get(source.config_info, vert_code.words(), frag_code.words());
+
+				source.pipeline = new_pipeline;
+				reloads.push_back({ std::move(old_pipeline), std::move(new_pipeline) });
+			}
+			catch (const std::runtime_error& e)
+			{
+				std::cerr << "failed to reload pipeline (" << source.vert_path << ", " << source.frag_path
+						  << "): " << e.what() << std::endl;
+			}
+		}
+
+		return reloads;
+	}
+
+	void pipeline_registry::purge_unused()
+	{
+		std::erase_if(pipelines, [](const auto& entry) { return entry.second.use_count() == 1; });
+		std::erase_if(sources, [](const pipeline_source& source) { return source.pipeline.expired(); });
+	}
+
+	void pipeline_registry::clear()
+	{
+		pipelines.clear();
+		sources.clear();
+	}
+
+	auto pipeline_registry::get_stats() const -> pipeline_registry_stats
+	{
+		auto result = stats;
+		result.pipeline_count = pipelines.size();
+		return result;
+	}
+
+	auto pipeline_registry::hash_state(
+		const pipeline_config_info& config_info,
+		std::span<const uint32_t> vert_code,
+		std::span<const uint32_t> frag_code) -> uint64_t
+	{
+		auto state = serialize_state(config_info, vert_code, frag_code);
+		return fnv1a(state.data(), state.size());
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "pipeline_wrp.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lvk
+{
+	struct pipeline_registry_stats
+	{
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		size_t pipeline_count = 0;
+	};
+
+	struct pipeline_reload
+	{
+		std::shared_ptr<pipeline_wrp> old_pipeline;
+		std::shared_ptr<pipeline_wrp> new_pipeline;
+	};
+
+	// hands out shared pipelines keyed by the full pipeline state, so identical
+	// config + shader pairs only ever get compiled once
+	class pipeline_registry
+	{
+		// the key is the serialized pipeline state, hashed with fnv-1a
+		struct state_hash
+		{
+			size_t operator()(const std::string& state) const;
+		};
+
+		// file backed pipelines prefer the shaders on disk over the embedded ones while hot reloading
+#ifdef LVK_SHADER_HOT_RELOAD
+		static constexpr bool PREFER_DISK_SHADERS = true;
+#else
+		static constexpr bool PREFER_DISK_SHADERS = false;
+#endif
+
+		// remembers where file backed pipelines came from, so they can be rebuilt on reload
+		struct pipeline_source
+		{
+			pipeline_config_info config_info;
+			std::string vert_path, frag_path;
+			std::weak_ptr<pipeline_wrp> pipeline;
+		};
+
+		device_wrp& device;
+		std::unordered_map<std::string, std::shared_ptr<pipeline_wrp>, state_hash> pipelines;
+		std::vector<pipeline_source> sources;
+		pipeline_registry_stats stats;
+
+		static auto serialize_state(
+			const pipeline_config_info& config_info,
+			std::span<const uint32_t> vert_code,
+			std::span<const uint32_t> frag_code
+		) -> std::string;
+
+	public:
+		explicit pipeline_registry(device_wrp& _device);
+		~pipeline_registry() = default;
+
+		pipeline_registry(const pipeline_registry&) = delete;
+		pipeline_registry& operator=(const pipeline_registry&) = delete;
+
+		auto get(
+			const pipeline_config_info& config_info,
+			const std::string& vert_path,
+			const std::string& frag_path
+		) -> std::shared_ptr<pipeline_wrp>;
+		auto get(
+			const pipeline_config_info& config_info,
+			std::span<const uint32_t> vert_code,
+			std::span<const uint32_t> frag_code
+		) -> std::shared_ptr<pipeline_wrp>;
+
+		// rebuilds every file backed pipeline that uses one of the given shader files. callers can
+		// swap old_pipeline for new_pipeline right away, the old one is destroyed through the
+		// device's deletion queue once the frames using it have finished.
+		// pipelines that fail to rebuild are skipped and keep running with the old shaders
+		auto reload(const std::vector<std::string>& changed_paths) -> std::vector<pipeline_reload>;
+
+		// drops every pipeline that isn't referenced outside the registry anymore
+		void purge_unused();
+		void clear();
+
+		auto get_stats() const -> pipeline_registry_stats;
+
+		// stable 64 bit hash of the state a pipeline would be compiled from
+		static auto hash_state(
+			const pipeline_config_info& config_info,
+			std::span<const uint32_t> vert_code,
+			std::span<const uint32_t> frag_code
+		) -> uint64_t;
+	};
+}
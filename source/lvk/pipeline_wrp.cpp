@@ -1,6 +1,6 @@
 #include "pipeline_wrp.hpp"
+#include "trace.hpp"
 
-#include <fstream>
 #include <stdexcept>
 #include <iostream>
 #include <cassert>
@@ -14,29 +14,41 @@ namespace lvk
 		const std::string& _frag_path
 	) : device{ _device }
 	{
-		create_graphics_pipeline(_config, _vert_path, _frag_path);
+		create_graphics_pipeline(_config, load_shader(_vert_path).words(), load_shader(_frag_path).words());
+	}
 
+	pipeline_wrp::pipeline_wrp(
+		device_wrp& _device,
+		const pipeline_config_info& _config,
+		std::span<const uint32_t> _vert_code,
+		std::span<const uint32_t> _frag_code
+	) : device{ _device }
+	{
+		create_graphics_pipeline(_config, _vert_code, _frag_code);
 	}
 
 	pipeline_wrp::~pipeline_wrp()
 	{
-		vkDestroyShaderModule(device.get_device(), vert_shader_module, nullptr);
-		vkDestroyShaderModule(device.get_device(), frag_shader_module, nullptr);
-		vkDestroyPipeline(device.get_device(), graphics_pipeline, nullptr);
+		// frames still in flight can be using it, e.g. right after a hot reload swapped it out
+		device.get_deletion_queue().defer(
+			[device = device.get_device(), pipeline = graphics_pipeline, vert = vert_shader_module, frag = frag_shader_module] {
+				vkDestroyShaderModule(device, vert, nullptr);
+				vkDestroyShaderModule(device, frag, nullptr);
+				vkDestroyPipeline(device, pipeline, nullptr);
+			});
 	}
 
 	void pipeline_wrp::create_graphics_pipeline(
 		const pipeline_config_info& config_info,
-		const std::string& vert_path,
-		const std::string& frag_path)
+		std::span<const uint32_t> vert_code,
+		std::span<const uint32_t> frag_code)
 	{
+		LVK_TRACE_SCOPE("build graphics pipeline");
+
 		assert(config_info.pipeline_layout != VK_NULL_HANDLE
 			&& "Cannot create graphics pipeline: no pipeline_layout provided in config_info");
-		assert(config_info.render_pass != VK_NULL_HANDLE
-			&& "Cannot create graphics pipeline: no render_pass provided in config_info");
-
-		auto vert_code = read_file(vert_path);
-		auto frag_code = read_file(frag_path);
+		assert((config_info.render_pass != VK_NULL_HANDLE || config_info.color_format != VK_FORMAT_UNDEFINED)
+			&& "Cannot create graphics pipeline: neither a render_pass nor attachment formats provided in config_info");
 
 //		std::cout << "vert size: " << vert_code.size() << '\n'
 //				  << "frag size: " << frag_code.size() << '\n';
@@ -44,6 +56,9 @@ namespace lvk
 		create_shader_module(vert_code, &vert_shader_module);
 		create_shader_module(frag_code, &frag_shader_module);
 
+		auto vert_specialization = make_specialization_info(config_info.vert_specialization);
+		auto frag_specialization = make_specialization_info(config_info.frag_specialization);
+
 		VkPipelineShaderStageCreateInfo shader_stages[2];
 
 		shader_stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -52,7 +67,8 @@ namespace lvk
 		shader_stages[0].pName = "main";
 		shader_stages[0].flags = 0;
 		shader_stages[0].pNext = nullptr;
-		shader_stages[0].pSpecializationInfo = nullptr;
+		shader_stages[0].pSpecializationInfo =
+			config_info.vert_specialization.empty() ? nullptr : &vert_specialization;
 
 		shader_stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		shader_stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -60,14 +76,15 @@ namespace lvk
 		shader_stages[1].pName = "main";
 		shader_stages[1].flags = 0;
 		shader_stages[1].pNext = nullptr;
-		shader_stages[1].pSpecializationInfo = nullptr;
+		shader_stages[1].pSpecializationInfo =
+			config_info.frag_specialization.empty() ? nullptr : &frag_specialization;
 
 		VkPipelineVertexInputStateCreateInfo vert_input_info{};
 		vert_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vert_input_info.vertexAttributeDescriptionCount = 0;
-		vert_input_info.vertexBindingDescriptionCount = 0;
-		vert_input_info.pVertexAttributeDescriptions = nullptr;
-		vert_input_info.pVertexBindingDescriptions = nullptr;
+		vert_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(config_info.attribute_descriptions.size());
+		vert_input_info.vertexBindingDescriptionCount = static_cast<uint32_t>(config_info.binding_descriptions.size());
+		vert_input_info.pVertexAttributeDescriptions = config_info.attribute_descriptions.data();
+		vert_input_info.pVertexBindingDescriptions = config_info.binding_descriptions.data();
 
 		VkPipelineViewportStateCreateInfo viewport_info{};
 		viewport_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -76,6 +93,10 @@ namespace lvk
 		viewport_info.scissorCount = 1;
 		viewport_info.pScissors = &config_info.scissor;
 
+		// pAttachments would dangle once the config has been copied, so point it at this config's attachment
+		auto color_blend_info = config_info.color_blend_info;
+		color_blend_info.pAttachments = &config_info.color_blend_attachment;
+
 		VkGraphicsPipelineCreateInfo pipeline_info{};
 		pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 		pipeline_info.stageCount = 2;
@@ -85,7 +106,7 @@ namespace lvk
 		pipeline_info.pViewportState = &viewport_info;
 		pipeline_info.pRasterizationState = &config_info.rasterization_info;
 		pipeline_info.pMultisampleState = &config_info.multisample_info;
-		pipeline_info.pColorBlendState = &config_info.color_blend_info;
+		pipeline_info.pColorBlendState = &color_blend_info;
 		pipeline_info.pDepthStencilState = &config_info.depth_stencil_info;
 		pipeline_info.pDynamicState = nullptr;
 
@@ -93,6 +114,16 @@ namespace lvk
 		pipeline_info.renderPass = config_info.render_pass;
 		pipeline_info.subpass = config_info.subpass;
 
+		VkPipelineRenderingCreateInfoKHR rendering_info{};
+		rendering_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+		if (config_info.render_pass == VK_NULL_HANDLE)
+		{
+			rendering_info.colorAttachmentCount = 1;
+			rendering_info.pColorAttachmentFormats = &config_info.color_format;
+			rendering_info.depthAttachmentFormat = config_info.depth_format;
+			pipeline_info.pNext = &rendering_info;
+		}
+
 		pipeline_info.basePipelineIndex = -1;
 		pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
 
@@ -108,31 +139,22 @@ namespace lvk
 		}
 	}
 
-	auto pipeline_wrp::read_file(const std::string& file_path) -> std::vector<char>
+	auto pipeline_wrp::make_specialization_info(const specialization_info& info) -> VkSpecializationInfo
 	{
-		std::ifstream file{ file_path, std::ios::ate | std::ios::binary };
-		if (!file.is_open())
-		{
-			throw std::runtime_error("failed to open file: " + file_path);
-		}
-
-		auto file_size = static_cast<size_t>(file.tellg());
-		std::vector<char> buffer(file_size);
-
-		file.seekg(0);
-		file.read(buffer.data(), file_size);
-
-		file.close();
-
-		return buffer;
+		return VkSpecializationInfo{
+			.mapEntryCount = static_cast<uint32_t>(info.map_entries.size()),
+			.pMapEntries = info.map_entries.data(),
+			.dataSize = info.data.size(),
+			.pData = info.data.data(),
+		};
 	}
 
-	void pipeline_wrp::create_shader_module(const std::vector<char>& code, VkShaderModule* shader_module)
+	void pipeline_wrp::create_shader_module(std::span<const uint32_t> code, VkShaderModule* shader_module)
 	{
 		VkShaderModuleCreateInfo create_info{};
 		create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		create_info.codeSize = code.size();
-		create_info.pCode = reinterpret_cast<const uint32_t*>(code.data());
+		create_info.codeSize = code.size_bytes();
+		create_info.pCode = code.data();
 
 		if (vkCreateShaderModule(device.get_device(), &create_info, nullptr, shader_module) != VK_SUCCESS)
 		{
@@ -1,14 +1,69 @@
 #pragma once
 
 #include "device_wrp.hpp"
+#include "shader_library.hpp"
 
+#include <cstring>
+#include <span>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace lvk
 {
+	// specialization constants for a single shader stage.
+	// values are copied into a tightly packed blob, so the source struct's layout doesn't matter
+	struct specialization_info
+	{
+		std::vector<VkSpecializationMapEntry> map_entries;
+		std::vector<char> data;
+
+		template<typename T>
+		void add(uint32_t constant_id, const T& value)
+		{
+			static_assert(std::is_arithmetic_v<T>, "specialization constants must be scalars");
+
+			// spir-v booleans are always specialized through a VkBool32
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				add<VkBool32>(constant_id, value ? VK_TRUE : VK_FALSE);
+			}
+			else
+			{
+				auto offset = (data.size() + alignof(T) - 1) / alignof(T) * alignof(T);
+				data.resize(offset + sizeof(T));
+				std::memcpy(data.data() + offset, &value, sizeof(T));
+
+				map_entries.push_back({
+					.constantID = constant_id,
+					.offset = static_cast<uint32_t>(offset),
+					.size = sizeof(T),
+				});
+			}
+		}
+
+		// builds the map entries from the given members, which get constant_id 0, 1, 2... in order.
+		// e.g. specialization_info::from(constants, &constants_t::use_fog, &constants_t::light_count)
+		template<typename T, typename... Members>
+		static auto from(const T& constants, Members T::*... members) -> specialization_info
+		{
+			specialization_info info{};
+			uint32_t constant_id = 0;
+			(info.add(constant_id++, constants.*members), ...);
+			return info;
+		}
+
+		bool empty() const
+		{
+			return map_entries.empty();
+		}
+	};
+
 	struct pipeline_config_info
 	{
+		// left empty for shaders that make up their own vertices
+		std::vector<VkVertexInputBindingDescription> binding_descriptions;
+		std::vector<VkVertexInputAttributeDescription> attribute_descriptions;
 		VkViewport viewport;
 		VkRect2D scissor;
 		// VkPipelineViewportStateCreateInfo viewport_info;
@@ -21,6 +76,12 @@ namespace lvk
 		VkPipelineLayout pipeline_layout = nullptr;
 		VkRenderPass render_pass = nullptr;
 		uint32_t subpass = 0;
+		// with VK_KHR_dynamic_rendering there's no render pass, the pipeline only needs to know
+		// the formats it draws into. only used when render_pass is null
+		VkFormat color_format = VK_FORMAT_UNDEFINED;
+		VkFormat depth_format = VK_FORMAT_UNDEFINED;
+		specialization_info vert_specialization;
+		specialization_info frag_specialization;
 	};
 
 	class pipeline_wrp
@@ -29,15 +90,15 @@ namespace lvk
 		VkPipeline graphics_pipeline;
 		VkShaderModule vert_shader_module, frag_shader_module;
 
-		static auto read_file(const std::string& file_path) -> std::vector<char>;
-
 		void create_graphics_pipeline(
 			const pipeline_config_info& config_info,
-			const std::string& vert_path,
-			const std::string& frag_path
+			std::span<const uint32_t> vert_code,
+			std::span<const uint32_t> frag_code
 		);
 
-		void create_shader_module(const std::vector<char>& code, VkShaderModule* shader_module);
+		static auto make_specialization_info(const specialization_info& info) -> VkSpecializationInfo;
+
+		void create_shader_module(std::span<const uint32_t> code, VkShaderModule* shader_module);
 
 	public:
 		pipeline_wrp(
@@ -46,6 +107,12 @@ namespace lvk
 			const std::string& _vert_path,
 			const std::string& _frag_path
 		);
+		pipeline_wrp(
+			device_wrp& _device,
+			const pipeline_config_info& _config,
+			std::span<const uint32_t> _vert_code,
+			std::span<const uint32_t> _frag_code
+		);
 		~pipeline_wrp();
 
 		pipeline_wrp(const pipeline_wrp&) = delete;
@@ -54,6 +121,10 @@ namespace lvk
 		static auto default_pipeline_config_info(uint32_t width, uint32_t height) -> pipeline_config_info;
 
 		void bind(VkCommandBuffer commandBuffer);
+		VkPipeline get_pipeline() const
+		{
+			return graphics_pipeline;
+		}
 	};
 
 }
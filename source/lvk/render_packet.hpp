@@ -0,0 +1,19 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace lvk
+{
+	// everything the render thread needs to draw one frame. the simulation fills one in per tick
+	// and hands a copy over through the frame queue, after that it's never touched by the main thread
+	struct render_packet
+	{
+		uint64_t sim_frame = 0;
+		double sim_time = 0.0;
+		// when the input this packet is based on was polled, for latency measurements
+		std::chrono::steady_clock::time_point input_time;
+		std::array<float, 4> clear_color{ 0.1f, 0.1f, 0.1f, 1.0f };
+	};
+}
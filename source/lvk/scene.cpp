@@ -0,0 +1,486 @@
+#include "scene.hpp"
+
+#include "job_system.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace lvk
+{
+	namespace
+	{
+		constexpr uint32_t UNKNOWN_DEPTH = ~0u;
+
+		// reorders v so that v[i] becomes the old v[order[i]]
+		template<typename T>
+		void permute(std::vector<T>& v, const std::vector<uint32_t>& order)
+		{
+			std::vector<T> sorted(v.size());
+			for (size_t i = 0; i < order.size(); i++)
+			{
+				sorted[i] = v[order[i]];
+			}
+			v.swap(sorted);
+		}
+
+		// drops every element whose keep flag is false, keeping the order of the rest
+		template<typename T>
+		void compact(std::vector<T>& v, const std::vector<bool>& keep)
+		{
+			size_t write = 0;
+			for (size_t read = 0; read < v.size(); read++)
+			{
+				if (keep[read])
+				{
+					v[write++] = v[read];
+				}
+			}
+			v.resize(write);
+		}
+
+		// calls f on every column so adding one can't be forgotten in one of the reorderings
+		template<typename Columns, typename F>
+		void for_each_column(Columns& local, std::array<std::vector<float>, 12>& world, F&& f)
+		{
+			for (auto* column : { &local.px, &local.py, &local.pz, &local.rx, &local.ry, &local.rz, &local.rw, &local.sx, &local.sy, &local.sz })
+			{
+				f(*column);
+			}
+			for (auto& column : world)
+			{
+				f(column);
+			}
+		}
+	}
+
+	auto scene::create(entity parent) -> entity
+	{
+		auto parent_slot = NO_SLOT;
+		if (parent != NO_ENTITY)
+		{
+			if (!is_alive(parent))
+			{
+				throw std::runtime_error("can't create an entity under a dead parent");
+			}
+			parent_slot = entity_slots[parent];
+		}
+
+		entity e;
+		if (!free_entities.empty())
+		{
+			e = free_entities.back();
+			free_entities.pop_back();
+		}
+		else
+		{
+			e = static_cast<entity>(entity_slots.size());
+			entity_slots.push_back(NO_SLOT);
+		}
+
+		push_slot(e, parent_slot);
+		return e;
+	}
+
+	void scene::push_slot(entity e, uint32_t parent_slot)
+	{
+		auto slot = static_cast<uint32_t>(slot_entities.size());
+		auto depth = parent_slot == NO_SLOT ? 0u : depths[parent_slot] + 1;
+
+		// appending keeps the slots sorted as long as the depth doesn't go down
+		if (!hierarchy_dirty)
+		{
+			if (depths.empty() || depth > depths.back())
+			{
+				depth_starts.push_back(slot);
+			}
+			else if (depth < depths.back())
+			{
+				hierarchy_dirty = true;
+			}
+		}
+
+		entity_slots[e] = slot;
+		slot_entities.push_back(e);
+		parent_slots.push_back(parent_slot);
+		depths.push_back(depth);
+
+		local.px.push_back(0.0f);
+		local.py.push_back(0.0f);
+		local.pz.push_back(0.0f);
+		local.rx.push_back(0.0f);
+		local.ry.push_back(0.0f);
+		local.rz.push_back(0.0f);
+		local.rw.push_back(1.0f);
+		local.sx.push_back(1.0f);
+		local.sy.push_back(1.0f);
+		local.sz.push_back(1.0f);
+		for (auto& column : world)
+		{
+			column.push_back(0.0f);
+		}
+		instances.emplace_back();
+	}
+
+	void scene::destroy(entity e)
+	{
+		if (!is_alive(e))
+		{
+			throw std::runtime_error("can't destroy a dead entity");
+		}
+		if (hierarchy_dirty)
+		{
+			sort_by_depth();
+		}
+
+		// children always sit in later slots than their parents
+		auto count = slot_entities.size();
+		std::vector<bool> keep(count, true);
+		keep[entity_slots[e]] = false;
+		for (size_t slot = entity_slots[e] + 1; slot < count; slot++)
+		{
+			auto parent = parent_slots[slot];
+			if (parent != NO_SLOT && !keep[parent])
+			{
+				keep[slot] = false;
+			}
+		}
+
+		std::vector<uint32_t> new_slots(count, NO_SLOT);
+		uint32_t next_slot = 0;
+		for (size_t slot = 0; slot < count; slot++)
+		{
+			if (keep[slot])
+			{
+				new_slots[slot] = next_slot++;
+			}
+			else
+			{
+				entity_slots[slot_entities[slot]] = NO_SLOT;
+				free_entities.push_back(slot_entities[slot]);
+			}
+		}
+
+		compact(slot_entities, keep);
+		compact(parent_slots, keep);
+		compact(depths, keep);
+		for_each_column(local, world, [&](std::vector<float>& column) { compact(column, keep); });
+		instances.resize(next_slot);
+
+		for (uint32_t slot = 0; slot < next_slot; slot++)
+		{
+			entity_slots[slot_entities[slot]] = slot;
+			if (parent_slots[slot] != NO_SLOT)
+			{
+				parent_slots[slot] = new_slots[parent_slots[slot]];
+			}
+		}
+
+		// removing slots keeps the order, only the level boundaries move
+		depth_starts.clear();
+		for (uint32_t slot = 0; slot < next_slot; slot++)
+		{
+			if (slot == 0 || depths[slot] > depths[slot - 1])
+			{
+				depth_starts.push_back(slot);
+			}
+		}
+	}
+
+	bool scene::is_alive(entity e) const
+	{
+		return e < entity_slots.size() && entity_slots[e] != NO_SLOT;
+	}
+
+	void scene::set_parent(entity e, entity parent)
+	{
+		if (!is_alive(e) || (parent != NO_ENTITY && !is_alive(parent)))
+		{
+			throw std::runtime_error("can't reparent dead entities");
+		}
+
+		auto slot = entity_slots[e];
+		auto parent_slot = parent == NO_ENTITY ? NO_SLOT : entity_slots[parent];
+		for (auto ancestor = parent_slot; ancestor != NO_SLOT; ancestor = parent_slots[ancestor])
+		{
+			if (ancestor == slot)
+			{
+				throw std::runtime_error("can't parent an entity to its own descendant");
+			}
+		}
+
+		if (parent_slots[slot] != parent_slot)
+		{
+			parent_slots[slot] = parent_slot;
+			hierarchy_dirty = true;
+		}
+	}
+
+	auto scene::get_parent(entity e) const -> entity
+	{
+		if (!is_alive(e))
+		{
+			throw std::runtime_error("invalid entity");
+		}
+		auto parent_slot = parent_slots[entity_slots[e]];
+		return parent_slot == NO_SLOT ? NO_ENTITY : slot_entities[parent_slot];
+	}
+
+	void scene::set_position(entity e, glm::vec3 position)
+	{
+		auto slot = get_instance_index(e);
+		local.px[slot] = position.x;
+		local.py[slot] = position.y;
+		local.pz[slot] = position.z;
+	}
+
+	void scene::set_rotation(entity e, glm::quat rotation)
+	{
+		// normalized here once instead of on every update
+		rotation = glm::normalize(rotation);
+		auto slot = get_instance_index(e);
+		local.rx[slot] = rotation.x;
+		local.ry[slot] = rotation.y;
+		local.rz[slot] = rotation.z;
+		local.rw[slot] = rotation.w;
+	}
+
+	void scene::set_scale(entity e, glm::vec3 scale)
+	{
+		auto slot = get_instance_index(e);
+		local.sx[slot] = scale.x;
+		local.sy[slot] = scale.y;
+		local.sz[slot] = scale.z;
+	}
+
+	auto scene::get_position(entity e) const -> glm::vec3
+	{
+		auto slot = get_instance_index(e);
+		return { local.px[slot], local.py[slot], local.pz[slot] };
+	}
+
+	auto scene::get_rotation(entity e) const -> glm::quat
+	{
+		auto slot = get_instance_index(e);
+		return { local.rw[slot], local.rx[slot], local.ry[slot], local.rz[slot] };
+	}
+
+	auto scene::get_scale(entity e) const -> glm::vec3
+	{
+		auto slot = get_instance_index(e);
+		return { local.sx[slot], local.sy[slot], local.sz[slot] };
+	}
+
+	auto scene::get_instance_index(entity e) const -> uint32_t
+	{
+		if (!is_alive(e))
+		{
+			throw std::runtime_error("invalid entity");
+		}
+		return entity_slots[e];
+	}
+
+	auto scene::get_world_matrix(entity e) const -> glm::mat4
+	{
+		auto slot = get_instance_index(e);
+		glm::mat4 matrix{ 1.0f };
+		for (int row = 0; row < 3; row++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				matrix[column][row] = world[row * 4 + column][slot];
+			}
+		}
+		return matrix;
+	}
+
+	void scene::sort_by_depth()
+	{
+		LVK_TRACE_SCOPE("sort scene by depth");
+
+		auto count = slot_entities.size();
+
+		// parents can sit after their children after a reparent, so walk up until a known depth
+		std::fill(depths.begin(), depths.end(), UNKNOWN_DEPTH);
+		std::vector<uint32_t> chain;
+		uint32_t max_depth = 0;
+		for (uint32_t slot = 0; slot < count; slot++)
+		{
+			auto current = slot;
+			while (current != NO_SLOT && depths[current] == UNKNOWN_DEPTH)
+			{
+				chain.push_back(current);
+				current = parent_slots[current];
+			}
+
+			auto depth = current == NO_SLOT ? 0u : depths[current] + 1;
+			for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+			{
+				depths[*it] = depth++;
+			}
+			chain.clear();
+			max_depth = std::max(max_depth, depths[slot]);
+		}
+
+		// stable counting sort by depth
+		std::vector<uint32_t> level_starts(max_depth + 2, 0);
+		for (auto depth : depths)
+		{
+			level_starts[depth + 1]++;
+		}
+		for (size_t level = 1; level < level_starts.size(); level++)
+		{
+			level_starts[level] += level_starts[level - 1];
+		}
+
+		depth_starts.assign(level_starts.begin(), level_starts.end() - 1);
+
+		std::vector<uint32_t> order(count);
+		std::vector<uint32_t> new_slots(count);
+		for (uint32_t slot = 0; slot < count; slot++)
+		{
+			auto new_slot = level_starts[depths[slot]]++;
+			order[new_slot] = slot;
+			new_slots[slot] = new_slot;
+		}
+
+		permute(slot_entities, order);
+		permute(parent_slots, order);
+		permute(depths, order);
+		for_each_column(local, world, [&](std::vector<float>& column) { permute(column, order); });
+
+		for (uint32_t slot = 0; slot < count; slot++)
+		{
+			entity_slots[slot_entities[slot]] = slot;
+			if (parent_slots[slot] != NO_SLOT)
+			{
+				parent_slots[slot] = new_slots[parent_slots[slot]];
+			}
+		}
+
+		hierarchy_dirty = false;
+	}
+
+	void scene::update_transforms(job_system* jobs)
+	{
+		LVK_TRACE_SCOPE("update transforms");
+
+		if (hierarchy_dirty)
+		{
+			sort_by_depth();
+		}
+
+		auto for_each_chunk = [&](size_t begin, size_t end, auto&& f) {
+			if (jobs != nullptr && end - begin > CHUNK_SIZE)
+			{
+				jobs->parallel_for(end - begin, CHUNK_SIZE, [&](size_t chunk_begin, size_t chunk_end) {
+					f(begin + chunk_begin, begin + chunk_end);
+				});
+				return;
+			}
+			for (size_t chunk = begin; chunk < end; chunk += CHUNK_SIZE)
+			{
+				f(chunk, std::min(chunk + CHUNK_SIZE, end));
+			}
+		};
+
+		auto count = slot_entities.size();
+		for_each_chunk(0, count, [this](size_t begin, size_t end) { compute_local_matrices(begin, end); });
+
+		// level 0 are the roots, their world matrix is the local one. every later level only
+		// reads from levels that are already done
+		for (size_t level = 1; level < depth_starts.size(); level++)
+		{
+			auto end = level + 1 < depth_starts.size() ? depth_starts[level + 1] : count;
+			for_each_chunk(depth_starts[level], end, [this](size_t begin, size_t end) { apply_parents(begin, end); });
+		}
+
+		for_each_chunk(0, count, [this](size_t begin, size_t end) { pack_instances(begin, end); });
+	}
+
+	void scene::compute_local_matrices(size_t begin, size_t end)
+	{
+		const float* px = local.px.data();
+		const float* py = local.py.data();
+		const float* pz = local.pz.data();
+		const float* rx = local.rx.data();
+		const float* ry = local.ry.data();
+		const float* rz = local.rz.data();
+		const float* rw = local.rw.data();
+		const float* sx = local.sx.data();
+		const float* sy = local.sy.data();
+		const float* sz = local.sz.data();
+
+		std::array<float*, 12> m;
+		for (size_t i = 0; i < m.size(); i++)
+		{
+			m[i] = world[i].data();
+		}
+
+		// translation * rotation * scale, one plain loop per chunk so it vectorizes across entities
+		for (size_t i = begin; i < end; i++)
+		{
+			float xx = rx[i] * rx[i], yy = ry[i] * ry[i], zz = rz[i] * rz[i];
+			float xy = rx[i] * ry[i], xz = rx[i] * rz[i], yz = ry[i] * rz[i];
+			float wx = rw[i] * rx[i], wy = rw[i] * ry[i], wz = rw[i] * rz[i];
+
+			m[0][i] = (1.0f - 2.0f * (yy + zz)) * sx[i];
+			m[1][i] = 2.0f * (xy - wz) * sy[i];
+			m[2][i] = 2.0f * (xz + wy) * sz[i];
+			m[3][i] = px[i];
+
+			m[4][i] = 2.0f * (xy + wz) * sx[i];
+			m[5][i] = (1.0f - 2.0f * (xx + zz)) * sy[i];
+			m[6][i] = 2.0f * (yz - wx) * sz[i];
+			m[7][i] = py[i];
+
+			m[8][i] = 2.0f * (xz - wy) * sx[i];
+			m[9][i] = 2.0f * (yz + wx) * sy[i];
+			m[10][i] = (1.0f - 2.0f * (xx + yy)) * sz[i];
+			m[11][i] = pz[i];
+		}
+	}
+
+	void scene::apply_parents(size_t begin, size_t end)
+	{
+		const uint32_t* parents = parent_slots.data();
+
+		std::array<float*, 12> m;
+		for (size_t i = 0; i < m.size(); i++)
+		{
+			m[i] = world[i].data();
+		}
+
+		// world = parent world * local, in place since the local matrix is only read by its own slot
+		for (size_t i = begin; i < end; i++)
+		{
+			auto p = parents[i];
+
+			std::array<float, 12> l;
+			for (size_t k = 0; k < 12; k++)
+			{
+				l[k] = m[k][i];
+			}
+
+			for (size_t row = 0; row < 3; row++)
+			{
+				float p0 = m[row * 4 + 0][p], p1 = m[row * 4 + 1][p], p2 = m[row * 4 + 2][p], p3 = m[row * 4 + 3][p];
+				m[row * 4 + 0][i] = p0 * l[0] + p1 * l[4] + p2 * l[8];
+				m[row * 4 + 1][i] = p0 * l[1] + p1 * l[5] + p2 * l[9];
+				m[row * 4 + 2][i] = p0 * l[2] + p1 * l[6] + p2 * l[10];
+				m[row * 4 + 3][i] = p0 * l[3] + p1 * l[7] + p2 * l[11] + p3;
+			}
+		}
+	}
+
+	void scene::pack_instances(size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			for (size_t row = 0; row < 3; row++)
+			{
+				instances[i].rows[row] = glm::vec4{ world[row * 4][i], world[row * 4 + 1][i], world[row * 4 + 2][i], world[row * 4 + 3][i] };
+			}
+		}
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace lvk
+{
+	class job_system;
+
+	using entity = uint32_t;
+	constexpr entity NO_ENTITY = ~0u;
+
+	// world matrix of one instance as the top three rows of the 4x4 (the last row is always
+	// 0 0 0 1), 48 tightly packed bytes. shaders rebuild it with
+	// transpose(mat4(rows[0], rows[1], rows[2], vec4(0, 0, 0, 1)))
+	struct instance_transform
+	{
+		glm::vec4 rows[3];
+	};
+	static_assert(sizeof(instance_transform) == 48);
+
+	// transform hierarchy stored as structure of arrays, every component in its own contiguous
+	// array indexed by a dense slot. slots are kept sorted by depth so parents always come before
+	// their children, which turns hierarchy propagation into one linear pass per depth level.
+	// entity ids stay stable, slots move around whenever the hierarchy changes
+	class scene
+	{
+	public:
+		// slots are processed in chunks of this many, small enough that a chunk's columns
+		// stay in l1 and large enough to be worth handing to a job worker
+		static constexpr size_t CHUNK_SIZE = 1024;
+
+		scene() = default;
+		scene(const scene&) = delete;
+		scene& operator=(const scene&) = delete;
+
+		auto create(entity parent = NO_ENTITY) -> entity;
+		// destroys the whole subtree
+		void destroy(entity e);
+		bool is_alive(entity e) const;
+
+		void set_parent(entity e, entity parent);
+		auto get_parent(entity e) const -> entity;
+
+		void set_position(entity e, glm::vec3 position);
+		void set_rotation(entity e, glm::quat rotation);
+		void set_scale(entity e, glm::vec3 scale);
+		auto get_position(entity e) const -> glm::vec3;
+		auto get_rotation(entity e) const -> glm::quat;
+		auto get_scale(entity e) const -> glm::vec3;
+
+		// recomputes every world matrix and the packed instance array. chunks get spread
+		// over the job workers when a job system is passed in
+		void update_transforms(job_system* jobs = nullptr);
+
+		// only valid after update_transforms
+		auto get_world_matrix(entity e) const -> glm::mat4;
+
+		// one entry per live entity in slot order, ready to be copied into a gpu buffer as is
+		auto get_instances() const -> std::span<const instance_transform>
+		{
+			return instances;
+		}
+		// entity of every instance, same order as get_instances
+		auto get_instance_entities() const -> std::span<const entity>
+		{
+			return slot_entities;
+		}
+		auto get_instance_index(entity e) const -> uint32_t;
+
+		auto size() const -> size_t
+		{
+			return slot_entities.size();
+		}
+
+	private:
+		static constexpr uint32_t NO_SLOT = ~0u;
+
+		// local transform columns, quaternions are stored as x y z w
+		struct transform_columns
+		{
+			std::vector<float> px, py, pz;
+			std::vector<float> rx, ry, rz, rw;
+			std::vector<float> sx, sy, sz;
+		};
+
+		void push_slot(entity e, uint32_t parent_slot);
+		void sort_by_depth();
+		void compute_local_matrices(size_t begin, size_t end);
+		void apply_parents(size_t begin, size_t end);
+		void pack_instances(size_t begin, size_t end);
+
+		// entity -> slot, NO_SLOT for dead ids
+		std::vector<uint32_t> entity_slots;
+		std::vector<entity> free_entities;
+
+		// everything below is indexed by slot
+		std::vector<entity> slot_entities;
+		std::vector<uint32_t> parent_slots;
+		std::vector<uint32_t> depths;
+		transform_columns local;
+		// world matrices, row major 3x4, one column per element
+		std::array<std::vector<float>, 12> world;
+		std::vector<instance_transform> instances;
+
+		// slot ranges of each depth level, valid while the hierarchy isn't dirty
+		std::vector<size_t> depth_starts;
+		bool hierarchy_dirty = false;
+	};
+}
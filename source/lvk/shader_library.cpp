@@ -0,0 +1,42 @@
+#include "shader_library.hpp"
+
+#include "lvk/embedded_shaders.hpp"
+
+#include <filesystem>
+#include <stdexcept>
+
+namespace lvk
+{
+	auto find_embedded_shader(std::string_view name) -> std::span<const uint32_t>
+	{
+		for (const auto& blob : embedded::shaders)
+		{
+			if (blob.name == name)
+			{
+				return blob.words;
+			}
+		}
+		return {};
+	}
+
+	auto map_shader_file(const std::string& path) -> shader_code
+	{
+		return shader_code{ file_view{ path } };
+	}
+
+	auto load_shader(const std::string& path, bool prefer_disk) -> shader_code
+	{
+		if (prefer_disk && std::filesystem::exists(path))
+		{
+			return map_shader_file(path);
+		}
+
+		auto name = std::filesystem::path{ path }.filename().string();
+		if (auto words = find_embedded_shader(name); !words.empty())
+		{
+			return shader_code{ words };
+		}
+
+		return map_shader_file(path);
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "file_view.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace lvk
+{
+	// spir-v words of a single shader, pointing either straight into the blobs embedded
+	// at build time or into a view of the *.spv file on disk. no copies either way
+	class shader_code
+	{
+		std::span<const uint32_t> code;
+		std::optional<file_view> file;
+
+	public:
+		shader_code() = default;
+		explicit shader_code(std::span<const uint32_t> embedded) : code{ embedded } {}
+		explicit shader_code(file_view _file) : file{ std::move(_file) }
+		{
+			// a file_view's data doesn't move along with it, so the span stays valid
+			code = file->as<uint32_t>();
+		}
+
+		auto words() const -> std::span<const uint32_t>
+		{
+			return code;
+		}
+		bool is_embedded() const
+		{
+			return !file.has_value();
+		}
+	};
+
+	// looks a shader up by file name (e.g. "test.vert.spv") among the embedded blobs,
+	// returns an empty span if it wasn't embedded
+	auto find_embedded_shader(std::string_view name) -> std::span<const uint32_t>;
+
+	// maps a *.spv file from disk
+	auto map_shader_file(const std::string& path) -> shader_code;
+
+	// resolves a shader path to its spir-v. the embedded copy wins unless prefer_disk is set,
+	// disk is used as the fallback either way
+	auto load_shader(const std::string& path, bool prefer_disk = false) -> shader_code;
+}
@@ -0,0 +1,142 @@
+#include "shader_watcher.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace lvk
+{
+	namespace
+	{
+		constexpr std::array SHADER_EXTENSIONS = { ".vert", ".frag", ".comp", ".geom", ".tesc", ".tese" };
+
+		// how long to wait for more events before compiling, editors tend to
+		// write the same file several times in a row
+		constexpr int DEBOUNCE_MS = 50;
+		constexpr int POLL_INTERVAL_MS = 100;
+
+		bool is_shader_source(const std::string& name)
+		{
+			return std::any_of(SHADER_EXTENSIONS.begin(), SHADER_EXTENSIONS.end(), [&](const char* ext) {
+				auto ext_size = std::char_traits<char>::length(ext);
+				return name.size() > ext_size && name.compare(name.size() - ext_size, ext_size, ext) == 0;
+			});
+		}
+	}
+
+	shader_watcher::shader_watcher(std::string _source_dir, std::string _binary_dir, std::string _glslc_path)
+		: source_dir{ std::move(_source_dir) }, binary_dir{ std::move(_binary_dir) }, glslc_path{ std::move(_glslc_path) }
+	{
+		worker = std::thread{ [this] { watch(); } };
+	}
+
+	shader_watcher::~shader_watcher()
+	{
+		running = false;
+		if (worker.joinable())
+		{
+			worker.join();
+		}
+	}
+
+	auto shader_watcher::take_changes() -> std::vector<std::string>
+	{
+		std::lock_guard lock{ changes_mutex };
+		return std::exchange(changed_binaries, {});
+	}
+
+	void shader_watcher::watch()
+	{
+		int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (fd < 0)
+		{
+			std::cerr << "shader watcher: inotify_init1 failed, hot reload disabled" << std::endl;
+			return;
+		}
+
+		// most editors save through a temporary file that gets renamed over the original
+		if (inotify_add_watch(fd, source_dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+		{
+			std::cerr << "shader watcher: can't watch " << source_dir << ", hot reload disabled" << std::endl;
+			close(fd);
+			return;
+		}
+
+		std::cout << "shader watcher: watching " << source_dir << std::endl;
+
+		alignas(inotify_event) std::array<char, 4096> buffer{};
+		std::set<std::string> pending;
+
+		while (running)
+		{
+			pollfd pfd{ .fd = fd, .events = POLLIN };
+			int timeout = pending.empty() ? POLL_INTERVAL_MS : DEBOUNCE_MS;
+
+			if (poll(&pfd, 1, timeout) > 0 && (pfd.revents & POLLIN))
+			{
+				ssize_t length;
+				while ((length = read(fd, buffer.data(), buffer.size())) > 0)
+				{
+					for (ssize_t offset = 0; offset < length;)
+					{
+						auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+						if (event->len > 0 && is_shader_source(event->name))
+						{
+							pending.insert(event->name);
+						}
+						offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+					}
+				}
+				continue;
+			}
+
+			// quiet for a whole debounce interval, so compile everything that piled up
+			for (const auto& shader_name : pending)
+			{
+				if (compile(shader_name))
+				{
+					std::lock_guard lock{ changes_mutex };
+					changed_binaries.push_back(binary_dir + "/" + shader_name + ".spv");
+				}
+			}
+			pending.clear();
+		}
+
+		close(fd);
+	}
+
+	bool shader_watcher::compile(const std::string& shader_name)
+	{
+		auto source = source_dir + "/" + shader_name;
+		auto binary = binary_dir + "/" + shader_name + ".spv";
+		auto temporary = binary + ".tmp";
+
+		// compile next to the target first so a failed or half written
+		// compile never replaces a working binary
+		auto command = "\"" + glslc_path + "\" \"" + source + "\" -o \"" + temporary + "\"";
+		if (std::system(command.c_str()) != 0)
+		{
+			std::cerr << "shader watcher: failed to compile " << source << std::endl;
+			std::remove(temporary.c_str());
+			return false;
+		}
+
+		if (std::rename(temporary.c_str(), binary.c_str()) != 0)
+		{
+			std::cerr << "shader watcher: failed to replace " << binary << std::endl;
+			return false;
+		}
+
+		std::cout << "shader watcher: recompiled " << shader_name << std::endl;
+		return true;
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lvk
+{
+	// development helper: watches a directory of glsl sources with inotify and recompiles
+	// changed files with glslc on a background thread. the resulting *.spv paths are
+	// collected until the render loop picks them up at a frame boundary via take_changes()
+	class shader_watcher
+	{
+		std::string source_dir, binary_dir, glslc_path;
+
+		std::thread worker;
+		std::atomic<bool> running{ true };
+
+		std::mutex changes_mutex;
+		std::vector<std::string> changed_binaries;
+
+		void watch();
+		bool compile(const std::string& shader_name);
+
+	public:
+		shader_watcher(std::string _source_dir, std::string _binary_dir, std::string _glslc_path);
+		~shader_watcher();
+
+		shader_watcher(const shader_watcher&) = delete;
+		shader_watcher& operator=(const shader_watcher&) = delete;
+
+		// returns the spv files that were rebuilt since the last call
+		auto take_changes() -> std::vector<std::string>;
+	};
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace lvk
+{
+	// bounded lock-free queue for exactly one producer thread and one consumer thread.
+	// push and pop never block or allocate. each index is only ever written by its own side,
+	// and each side keeps a cached copy of the other index so it only touches the other
+	// side's cache line when the queue looks full (or empty)
+	template<typename T, size_t CAPACITY>
+	class spsc_queue
+	{
+		static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity has to be a power of two");
+
+		static constexpr size_t CACHE_LINE = 64;
+		static constexpr size_t MASK = CAPACITY - 1;
+
+		// consumer side, head is the next slot to pop
+		alignas(CACHE_LINE) std::atomic<size_t> head{ 0 };
+		size_t cached_tail = 0;
+
+		// producer side, tail is the next slot to push
+		alignas(CACHE_LINE) std::atomic<size_t> tail{ 0 };
+		size_t cached_head = 0;
+
+		alignas(CACHE_LINE) std::array<T, CAPACITY> slots{};
+
+	public:
+		spsc_queue() = default;
+		spsc_queue(const spsc_queue&) = delete;
+		spsc_queue& operator=(const spsc_queue&) = delete;
+
+		// producer only, returns false if the queue is full
+		bool try_push(const T& value)
+		{
+			auto current_tail = tail.load(std::memory_order_relaxed);
+			if (current_tail - cached_head == CAPACITY)
+			{
+				cached_head = head.load(std::memory_order_acquire);
+				if (current_tail - cached_head == CAPACITY)
+				{
+					return false;
+				}
+			}
+
+			slots[current_tail & MASK] = value;
+			tail.store(current_tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer only, returns false if the queue is empty
+		bool try_pop(T& value)
+		{
+			auto current_head = head.load(std::memory_order_relaxed);
+			if (current_head == cached_tail)
+			{
+				cached_tail = tail.load(std::memory_order_acquire);
+				if (current_head == cached_tail)
+				{
+					return false;
+				}
+			}
+
+			value = std::move(slots[current_head & MASK]);
+			head.store(current_head + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer only, pops everything and keeps the newest element. returns false if the queue was empty
+		bool try_pop_latest(T& value)
+		{
+			bool popped = false;
+			while (try_pop(value))
+			{
+				popped = true;
+			}
+			return popped;
+		}
+
+		static constexpr auto capacity() -> size_t
+		{
+			return CAPACITY;
+		}
+	};
+}
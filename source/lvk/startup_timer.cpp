@@ -0,0 +1,73 @@
+#include "startup_timer.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+namespace lvk
+{
+	namespace
+	{
+		using clock = std::chrono::steady_clock;
+
+		struct phase_record
+		{
+			const char* name;
+			clock::duration duration;
+		};
+
+		// startup is single threaded, so no locking here
+		std::vector<phase_record> phases;
+		std::optional<clock::time_point> first_start;
+
+		auto to_ms(clock::duration duration) -> double
+		{
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+	}
+
+	startup_phase::startup_phase(const char* _name) : name{ _name }, start{ clock::now() }
+	{
+		if (!first_start)
+		{
+			first_start = start;
+		}
+	}
+
+	startup_phase::~startup_phase()
+	{
+		phases.push_back({ name, clock::now() - start });
+	}
+
+	void startup_phase::report()
+	{
+		if (!first_start)
+		{
+			return;
+		}
+
+		auto total_ms = to_ms(clock::now() - *first_start);
+
+		std::cout << "startup:" << std::fixed << std::setprecision(2) << '\n';
+		for (const auto& phase : phases)
+		{
+			std::cout << '\t' << std::left << std::setw(16) << phase.name
+					  << std::right << std::setw(9) << to_ms(phase.duration) << " ms\n";
+		}
+		std::cout << '\t' << std::left << std::setw(16) << "total"
+				  << std::right << std::setw(9) << total_ms << " ms" << std::endl;
+		std::cout << std::defaultfloat;
+
+		if (const char* budget = std::getenv("LVK_STARTUP_BUDGET_MS"))
+		{
+			auto budget_ms = std::atof(budget);
+			if (budget_ms > 0.0 && total_ms > budget_ms)
+			{
+				std::cerr << "startup took " << total_ms << " ms, over the budget of " << budget_ms << " ms"
+						  << std::endl;
+			}
+		}
+	}
+}
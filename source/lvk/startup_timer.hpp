@@ -0,0 +1,26 @@
+#pragma once
+
+#include <chrono>
+
+namespace lvk
+{
+	// times one phase of startup (instance creation, device pick, ...) from construction
+	// to destruction. phases are collected globally, since they're spread over the
+	// constructors of several wrappers, and printed as a breakdown by report()
+	class startup_phase
+	{
+		const char* name;
+		std::chrono::steady_clock::time_point start;
+
+	public:
+		explicit startup_phase(const char* _name);
+		~startup_phase();
+
+		startup_phase(const startup_phase&) = delete;
+		startup_phase& operator=(const startup_phase&) = delete;
+
+		// prints every phase recorded so far plus the total time since the first one started.
+		// if LVK_STARTUP_BUDGET_MS is set, startups over that budget are flagged
+		static void report();
+	};
+}
@@ -0,0 +1,17 @@
+#include "surface_wrp.hpp"
+#include "startup_timer.hpp"
+
+namespace lvk
+{
+	surface_wrp::surface_wrp(instance_wrp& _instance, window_wrp& _window)
+		: instance{ _instance }, window{ _window }
+	{
+		startup_phase phase{ "surface" };
+		window.create_window_surface(instance.get_instance(), &surface);
+	}
+
+	surface_wrp::~surface_wrp()
+	{
+		vkDestroySurfaceKHR(instance.get_instance(), surface, nullptr);
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "instance_wrp.hpp"
+#include "window_wrp.hpp"
+
+namespace lvk
+{
+	// presentation surface of a single window, swap chains get created on top of it
+	class surface_wrp
+	{
+		instance_wrp& instance;
+		window_wrp& window;
+		VkSurfaceKHR surface;
+
+	public:
+		surface_wrp(instance_wrp& _instance, window_wrp& _window);
+		~surface_wrp();
+
+		surface_wrp(const surface_wrp&) = delete;
+		surface_wrp& operator=(const surface_wrp&) = delete;
+
+		VkSurfaceKHR get_surface()
+		{
+			return surface;
+		}
+		window_wrp& get_window()
+		{
+			return window;
+		}
+	};
+}
@@ -1,5 +1,8 @@
 #include "swap_chain_wrp.hpp"
+#include "startup_timer.hpp"
+#include "trace.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <cstring>
@@ -10,63 +13,106 @@
 
 namespace lvk
 {
-  swap_chain_wrp::swap_chain_wrp(device_wrp &deviceRef, VkExtent2D extent)
-      : device{deviceRef}, window_extent{extent}
+  swap_chain_wrp::swap_chain_wrp(device_wrp &deviceRef, surface_wrp &surfaceRef)
+      : device{deviceRef}, surface{surfaceRef}, window_extent{surfaceRef.get_window().get_extent()}
   {
+    startup_phase phase{"swapchain"};
+
+    depth_format = find_depth_format();
+    dynamic_rendering = device.get_optional_features().dynamic_rendering;
+    if (dynamic_rendering)
+    {
+      cmd_begin_rendering =
+          (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(device.get_device(), "vkCmdBeginRenderingKHR");
+      cmd_end_rendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(device.get_device(), "vkCmdEndRenderingKHR");
+    }
+
     create_swap_chain();
     create_image_views();
-    create_render_pass();
+    if (!dynamic_rendering)
+    {
+      create_render_passes();
+    }
     create_depth_resources();
-    create_framebuffers();
+    if (!dynamic_rendering)
+    {
+      create_framebuffers();
+    }
     create_sync_objects();
   }
 
   swap_chain_wrp::~swap_chain_wrp()
   {
-    for (auto imageView : swap_chain_image_views)
+    for (auto depth_image : depth_images)
     {
-      vkDestroyImageView(device.get_device(), imageView, nullptr);
+      device.get_resources().destroy(depth_image);
     }
-    swap_chain_image_views.clear();
-
-    if (swap_chain != nullptr)
+    for (auto image : swap_chain_images)
     {
-      vkDestroySwapchainKHR(device.get_device(), swap_chain, nullptr);
-      swap_chain = nullptr;
+      device.get_barriers().forget(image);
     }
 
-    for (int i = 0; i < depth_images.size(); i++)
-    {
-      vkDestroyImageView(device.get_device(), depth_image_views[i], nullptr);
-      vkDestroyImage(device.get_device(), depth_images[i], nullptr);
-      vkFreeMemory(device.get_device(), depth_image_memorys[i], nullptr);
-    }
+    // the last frames can still be in flight, so everything goes through the deletion queue.
+    // the surface has to outlive that, see app::~app
+    device.get_deletion_queue().defer(
+        [&device = device,
+         swap_chain = swap_chain,
+         image_views = std::move(swap_chain_image_views),
+         framebuffers = std::move(swap_chain_framebuffers),
+         render_passes = std::array{render_pass, early_render_pass, late_render_pass},
+         render_finished_semaphores = std::move(render_finished_semaphores),
+         image_available_semaphores = std::move(image_available_semaphores),
+         in_flight_fences = std::move(in_flight_fences)]
+        {
+          for (auto imageView : image_views)
+          {
+            vkDestroyImageView(device.get_device(), imageView, nullptr);
+          }
+
+          if (swap_chain != nullptr)
+          {
+            vkDestroySwapchainKHR(device.get_device(), swap_chain, nullptr);
+          }
+
+          for (auto framebuffer : framebuffers)
+          {
+            vkDestroyFramebuffer(device.get_device(), framebuffer, nullptr);
+          }
+
+          for (auto render_pass : render_passes)
+          {
+            vkDestroyRenderPass(device.get_device(), render_pass, nullptr);
+          }
+
+          // cleanup synchronization objects
+          for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+          {
+            vkDestroySemaphore(device.get_device(), render_finished_semaphores[i], nullptr);
+            vkDestroySemaphore(device.get_device(), image_available_semaphores[i], nullptr);
+            vkDestroyFence(device.get_device(), in_flight_fences[i], nullptr);
+          }
+        });
+  }
 
-    for (auto framebuffer : swap_chain_framebuffers)
+  VkResult swap_chain_wrp::acquire_next_image(uint32_t *image_index)
+  {
     {
-      vkDestroyFramebuffer(device.get_device(), framebuffer, nullptr);
+      LVK_TRACE_SCOPE("wait frame fence");
+      vkWaitForFences(
+          device.get_device(),
+          1,
+          &in_flight_fences[current_frame],
+          VK_TRUE,
+          std::numeric_limits<uint64_t>::max());
     }
-
-    vkDestroyRenderPass(device.get_device(), render_pass, nullptr);
-
-    // cleanup synchronization objects
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    // the fence gets reset by the next submit, so the deletion queue has to hear about it now
+    if (frame_submissions[current_frame] != 0)
     {
-      vkDestroySemaphore(device.get_device(), render_finished_semaphores[i], nullptr);
-      vkDestroySemaphore(device.get_device(), image_available_semaphores[i], nullptr);
-      vkDestroyFence(device.get_device(), in_flight_fences[i], nullptr);
+      device.get_deletion_queue().retired(frame_submissions[current_frame]);
+      frame_submissions[current_frame] = 0;
     }
-  }
-
-  VkResult swap_chain_wrp::acquire_next_image(uint32_t *image_index)
-  {
-    vkWaitForFences(
-        device.get_device(),
-        1,
-        &in_flight_fences[current_frame],
-        VK_TRUE,
-        std::numeric_limits<uint64_t>::max());
 
+    LVK_TRACE_SCOPE("acquire next image");
     VkResult result = vkAcquireNextImageKHR(
         device.get_device(),
         swap_chain,
@@ -78,11 +124,30 @@ namespace lvk
     return result;
   }
 
-  VkResult swap_chain_wrp::submit_command_buffers(
+  void swap_chain_wrp::wait_for_frames_in_flight()
+  {
+    vkWaitForFences(
+        device.get_device(),
+        static_cast<uint32_t>(in_flight_fences.size()),
+        in_flight_fences.data(),
+        VK_TRUE,
+        std::numeric_limits<uint64_t>::max());
+    for (auto &submission : frame_submissions)
+    {
+      if (submission != 0)
+      {
+        device.get_deletion_queue().retired(submission);
+        submission = 0;
+      }
+    }
+  }
+
+  void swap_chain_wrp::submit_command_buffers(
       const VkCommandBuffer *buffers, uint32_t *image_index)
   {
     if (images_in_flight[*image_index] != VK_NULL_HANDLE)
     {
+      LVK_TRACE_SCOPE("wait image fence");
       vkWaitForFences(device.get_device(), 1, &images_in_flight[*image_index], VK_TRUE, UINT64_MAX);
     }
     images_in_flight[*image_index] = in_flight_fences[current_frame];
@@ -104,34 +169,221 @@ namespace lvk
     submit_info.pSignalSemaphores = signalSemaphores;
 
     vkResetFences(device.get_device(), 1, &in_flight_fences[current_frame]);
-    if (vkQueueSubmit(device.get_graphics_queue(), 1, &submit_info, in_flight_fences[current_frame]) !=
-        VK_SUCCESS)
     {
-      throw std::runtime_error("failed to submit draw command buffer!");
+      LVK_TRACE_SCOPE("queue submit");
+      if (vkQueueSubmit(device.get_graphics_queue(), 1, &submit_info, in_flight_fences[current_frame]) !=
+          VK_SUCCESS)
+      {
+        throw std::runtime_error("failed to submit draw command buffer!");
+      }
     }
 
+    frame_submissions[current_frame] = device.get_deletion_queue().submitted(in_flight_fences[current_frame]);
+
+    // the present waits on this, whenever it gets batched
+    present_wait_semaphore = render_finished_semaphores[current_frame];
+    last_submit_fence = in_flight_fences[current_frame];
+    current_frame = (current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+  }
+
+  VkResult swap_chain_wrp::present(uint32_t *image_index)
+  {
+    present_batch batch;
+    batch.add(*this, *image_index);
+    return batch.present(device.get_present_queue());
+  }
+
+  void swap_chain_wrp::begin_rendering(
+      VkCommandBuffer command_buffer, uint32_t image_index, render_pass_part part, VkClearColorValue clear_color)
+  {
+    auto &barriers = device.get_barriers();
+
+    // ignored by the parts that load instead of clearing
+    std::array<VkClearValue, 2> clear_values = {};
+    clear_values[0].color = clear_color;
+    clear_values[1].depthStencil = {1.0f, 0};
+
+    if (!dynamic_rendering)
+    {
+      // the render pass does its own transitions, only what's pending for others has to go first
+      barriers.flush(command_buffer);
+
+      VkRenderPassBeginInfo render_pass_info = {};
+      render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+      render_pass_info.renderPass = get_render_pass(part);
+      render_pass_info.framebuffer = swap_chain_framebuffers[image_index];
+      render_pass_info.renderArea = {{0, 0}, swap_chain_extent};
+      render_pass_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
+      render_pass_info.pClearValues = clear_values.data();
+      vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+      return;
+    }
+
+    auto attachments = describe_attachments(part);
+    auto *depth = device.get_resources().get(depth_images[image_index]);
+
+    // the image was only just acquired, and its semaphore is waited on at the color output stage.
+    // the depth image carries over whatever the previous frame's passes and depth pyramid did
+    if (part != render_pass_part::late)
+    {
+      barriers.assume(
+          swap_chain_images[image_index],
+          {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR, VK_ACCESS_2_NONE_KHR, VK_IMAGE_LAYOUT_UNDEFINED});
+    }
+    barriers.use(
+        swap_chain_images[image_index],
+        {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+        {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+         VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT_KHR | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR,
+         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+    barriers.use(
+        depth->image,
+        get_depth_range(),
+        {VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT_KHR | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT_KHR,
+         VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT_KHR | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR,
+         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL});
+    barriers.flush(command_buffer);
+
+    VkRenderingAttachmentInfoKHR color_attachment = {};
+    color_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    color_attachment.imageView = swap_chain_image_views[image_index];
+    color_attachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    color_attachment.loadOp = attachments[0].loadOp;
+    color_attachment.storeOp = attachments[0].storeOp;
+    color_attachment.clearValue = clear_values[0];
+
+    VkRenderingAttachmentInfoKHR depth_attachment = {};
+    depth_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    depth_attachment.imageView = depth->view;
+    depth_attachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depth_attachment.loadOp = attachments[1].loadOp;
+    depth_attachment.storeOp = attachments[1].storeOp;
+    depth_attachment.clearValue = clear_values[1];
+
+    VkRenderingInfoKHR rendering_info = {};
+    rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    rendering_info.renderArea = {{0, 0}, swap_chain_extent};
+    rendering_info.layerCount = 1;
+    rendering_info.colorAttachmentCount = 1;
+    rendering_info.pColorAttachments = &color_attachment;
+    rendering_info.pDepthAttachment = &depth_attachment;
+    cmd_begin_rendering(command_buffer, &rendering_info);
+  }
+
+  void swap_chain_wrp::end_rendering(VkCommandBuffer command_buffer, uint32_t image_index, render_pass_part part)
+  {
+    if (dynamic_rendering)
+    {
+      // the attachments stay as they are, whoever uses them next asks for what they need
+      cmd_end_rendering(command_buffer);
+      return;
+    }
+
+    vkCmdEndRenderPass(command_buffer);
+
+    // the render pass left both in its final layouts, written at the attachment stages
+    auto attachments = describe_attachments(part);
+    auto &barriers = device.get_barriers();
+    barriers.assume(
+        swap_chain_images[image_index],
+        {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+         VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR,
+         attachments[0].finalLayout});
+    barriers.assume(
+        device.get_resources().get(depth_images[image_index])->image,
+        {VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT_KHR | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT_KHR,
+         VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR,
+         attachments[1].finalLayout});
+  }
+
+  void swap_chain_wrp::prepare_present(VkCommandBuffer command_buffer, uint32_t image_index)
+  {
+    // presenting synchronizes through the render finished semaphore, so nothing to wait for here
+    auto &barriers = device.get_barriers();
+    barriers.use(
+        swap_chain_images[image_index],
+        {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+        {VK_PIPELINE_STAGE_2_NONE_KHR, VK_ACCESS_2_NONE_KHR, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR});
+    barriers.flush(command_buffer);
+  }
+
+  VkRenderPass swap_chain_wrp::get_render_pass(render_pass_part part)
+  {
+    switch (part)
+    {
+    case render_pass_part::early:
+      return early_render_pass;
+    case render_pass_part::late:
+      return late_render_pass;
+    default:
+      return render_pass;
+    }
+  }
+
+  VkImageAspectFlags swap_chain_wrp::depth_aspect()
+  {
+    // layout transitions of combined depth stencil formats have to cover both aspects
+    return depth_format == VK_FORMAT_D32_SFLOAT || depth_format == VK_FORMAT_D16_UNORM
+               ? VK_IMAGE_ASPECT_DEPTH_BIT
+               : VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+  }
+
+  void present_batch::add(swap_chain_wrp &swap_chain, uint32_t image_index, uint64_t present_id)
+  {
+    swap_chains.push_back(swap_chain.get_swap_chain());
+    image_indices.push_back(image_index);
+    wait_semaphores.push_back(swap_chain.get_present_wait_semaphore());
+    present_ids.push_back(present_id);
+  }
+
+  VkResult present_batch::present(VkQueue present_queue)
+  {
+    results.assign(swap_chains.size(), VK_SUCCESS);
+
     VkPresentInfoKHR present_info = {};
     present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
-    present_info.waitSemaphoreCount = 1;
-    present_info.pWaitSemaphores = signalSemaphores;
+    present_info.waitSemaphoreCount = static_cast<uint32_t>(wait_semaphores.size());
+    present_info.pWaitSemaphores = wait_semaphores.data();
 
-    VkSwapchainKHR swap_chains[] = {swap_chain};
-    present_info.swapchainCount = 1;
-    present_info.pSwapchains = swap_chains;
+    present_info.swapchainCount = static_cast<uint32_t>(swap_chains.size());
+    present_info.pSwapchains = swap_chains.data();
+    present_info.pImageIndices = image_indices.data();
+    present_info.pResults = results.data();
 
-    present_info.pImageIndices = image_index;
+    // ids of 0 don't identify anything, so the extension struct is only needed if some are set
+    VkPresentIdKHR present_id_info = {};
+    present_id_info.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+    if (std::any_of(present_ids.begin(), present_ids.end(), [](uint64_t id) { return id != 0; }))
+    {
+      present_id_info.swapchainCount = static_cast<uint32_t>(present_ids.size());
+      present_id_info.pPresentIds = present_ids.data();
+      present_info.pNext = &present_id_info;
+    }
 
-    auto result = vkQueuePresentKHR(device.get_present_queue(), &present_info);
+    VkResult result;
+    {
+      LVK_TRACE_SCOPE("queue present");
+      result = vkQueuePresentKHR(present_queue, &present_info);
+    }
 
-    current_frame = (current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+    swap_chains.clear();
+    image_indices.clear();
+    wait_semaphores.clear();
+    present_ids.clear();
 
     return result;
   }
 
   void swap_chain_wrp::create_swap_chain()
   {
-    swap_chain_support_details swap_chain_support = device.get_swap_chain_support();
+    // the device was picked for another surface, so this one isn't necessarily presentable
+    if (!device.supports_present(surface.get_surface()))
+    {
+      throw std::runtime_error("the present queue can't present to this surface");
+    }
+
+    swap_chain_support_details swap_chain_support = device.get_swap_chain_support(surface.get_surface());
 
     VkSurfaceFormatKHR surface_format = choose_swap_surface_format(swap_chain_support.formats);
     VkPresentModeKHR present_mode = choose_swap_present_mode(swap_chain_support.present_modes);
@@ -146,7 +398,7 @@ namespace lvk
 
     auto create_info = VkSwapchainCreateInfoKHR{
 		.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-		.surface = device.get_surface(),
+		.surface = surface.get_surface(),
 		.minImageCount = image_count,
 		.imageFormat = surface_format.format,
 		.imageColorSpace = surface_format.colorSpace,
@@ -155,6 +407,13 @@ namespace lvk
 		.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
 	};
 
+    // being able to copy out of the swap chain images is what makes frame readback possible
+    if (swap_chain_support.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+    {
+      create_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+      transfer_src_supported = true;
+    }
+
     queue_family_indices indices = device.find_physical_queue_families();
     uint32_t queueFamilyIndices[] = {indices.graphics_family, indices.present_family};
 
@@ -224,31 +483,52 @@ namespace lvk
     }
   }
 
-  void swap_chain_wrp::create_render_pass()
+  void swap_chain_wrp::create_render_passes()
+  {
+    render_pass = create_render_pass(render_pass_part::whole);
+    early_render_pass = create_render_pass(render_pass_part::early);
+    late_render_pass = create_render_pass(render_pass_part::late);
+  }
+
+  std::array<VkAttachmentDescription, 2> swap_chain_wrp::describe_attachments(render_pass_part part)
   {
+    bool early = part == render_pass_part::early;
+    bool late = part == render_pass_part::late;
+
     VkAttachmentDescription depthAttachment{};
-    depthAttachment.format = find_depth_format();
+    depthAttachment.format = depth_format;
     depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.loadOp = late ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+    // the early pass' depth is what the depth pyramid gets built from
+    depthAttachment.storeOp = early ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
     depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    VkAttachmentReference depthAttachmentRef{};
-    depthAttachmentRef.attachment = 1;
-    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.initialLayout =
+        late ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.finalLayout =
+        early ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
     VkAttachmentDescription colorAttachment = {};
     colorAttachment.format = get_swap_chain_image_format();
     colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.loadOp = late ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
     colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.initialLayout = late ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout = early ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    return {colorAttachment, depthAttachment};
+  }
+
+  VkRenderPass swap_chain_wrp::create_render_pass(render_pass_part part)
+  {
+    bool early = part == render_pass_part::early;
+    bool late = part == render_pass_part::late;
+
+    VkAttachmentReference depthAttachmentRef{};
+    depthAttachmentRef.attachment = 1;
+    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
     VkAttachmentReference colorAttachmentRef = {};
     colorAttachmentRef.attachment = 0;
@@ -270,21 +550,56 @@ namespace lvk
         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
     dependency.dstAccessMask =
         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    if (part != render_pass_part::whole)
+    {
+      // the depth pyramid of an earlier frame may still be reading this depth image
+      dependency.srcStageMask |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    }
+    if (late)
+    {
+      // carries on with what the early pass wrote
+      dependency.srcStageMask |= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+      dependency.srcAccessMask =
+          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+      dependency.dstAccessMask |=
+          VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+    }
+
+    // makes the color writes and the final layout transition visible to transfers recorded after
+    // the render pass, e.g. frame readback copies. without any such copies this costs nothing
+    VkSubpassDependency readbackDependency = {};
+    readbackDependency.srcSubpass = 0;
+    readbackDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    readbackDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    readbackDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+    readbackDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    readbackDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    if (early)
+    {
+      // the early pass ends in the depth pyramid build instead
+      readbackDependency.srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+      readbackDependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+      readbackDependency.dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+      readbackDependency.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    }
 
-    std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
+    std::array<VkSubpassDependency, 2> dependencies = {dependency, readbackDependency};
+    auto attachments = describe_attachments(part);
     VkRenderPassCreateInfo renderPassInfo = {};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
     renderPassInfo.pAttachments = attachments.data();
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
+    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    renderPassInfo.pDependencies = dependencies.data();
 
-    if (vkCreateRenderPass(device.get_device(), &renderPassInfo, nullptr, &render_pass) != VK_SUCCESS)
+    VkRenderPass created;
+    if (vkCreateRenderPass(device.get_device(), &renderPassInfo, nullptr, &created) != VK_SUCCESS)
     {
       throw std::runtime_error("failed to create render pass!");
     }
+    return created;
   }
 
   void swap_chain_wrp::create_framebuffers()
@@ -292,7 +607,7 @@ namespace lvk
     swap_chain_framebuffers.resize(image_count());
     for (size_t i = 0; i < image_count(); i++)
     {
-      std::array<VkImageView, 2> attachments = {swap_chain_image_views[i], depth_image_views[i]};
+      std::array<VkImageView, 2> attachments = {swap_chain_image_views[i], device.get_resources().get(depth_images[i])->view};
 
       VkExtent2D swap_chain_extent = get_swap_chain_extent();
       VkFramebufferCreateInfo framebufferInfo = {};
@@ -317,12 +632,9 @@ namespace lvk
 
   void swap_chain_wrp::create_depth_resources()
   {
-    VkFormat depthFormat = find_depth_format();
     VkExtent2D swapChainExtent = get_swap_chain_extent();
 
     depth_images.resize(image_count());
-    depth_image_memorys.resize(image_count());
-    depth_image_views.resize(image_count());
 
     for (int i = 0; i < depth_images.size(); i++)
     {
@@ -334,35 +646,21 @@ namespace lvk
       imageInfo.extent.depth = 1;
       imageInfo.mipLevels = 1;
       imageInfo.arrayLayers = 1;
-      imageInfo.format = depthFormat;
+      imageInfo.format = depth_format;
       imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
       imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-      imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+      // sampled for the occlusion culling depth pyramid
+      imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
       imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
       imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
       imageInfo.flags = 0;
 
-      device.createImageWithInfo(
-          imageInfo,
-          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-          depth_images[i],
-          depth_image_memorys[i]);
-
-      VkImageViewCreateInfo viewInfo{};
-      viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-      viewInfo.image = depth_images[i];
-      viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-      viewInfo.format = depthFormat;
-      viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-      viewInfo.subresourceRange.baseMipLevel = 0;
-      viewInfo.subresourceRange.levelCount = 1;
-      viewInfo.subresourceRange.baseArrayLayer = 0;
-      viewInfo.subresourceRange.layerCount = 1;
-
-      if (vkCreateImageView(device.get_device(), &viewInfo, nullptr, &depth_image_views[i]) != VK_SUCCESS)
-      {
-        throw std::runtime_error("failed to create texture image view!");
-      }
+      depth_images[i] = device.get_resources().create_image({
+          .info = imageInfo,
+          .memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+          .category = memory_category::depth,
+          .view_aspect = VK_IMAGE_ASPECT_DEPTH_BIT,
+      });
     }
   }
 
@@ -371,6 +669,7 @@ namespace lvk
     image_available_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
     render_finished_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
     in_flight_fences.resize(MAX_FRAMES_IN_FLIGHT);
+    frame_submissions.resize(MAX_FRAMES_IN_FLIGHT, 0);
     images_in_flight.resize(image_count(), VK_NULL_HANDLE);
 
     VkSemaphoreCreateInfo semaphore_info = {};
@@ -454,8 +753,9 @@ namespace lvk
   VkFormat swap_chain_wrp::find_depth_format()
   {
     return device.find_supported_format(
-        {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
+        // d16 is the only one guaranteed to be sampleable as well, it's only the last resort
+        {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D16_UNORM},
         VK_IMAGE_TILING_OPTIMAL,
-        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
   }
 }
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "device_wrp.hpp"
+#include "surface_wrp.hpp"
 
 #include <vulkan/vulkan.h>
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -14,16 +16,45 @@ namespace lvk
   public:
     static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 
-    swap_chain_wrp(device_wrp &device_ref, VkExtent2D window_extent);
+    // a frame is either drawn in one go or split in two around occlusion culling, see occlusion_culler.
+    // the early part clears and leaves the depth readable by compute, the late one picks up where
+    // it stopped and presents
+    enum class render_pass_part
+    {
+      whole,
+      early,
+      late,
+    };
+
+    swap_chain_wrp(device_wrp &device_ref, surface_wrp &surface_ref);
     ~swap_chain_wrp();
 
     swap_chain_wrp(const swap_chain_wrp &) = delete;
     void operator=(const swap_chain_wrp &) = delete;
 
+    // with VK_KHR_dynamic_rendering there are no render passes or framebuffers, these return null
+    // and pipelines get built for get_swap_chain_image_format and get_depth_format instead
+    bool uses_dynamic_rendering() { return dynamic_rendering; }
     VkFramebuffer get_frame_buffer(int index) { return swap_chain_framebuffers[index]; }
+    // the early and late parts' render passes are compatible with this one, so framebuffers and
+    // pipelines work with all of them
     VkRenderPass get_render_pass() { return render_pass; }
     VkImageView get_image_view(int index) { return swap_chain_image_views[index]; }
+    VkImage get_image(int index) { return swap_chain_images[index]; }
+    image_handle get_depth_image(int index) { return depth_images[index]; }
+    // what barriers on a depth image have to cover, see barrier_batch
+    VkImageSubresourceRange get_depth_range() { return {depth_aspect(), 0, 1, 0, 1}; }
+    VkSwapchainKHR get_swap_chain() { return swap_chain; }
+    // signaled once the last submitted frame finished rendering
+    VkSemaphore get_present_wait_semaphore() { return present_wait_semaphore; }
+    // signaled once the gpu is done with the last submitted frame
+    VkFence get_last_submit_fence() { return last_submit_fence; }
+    // fence of the last submission that rendered to the given image
+    VkFence get_image_fence(int index) { return images_in_flight[index]; }
+    bool supports_transfer_src() { return transfer_src_supported; }
     size_t image_count() { return swap_chain_images.size(); }
+    // index of the frame in flight the next submit belongs to, its resources are free once acquire_next_image returns
+    size_t get_current_frame() { return current_frame; }
     VkFormat get_swap_chain_image_format() { return swap_chain_image_format; }
     VkExtent2D get_swap_chain_extent() { return swap_chain_extent; }
     uint32_t width() { return swap_chain_extent.width; }
@@ -33,16 +64,36 @@ namespace lvk
     {
       return static_cast<float>(swap_chain_extent.width) / static_cast<float>(swap_chain_extent.height);
     }
+    VkFormat get_depth_format() { return depth_format; }
     VkFormat find_depth_format();
 
+    // starts drawing into the image through the part's render pass, or with dynamic rendering
+    // and the barriers that stand in for its layout transitions and dependencies. both go through
+    // the device's barrier_batch, so whatever else is pending gets recorded along with them
+    void begin_rendering(
+        VkCommandBuffer command_buffer, uint32_t image_index, render_pass_part part, VkClearColorValue clear_color);
+    void end_rendering(VkCommandBuffer command_buffer, uint32_t image_index, render_pass_part part);
+    // last thing in a frame's command buffer, moves the image to the present layout if it isn't yet
+    void prepare_present(VkCommandBuffer command_buffer, uint32_t image_index);
+
     VkResult acquire_next_image(uint32_t *image_index);
-    VkResult submit_command_buffers(const VkCommandBuffer *buffers, uint32_t *image_index);
+    // blocks until every submitted frame has finished executing on the gpu
+    void wait_for_frames_in_flight();
+    // submits without presenting, so several swap chains can be presented together through a present_batch
+    void submit_command_buffers(const VkCommandBuffer *buffers, uint32_t *image_index);
+    // presents just this swap chain
+    VkResult present(uint32_t *image_index);
 
   private:
     void create_swap_chain();
     void create_image_views();
     void create_depth_resources();
-    void create_render_pass();
+    void create_render_passes();
+    VkRenderPass create_render_pass(render_pass_part part);
+    VkRenderPass get_render_pass(render_pass_part part);
+    // color then depth, shared by the render passes and the dynamic rendering path
+    std::array<VkAttachmentDescription, 2> describe_attachments(render_pass_part part);
+    VkImageAspectFlags depth_aspect();
     void create_framebuffers();
     void create_sync_objects();
 
@@ -54,26 +105,60 @@ namespace lvk
     VkExtent2D choose_swap_extent(const VkSurfaceCapabilitiesKHR &capabilities);
 
     VkFormat swap_chain_image_format;
+    VkFormat depth_format;
     VkExtent2D swap_chain_extent;
 
+    bool dynamic_rendering = false;
+    PFN_vkCmdBeginRenderingKHR cmd_begin_rendering = nullptr;
+    PFN_vkCmdEndRenderingKHR cmd_end_rendering = nullptr;
+
+    // all empty with dynamic rendering
     std::vector<VkFramebuffer> swap_chain_framebuffers;
-    VkRenderPass render_pass;
+    VkRenderPass render_pass = VK_NULL_HANDLE;
+    VkRenderPass early_render_pass = VK_NULL_HANDLE;
+    VkRenderPass late_render_pass = VK_NULL_HANDLE;
 
-    std::vector<VkImage> depth_images;
-    std::vector<VkDeviceMemory> depth_image_memorys;
-    std::vector<VkImageView> depth_image_views;
+    // owned by the device's gpu_resources, the views come with them
+    std::vector<image_handle> depth_images;
     std::vector<VkImage> swap_chain_images;
     std::vector<VkImageView> swap_chain_image_views;
 
     device_wrp &device;
+    surface_wrp &surface;
     VkExtent2D window_extent;
 
     VkSwapchainKHR swap_chain;
+    bool transfer_src_supported = false;
 
     std::vector<VkSemaphore> image_available_semaphores;
     std::vector<VkSemaphore> render_finished_semaphores;
     std::vector<VkFence> in_flight_fences;
     std::vector<VkFence> images_in_flight;
+    // deletion queue value of each frame's last submission, 0 once it's retired
+    std::vector<uint64_t> frame_submissions;
+    VkSemaphore present_wait_semaphore = VK_NULL_HANDLE;
+    VkFence last_submit_fence = VK_NULL_HANDLE;
     size_t current_frame = 0;
   };
+
+  // presents the images of several swap chains with a single vkQueuePresentKHR,
+  // every swap chain has to be presentable from the same queue
+  class present_batch
+  {
+  public:
+    // goes after the swap chain's submit_command_buffers for that frame. a non zero present_id
+    // tags the present for VK_KHR_present_wait, which has to be enabled on the device then
+    void add(swap_chain_wrp &swap_chain, uint32_t image_index, uint64_t present_id = 0);
+    // returns the overall result, per swap chain results are in get_results
+    VkResult present(VkQueue present_queue);
+
+    const std::vector<VkResult> &get_results() const { return results; }
+
+  private:
+    std::vector<VkSwapchainKHR> swap_chains;
+    std::vector<uint32_t> image_indices;
+    std::vector<VkSemaphore> wait_semaphores;
+    std::vector<uint64_t> present_ids;
+    std::vector<VkResult> results;
+  };
 }
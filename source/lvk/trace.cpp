@@ -0,0 +1,161 @@
+#include "trace.hpp"
+
+#ifdef LVK_TRACING
+
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lvk::trace
+{
+	namespace
+	{
+		using clock = std::chrono::steady_clock;
+
+		struct event
+		{
+			const char* name;
+			clock::time_point start;
+			clock::duration duration;
+		};
+
+		// every thread gets its own fixed size buffer. only the owning thread writes to it,
+		// so recording is a plain store plus a release on the count, no locks involved.
+		// events past the capacity are dropped rather than stalling the recording thread
+		struct thread_buffer
+		{
+			static constexpr size_t CAPACITY = 1 << 16;
+
+			std::array<event, CAPACITY> events;
+			std::atomic<size_t> count{ 0 };
+			std::atomic<size_t> dropped{ 0 };
+			uint32_t thread_id = 0;
+			std::string thread_name;
+		};
+
+		const auto epoch = clock::now();
+
+		// only touched when a thread records its first event and when writing the trace.
+		// buffers are kept around after their thread exits so nothing gets lost
+		std::mutex buffers_mutex;
+		std::vector<std::unique_ptr<thread_buffer>> buffers;
+
+		auto local_buffer() -> thread_buffer&
+		{
+			thread_local thread_buffer* buffer = nullptr;
+			if (buffer == nullptr)
+			{
+				std::lock_guard lock{ buffers_mutex };
+				buffers.push_back(std::make_unique<thread_buffer>());
+				buffer = buffers.back().get();
+				buffer->thread_id = static_cast<uint32_t>(buffers.size());
+			}
+			return *buffer;
+		}
+
+		auto to_us(clock::duration duration) -> double
+		{
+			return std::chrono::duration<double, std::micro>(duration).count();
+		}
+
+		void write_escaped(std::ostream& out, const std::string& text)
+		{
+			for (char c : text)
+			{
+				if (c == '"' || c == '\\')
+				{
+					out << '\\';
+				}
+				out << c;
+			}
+		}
+	}
+
+	scope::~scope()
+	{
+		auto& buffer = local_buffer();
+		auto index = buffer.count.load(std::memory_order_relaxed);
+		if (index >= thread_buffer::CAPACITY)
+		{
+			buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		buffer.events[index] = { name, start, std::chrono::steady_clock::now() - start };
+		buffer.count.store(index + 1, std::memory_order_release);
+	}
+
+	void set_thread_name(const char* name)
+	{
+		auto& buffer = local_buffer();
+		std::lock_guard lock{ buffers_mutex };
+		buffer.thread_name = name;
+	}
+
+	bool write_chrome_trace(const std::string& path)
+	{
+		std::ofstream out{ path };
+		if (!out.is_open())
+		{
+			std::cerr << "failed to open trace file: " << path << std::endl;
+			return false;
+		}
+
+		std::lock_guard lock{ buffers_mutex };
+
+		// timestamps are in microseconds, keep sub-microsecond precision
+		out << std::fixed << std::setprecision(3);
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		bool first = true;
+		auto separator = [&] {
+			if (!first)
+			{
+				out << ",\n";
+			}
+			first = false;
+		};
+
+		size_t dropped = 0;
+		for (const auto& buffer : buffers)
+		{
+			if (!buffer->thread_name.empty())
+			{
+				separator();
+				out << R"({"ph":"M","name":"thread_name","pid":1,"tid":)" << buffer->thread_id
+					<< R"(,"args":{"name":")";
+				write_escaped(out, buffer->thread_name);
+				out << "\"}}";
+			}
+
+			auto count = buffer->count.load(std::memory_order_acquire);
+			for (size_t i = 0; i < count; i++)
+			{
+				const auto& event = buffer->events[i];
+				separator();
+				out << R"({"ph":"X","pid":1,"tid":)" << buffer->thread_id
+					<< R"(,"ts":)" << to_us(event.start - epoch)
+					<< R"(,"dur":)" << to_us(event.duration)
+					<< R"(,"name":")";
+				write_escaped(out, event.name);
+				out << "\"}";
+			}
+			dropped += buffer->dropped.load(std::memory_order_relaxed);
+		}
+
+		out << "\n]}\n";
+
+		if (dropped > 0)
+		{
+			std::cerr << "trace buffers overflowed, " << dropped << " events were dropped" << std::endl;
+		}
+		std::cout << "wrote trace to " << path << std::endl;
+		return true;
+	}
+}
+
+#endif
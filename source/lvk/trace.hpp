@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+// scoped cpu tracing that gets written out as chrome trace event json, open the file in
+// chrome://tracing or ui.perfetto.dev. tracing only exists in debug builds (or when
+// LVK_ENABLE_TRACING is defined), everywhere else LVK_TRACE_SCOPE compiles to nothing
+#if !defined(NDEBUG) || defined(LVK_ENABLE_TRACING)
+#define LVK_TRACING 1
+#endif
+
+namespace lvk::trace
+{
+#ifdef LVK_TRACING
+	// records a complete event on the calling thread's own buffer when it goes out of scope.
+	// name has to outlive the trace, which in practice means a string literal
+	class scope
+	{
+		const char* name;
+		std::chrono::steady_clock::time_point start;
+
+	public:
+		explicit scope(const char* _name) : name{ _name }, start{ std::chrono::steady_clock::now() } {}
+		~scope();
+
+		scope(const scope&) = delete;
+		scope& operator=(const scope&) = delete;
+	};
+
+	// names the calling thread in the trace viewer
+	void set_thread_name(const char* name);
+
+	// writes everything recorded so far on every thread, returns false if the file couldn't be written.
+	// meant to be called once recording threads are quiet (e.g. on shutdown)
+	bool write_chrome_trace(const std::string& path);
+#else
+	inline void set_thread_name(const char*) {}
+	inline bool write_chrome_trace(const std::string&) { return false; }
+#endif
+
+	// writes the trace to $LVK_TRACE_FILE if it is set
+	inline void write_chrome_trace_from_env()
+	{
+		if (const char* path = std::getenv("LVK_TRACE_FILE"))
+		{
+			write_chrome_trace(path);
+		}
+	}
+}
+
+#ifdef LVK_TRACING
+#define LVK_TRACE_CONCAT_IMPL(a, b) a##b
+#define LVK_TRACE_CONCAT(a, b) LVK_TRACE_CONCAT_IMPL(a, b)
+#define LVK_TRACE_SCOPE(name) ::lvk::trace::scope LVK_TRACE_CONCAT(lvk_trace_scope_, __LINE__){ name }
+#else
+#define LVK_TRACE_SCOPE(name) ((void)0)
+#endif
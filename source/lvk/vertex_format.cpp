@@ -0,0 +1,466 @@
+#include "vertex_format.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace lvk
+{
+	namespace
+	{
+		constexpr std::array POSITION_NAMES = { "float32", "float16", "snorm16" };
+		constexpr std::array NORMAL_NAMES = { "float32", "octahedral16", "octahedral8" };
+		constexpr std::array UV_NAMES = { "float32", "float16", "unorm16" };
+
+		// attributes start on 4 byte boundaries, which every vendor fetches fastest
+		auto padded(uint32_t size) -> uint32_t
+		{
+			return (size + 3) & ~3u;
+		}
+
+		auto position_format(position_encoding encoding) -> attribute_format
+		{
+			// three component 16 bit formats are barely supported as vertex input, so w is padding
+			switch (encoding)
+			{
+			case position_encoding::float16: return attribute_format::float16x4;
+			case position_encoding::snorm16: return attribute_format::snorm16x4;
+			default: return attribute_format::float32x3;
+			}
+		}
+
+		auto normal_format(normal_encoding encoding) -> attribute_format
+		{
+			switch (encoding)
+			{
+			case normal_encoding::octahedral16: return attribute_format::snorm16x2;
+			case normal_encoding::octahedral8: return attribute_format::snorm8x2;
+			default: return attribute_format::float32x3;
+			}
+		}
+
+		auto uv_format(uv_encoding encoding) -> attribute_format
+		{
+			switch (encoding)
+			{
+			case uv_encoding::float16: return attribute_format::float16x2;
+			case uv_encoding::unorm16: return attribute_format::unorm16x2;
+			default: return attribute_format::float32x2;
+			}
+		}
+
+		auto format_size(attribute_format format) -> uint32_t
+		{
+			switch (format)
+			{
+			case attribute_format::float32x2: return 8;
+			case attribute_format::float32x3: return 12;
+			case attribute_format::float16x2: return 4;
+			case attribute_format::float16x4: return 8;
+			case attribute_format::snorm8x2: return 2;
+			case attribute_format::snorm16x2: return 4;
+			case attribute_format::snorm16x4: return 8;
+			case attribute_format::unorm16x2: return 4;
+			}
+			return 0;
+		}
+
+		template<size_t N>
+		auto find_name(const std::array<const char*, N>& names, std::string_view name) -> std::optional<uint8_t>
+		{
+			for (size_t i = 0; i < N; i++)
+			{
+				if (name == names[i])
+				{
+					return static_cast<uint8_t>(i);
+				}
+			}
+			return std::nullopt;
+		}
+
+		auto to_snorm16(float value) -> int16_t
+		{
+			return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+		}
+
+		auto to_snorm8(float value) -> int8_t
+		{
+			return static_cast<int8_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+		}
+
+		auto to_unorm16(float value) -> uint16_t
+		{
+			return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+		}
+
+		// same rules as vulkan's snorm conversion, -32768 and -32767 both end up at -1
+		auto from_snorm16(int16_t value) -> float
+		{
+			return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+		}
+
+		auto from_snorm8(int8_t value) -> float
+		{
+			return std::max(static_cast<float>(value) / 127.0f, -1.0f);
+		}
+
+		template<typename T, size_t N>
+		void write(std::byte* out, const std::array<T, N>& values)
+		{
+			std::memcpy(out, values.data(), sizeof(T) * N);
+		}
+
+		template<typename T, size_t N>
+		auto read(const std::byte* in) -> std::array<T, N>
+		{
+			std::array<T, N> values;
+			std::memcpy(values.data(), in, sizeof(T) * N);
+			return values;
+		}
+	}
+
+	auto vertex_layout::parse(std::string_view text) -> std::optional<vertex_layout>
+	{
+		if (text == "full")
+		{
+			return full();
+		}
+		if (text == "compact")
+		{
+			return compact();
+		}
+
+		auto first = text.find(',');
+		auto second = first == std::string_view::npos ? first : text.find(',', first + 1);
+		if (second == std::string_view::npos)
+		{
+			return std::nullopt;
+		}
+
+		auto position = find_name(POSITION_NAMES, text.substr(0, first));
+		auto normal = find_name(NORMAL_NAMES, text.substr(first + 1, second - first - 1));
+		auto uv = find_name(UV_NAMES, text.substr(second + 1));
+		if (!position || !normal || !uv)
+		{
+			return std::nullopt;
+		}
+		return vertex_layout{
+			static_cast<position_encoding>(*position),
+			static_cast<normal_encoding>(*normal),
+			static_cast<uv_encoding>(*uv),
+		};
+	}
+
+	auto vertex_layout::name() const -> std::string
+	{
+		if (*this == full())
+		{
+			return "full";
+		}
+		if (*this == compact())
+		{
+			return "compact";
+		}
+		return std::string{ POSITION_NAMES[static_cast<size_t>(position)] } + ","
+			 + NORMAL_NAMES[static_cast<size_t>(normal)] + ","
+			 + UV_NAMES[static_cast<size_t>(uv)];
+	}
+
+	auto vertex_layout::stride() const -> uint32_t
+	{
+		return padded(format_size(position_format(position)))
+			 + padded(format_size(normal_format(normal)))
+			 + padded(format_size(uv_format(uv)));
+	}
+
+	auto vertex_layout::attributes() const -> std::vector<vertex_attribute>
+	{
+		std::vector<vertex_attribute> result;
+		uint32_t offset = 0;
+		for (auto format : { position_format(position), normal_format(normal), uv_format(uv) })
+		{
+			result.push_back({ static_cast<uint32_t>(result.size()), format, offset });
+			offset += padded(format_size(format));
+		}
+		return result;
+	}
+
+	auto make_position_dequantization(std::span<const vertex> vertices, position_encoding encoding) -> position_dequantization
+	{
+		if (encoding == position_encoding::float32 || vertices.empty())
+		{
+			return {};
+		}
+
+		auto min = vertices.front().position;
+		auto max = min;
+		for (const auto& v : vertices)
+		{
+			min = glm::min(min, v.position);
+			max = glm::max(max, v.position);
+		}
+
+		position_dequantization result;
+		result.offset = (min + max) * 0.5f;
+		result.scale = (max - min) * 0.5f;
+		// flat meshes have a zero extent along some axis, anything but zero works there
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (result.scale[axis] <= 0.0f)
+			{
+				result.scale[axis] = 1.0f;
+			}
+		}
+		return result;
+	}
+
+	auto fit_vertex_layout(std::span<const vertex> vertices, vertex_layout layout) -> vertex_layout
+	{
+		if (layout.uv == uv_encoding::unorm16)
+		{
+			auto in_range = std::all_of(vertices.begin(), vertices.end(), [](const vertex& v) {
+				return v.uv.x >= 0.0f && v.uv.x <= 1.0f && v.uv.y >= 0.0f && v.uv.y <= 1.0f;
+			});
+			if (!in_range)
+			{
+				layout.uv = uv_encoding::float16;
+			}
+		}
+		return layout;
+	}
+
+	void encode_vertices(std::span<const vertex> vertices, const vertex_layout& layout, const position_dequantization& dequantization, std::span<std::byte> out)
+	{
+		auto stride = layout.stride();
+		if (out.size() < vertices.size() * stride)
+		{
+			throw std::runtime_error("vertex encoding output is too small");
+		}
+
+		auto attributes = layout.attributes();
+		auto inverse_scale = glm::vec3{ 1.0f } / dequantization.scale;
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			const auto& v = vertices[i];
+			auto* base = out.data() + i * stride;
+			// padding is zeroed too, so encoded buffers compare and hash the same every time
+			std::memset(base, 0, stride);
+
+			auto* p = base + attributes[0].offset;
+			auto q = (v.position - dequantization.offset) * inverse_scale;
+			switch (layout.position)
+			{
+			case position_encoding::float32:
+				write(p, std::array{ v.position.x, v.position.y, v.position.z });
+				break;
+			case position_encoding::float16:
+				write(p, std::array<uint16_t, 4>{ float_to_half(q.x), float_to_half(q.y), float_to_half(q.z), 0 });
+				break;
+			case position_encoding::snorm16:
+				write(p, std::array<int16_t, 4>{ to_snorm16(q.x), to_snorm16(q.y), to_snorm16(q.z), 0 });
+				break;
+			}
+
+			auto* n = base + attributes[1].offset;
+			switch (layout.normal)
+			{
+			case normal_encoding::float32:
+				write(n, std::array{ v.normal.x, v.normal.y, v.normal.z });
+				break;
+			case normal_encoding::octahedral16:
+			{
+				auto e = octahedral_encode(v.normal);
+				write(n, std::array{ to_snorm16(e.x), to_snorm16(e.y) });
+				break;
+			}
+			case normal_encoding::octahedral8:
+			{
+				auto e = octahedral_encode(v.normal);
+				write(n, std::array{ to_snorm8(e.x), to_snorm8(e.y) });
+				break;
+			}
+			}
+
+			auto* t = base + attributes[2].offset;
+			switch (layout.uv)
+			{
+			case uv_encoding::float32:
+				write(t, std::array{ v.uv.x, v.uv.y });
+				break;
+			case uv_encoding::float16:
+				write(t, std::array{ float_to_half(v.uv.x), float_to_half(v.uv.y) });
+				break;
+			case uv_encoding::unorm16:
+				write(t, std::array{ to_unorm16(v.uv.x), to_unorm16(v.uv.y) });
+				break;
+			}
+		}
+	}
+
+	auto decode_vertex(const std::byte* data, const vertex_layout& layout, const position_dequantization& dequantization) -> vertex
+	{
+		auto attributes = layout.attributes();
+		vertex v;
+
+		const auto* p = data + attributes[0].offset;
+		switch (layout.position)
+		{
+		case position_encoding::float32:
+		{
+			auto f = read<float, 3>(p);
+			v.position = { f[0], f[1], f[2] };
+			break;
+		}
+		case position_encoding::float16:
+		{
+			auto h = read<uint16_t, 3>(p);
+			v.position = dequantization.offset + dequantization.scale * glm::vec3{ half_to_float(h[0]), half_to_float(h[1]), half_to_float(h[2]) };
+			break;
+		}
+		case position_encoding::snorm16:
+		{
+			auto s = read<int16_t, 3>(p);
+			v.position = dequantization.offset + dequantization.scale * glm::vec3{ from_snorm16(s[0]), from_snorm16(s[1]), from_snorm16(s[2]) };
+			break;
+		}
+		}
+
+		const auto* n = data + attributes[1].offset;
+		switch (layout.normal)
+		{
+		case normal_encoding::float32:
+		{
+			auto f = read<float, 3>(n);
+			v.normal = { f[0], f[1], f[2] };
+			break;
+		}
+		case normal_encoding::octahedral16:
+		{
+			auto s = read<int16_t, 2>(n);
+			v.normal = octahedral_decode({ from_snorm16(s[0]), from_snorm16(s[1]) });
+			break;
+		}
+		case normal_encoding::octahedral8:
+		{
+			auto s = read<int8_t, 2>(n);
+			v.normal = octahedral_decode({ from_snorm8(s[0]), from_snorm8(s[1]) });
+			break;
+		}
+		}
+
+		const auto* t = data + attributes[2].offset;
+		switch (layout.uv)
+		{
+		case uv_encoding::float32:
+		{
+			auto f = read<float, 2>(t);
+			v.uv = { f[0], f[1] };
+			break;
+		}
+		case uv_encoding::float16:
+		{
+			auto h = read<uint16_t, 2>(t);
+			v.uv = { half_to_float(h[0]), half_to_float(h[1]) };
+			break;
+		}
+		case uv_encoding::unorm16:
+		{
+			auto u = read<uint16_t, 2>(t);
+			v.uv = { static_cast<float>(u[0]) / 65535.0f, static_cast<float>(u[1]) / 65535.0f };
+			break;
+		}
+		}
+		return v;
+	}
+
+	auto float_to_half(float value) -> uint16_t
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+		auto magnitude = bits & 0x7fffffff;
+
+		// infinity stays infinity, nan stays a (quiet) nan
+		if (magnitude >= 0x7f800000)
+		{
+			return static_cast<uint16_t>(sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x0200 : 0));
+		}
+		// 65520 and up round past the largest half
+		if (magnitude >= 0x477ff000)
+		{
+			return static_cast<uint16_t>(sign | 0x7c00);
+		}
+		// below 2^-14 halves are denormal, steps of 2^-24
+		if (magnitude < 0x38800000)
+		{
+			float absolute;
+			std::memcpy(&absolute, &magnitude, sizeof(absolute));
+			return static_cast<uint16_t>(sign | std::lrint(absolute * 16777216.0f));
+		}
+
+		// rebias the exponent from 127 to 15 and round the dropped mantissa bits to nearest even
+		auto half = (magnitude - 0x38000000) >> 13;
+		auto dropped = magnitude & 0x1fff;
+		if (dropped > 0x1000 || (dropped == 0x1000 && (half & 1)))
+		{
+			half++;
+		}
+		return static_cast<uint16_t>(sign | half);
+	}
+
+	auto half_to_float(uint16_t value) -> float
+	{
+		auto sign = static_cast<uint32_t>(value & 0x8000) << 16;
+		auto exponent = (value >> 10) & 0x1f;
+		auto mantissa = static_cast<uint32_t>(value & 0x3ff);
+
+		if (exponent == 0)
+		{
+			auto magnitude = static_cast<float>(mantissa) / 16777216.0f;
+			return sign ? -magnitude : magnitude;
+		}
+
+		uint32_t bits = exponent == 0x1f
+			? sign | 0x7f800000 | (mantissa << 13)
+			: sign | ((exponent + 112) << 23) | (mantissa << 13);
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	auto octahedral_encode(glm::vec3 normal) -> glm::vec2
+	{
+		auto length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+		if (length == 0.0f)
+		{
+			return glm::vec2{ 0.0f };
+		}
+
+		normal /= length;
+		glm::vec2 result{ normal.x, normal.y };
+		// the lower half folds over the diagonals onto the corners of the square
+		if (normal.z < 0.0f)
+		{
+			result = {
+				(1.0f - std::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f),
+				(1.0f - std::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f),
+			};
+		}
+		return result;
+	}
+
+	auto octahedral_decode(glm::vec2 encoded) -> glm::vec3
+	{
+		// same as decode_octahedral in mesh_packed.vert
+		glm::vec3 normal{ encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y) };
+		auto t = std::max(-normal.z, 0.0f);
+		normal.x += normal.x >= 0.0f ? -t : t;
+		normal.y += normal.y >= 0.0f ? -t : t;
+		return glm::normalize(normal);
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "mesh.hpp"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lvk
+{
+	// how each attribute is stored in the vertex buffer. meshes stay full precision on the cpu side
+	// (and in the mesh cache), the compact encodings only exist on the gpu
+	enum class position_encoding : uint8_t
+	{
+		float32,
+		// both quantised ones are relative to the mesh's bounding box, see position_dequantization
+		float16,
+		snorm16,
+	};
+
+	enum class normal_encoding : uint8_t
+	{
+		float32,
+		// octahedral projection onto two components, decoded in mesh_packed.vert
+		octahedral16,
+		octahedral8,
+	};
+
+	enum class uv_encoding : uint8_t
+	{
+		float32,
+		float16,
+		// only for uvs inside [0, 1], see fit_vertex_layout
+		unorm16,
+	};
+
+	// what the gpu reads, mesh_wrp turns these into VkFormats
+	enum class attribute_format : uint8_t
+	{
+		float32x2,
+		float32x3,
+		float16x2,
+		float16x4,
+		snorm8x2,
+		snorm16x2,
+		snorm16x4,
+		unorm16x2,
+	};
+
+	struct vertex_attribute
+	{
+		uint32_t location;
+		attribute_format format;
+		uint32_t offset;
+	};
+
+	struct vertex_layout
+	{
+		position_encoding position = position_encoding::float32;
+		normal_encoding normal = normal_encoding::float32;
+		uv_encoding uv = uv_encoding::float32;
+
+		// lvk::vertex as is, 32 bytes
+		static auto full() -> vertex_layout
+		{
+			return {};
+		}
+		// 16 bytes: snorm16 positions, 16 bit octahedral normals and unorm16 uvs
+		static auto compact() -> vertex_layout
+		{
+			return { position_encoding::snorm16, normal_encoding::octahedral16, uv_encoding::unorm16 };
+		}
+
+		// full, compact or "<position>,<normal>,<uv>" spelled like the enums, e.g. "float16,octahedral8,float16"
+		static auto parse(std::string_view text) -> std::optional<vertex_layout>;
+		auto name() const -> std::string;
+
+		auto stride() const -> uint32_t;
+		// locations 0, 1 and 2 for position, normal and uv, same as the shaders
+		auto attributes() const -> std::vector<vertex_attribute>;
+
+		bool operator==(const vertex_layout&) const = default;
+	};
+
+	// maps stored positions back into model space: position = offset + scale * stored.
+	// folding it into the model matrix keeps the shaders oblivious to it
+	struct position_dequantization
+	{
+		glm::vec3 offset{ 0.0f };
+		glm::vec3 scale{ 1.0f };
+	};
+
+	// stored positions span [-1, 1] over the bounding box, which is what snorm needs and keeps fp16
+	// precision the same all over the mesh. identity for float32
+	auto make_position_dequantization(std::span<const vertex> vertices, position_encoding encoding) -> position_dequantization;
+
+	// falls back to encodings that can represent the mesh, i.e. float16 uvs when some are outside [0, 1]
+	auto fit_vertex_layout(std::span<const vertex> vertices, vertex_layout layout) -> vertex_layout;
+
+	// writes vertices.size() * layout.stride() bytes, e.g. straight into a mapped staging buffer
+	void encode_vertices(std::span<const vertex> vertices, const vertex_layout& layout, const position_dequantization& dequantization, std::span<std::byte> out);
+
+	// what the gpu will read back, for measuring the error
+	auto decode_vertex(const std::byte* data, const vertex_layout& layout, const position_dequantization& dequantization) -> vertex;
+
+	auto float_to_half(float value) -> uint16_t;
+	auto half_to_float(uint16_t value) -> float;
+
+	// unit vector onto the [-1, 1] square and back
+	auto octahedral_encode(glm::vec3 normal) -> glm::vec2;
+	auto octahedral_decode(glm::vec2 encoded) -> glm::vec3;
+}
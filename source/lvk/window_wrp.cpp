@@ -1,19 +1,27 @@
 #include <stdexcept>
 #include "window_wrp.hpp"
+#include "startup_timer.hpp"
 
 namespace lvk
 {
+	namespace
+	{
+		// glfw is shared by every window, so only the last one to go terminates it
+		int live_windows = 0;
+	}
+
 	void window_wrp::init_window()
 	{
+		startup_phase phase{ "window" };
+
+		// a no-op if glfw is already up
 		glfwInit();
+		live_windows++;
 
 		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 		glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
 
 		window = glfwCreateWindow(width, height, window_name.c_str(), nullptr, nullptr);
-
-		uint32_t extensionCount = 0;
-		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
 	}
 
 	window_wrp::window_wrp(unsigned int _width, unsigned int _height, const std::string& _window_name)
@@ -25,13 +33,20 @@ namespace lvk
 	window_wrp::~window_wrp()
 	{
 		glfwDestroyWindow(window);
-		glfwTerminate();
+		if (--live_windows == 0)
+		{
+			glfwTerminate();
+		}
 	}
 
 	bool window_wrp::should_close()
 	{
 		return glfwWindowShouldClose(window);
 	}
+	void window_wrp::request_close()
+	{
+		glfwSetWindowShouldClose(window, GLFW_TRUE);
+	}
 	VkExtent2D window_wrp::get_extent()
 	{
 		return {width, height};
@@ -44,5 +59,16 @@ namespace lvk
 		}
 
 	}
-}
+	std::vector<const char*> window_wrp::required_instance_extensions()
+	{
+		glfwInit();
 
+		uint32_t count = 0;
+		const char** extensions = glfwGetRequiredInstanceExtensions(&count);
+		if (extensions == nullptr)
+		{
+			throw std::runtime_error("glfw can't present with vulkan on this system");
+		}
+		return { extensions, extensions + count };
+	}
+}
@@ -5,6 +5,7 @@
 #include "GLFW/glfw3.h"
 
 #include <string>
+#include <vector>
 
 namespace lvk
 {
@@ -24,7 +25,11 @@ namespace lvk
 		window_wrp& operator=(const window_wrp&) = delete;
 
 		bool should_close();
+		void request_close();
 		VkExtent2D get_extent();
 		void create_window_surface(VkInstance instance, VkSurfaceKHR* surface);
+
+		// instance extensions glfw needs for presenting, usable before any window exists
+		static std::vector<const char*> required_instance_extensions();
 	};
 }
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lvk
+{
+	// bounded chase-lev deque (with the memory orders from le et al. 2013). the owning thread
+	// pushes and pops at the bottom like a stack, any other thread can steal from the top.
+	// only the last element ever needs a cas, so the owner's fast path is a couple of plain
+	// loads and stores. T is meant to be a pointer
+	template<typename T, size_t CAPACITY>
+	class work_stealing_deque
+	{
+		static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity has to be a power of two");
+
+		static constexpr size_t CACHE_LINE = 64;
+		static constexpr int64_t MASK = static_cast<int64_t>(CAPACITY - 1);
+
+		// thieves race on top, the owner on bottom, so they get their own cache lines
+		alignas(CACHE_LINE) std::atomic<int64_t> top{ 0 };
+		alignas(CACHE_LINE) std::atomic<int64_t> bottom{ 0 };
+		alignas(CACHE_LINE) std::array<std::atomic<T>, CAPACITY> slots{};
+
+	public:
+		work_stealing_deque() = default;
+		work_stealing_deque(const work_stealing_deque&) = delete;
+		work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+		// owner only, returns false if the deque is full
+		bool push(T value)
+		{
+			auto b = bottom.load(std::memory_order_relaxed);
+			auto t = top.load(std::memory_order_acquire);
+			if (b - t >= static_cast<int64_t>(CAPACITY))
+			{
+				return false;
+			}
+
+			// release publishes the slot (and whatever it points to) to thieves acquiring bottom
+			slots[b & MASK].store(value, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_release);
+			return true;
+		}
+
+		// owner only, takes the most recently pushed element. returns false if the deque is empty
+		// or a thief got the last element first
+		bool pop(T& value)
+		{
+			auto b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			auto t = top.load(std::memory_order_relaxed);
+
+			if (t > b)
+			{
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return false;
+			}
+
+			value = slots[b & MASK].load(std::memory_order_relaxed);
+			if (t == b)
+			{
+				// last element, race the thieves for it
+				bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return won;
+			}
+			return true;
+		}
+
+		// any thread, takes the oldest element. returns false if the deque is empty or
+		// another thread took it first
+		bool steal(T& value)
+		{
+			auto t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			auto b = bottom.load(std::memory_order_acquire);
+
+			if (t >= b)
+			{
+				return false;
+			}
+
+			value = slots[t & MASK].load(std::memory_order_relaxed);
+			return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		}
+
+		// racy, only good for heuristics
+		auto size() const -> size_t
+		{
+			auto b = bottom.load(std::memory_order_relaxed);
+			auto t = top.load(std::memory_order_relaxed);
+			return b > t ? static_cast<size_t>(b - t) : 0;
+		}
+
+		static constexpr auto capacity() -> size_t
+		{
+			return CAPACITY;
+		}
+	};
+}
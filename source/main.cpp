@@ -1,12 +1,83 @@
 #include "lvk/app.hpp"
 
-#include <cstdlib>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <system_error>
 
-int main()
+int main(int argc, char** argv)
 {
-	lvk::app app{};
+	// --device <index|name|uuid> picks the physical device, same as LVK_DEVICE
+	// --windows <n> opens n windows that all render on the same device
+	// --objects <n> sets how many meshes get drawn
+	// --mesh <path> draws an obj/gltf/glb file instead of the test sphere
+	// --vertex-format <full|compact|position,normal,uv> picks the vertex buffer layout
+	auto usage = [] {
+		std::cerr << "usage: learn_vulkan [--device <index|name|uuid>] [--windows <n>] [--objects <n>] [--mesh <path>]"
+					 " [--vertex-format <full|compact|position,normal,uv>]\n";
+		return 1;
+	};
+
+	// the whole argument has to be a number that fits, 0 isn't a count either
+	auto parse_count = [](const char* text, uint32_t& count) {
+		auto end = text + std::strlen(text);
+		auto [last, error] = std::from_chars(text, end, count);
+		return error == std::errc{} && last == end && count > 0;
+	};
+
+	lvk::app_options options;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg.starts_with("--device="))
+		{
+			options.device_selector = arg.substr(9);
+			continue;
+		}
+		if (arg != "--device" && arg != "--windows" && arg != "--objects" && arg != "--mesh" && arg != "--vertex-format")
+		{
+			std::cerr << "unknown argument " << arg << '\n';
+			return usage();
+		}
+		if (i + 1 >= argc)
+		{
+			std::cerr << arg << " needs a value\n";
+			return usage();
+		}
+
+		const char* value = argv[++i];
+		if (arg == "--device")
+		{
+			options.device_selector = value;
+		}
+		else if (arg == "--windows" || arg == "--objects")
+		{
+			if (!parse_count(value, arg == "--windows" ? options.window_count : options.object_count))
+			{
+				std::cerr << arg << " needs a positive number, got " << value << '\n';
+				return usage();
+			}
+		}
+		else if (arg == "--mesh")
+		{
+			options.mesh_path = value;
+		}
+		else
+		{
+			auto layout = lvk::vertex_layout::parse(value);
+			if (!layout)
+			{
+				std::cerr << "unknown vertex format " << value << '\n';
+				return usage();
+			}
+			options.vertex_format = *layout;
+		}
+	}
+
+	lvk::app app{ options };
 
 	try
 	{
@@ -0,0 +1,180 @@
+// offline mesh processing: imports a mesh, generates lods, optimises it for the gpu and writes the
+// .lvkmesh the app would otherwise build on its first run. prints what every step bought.
+//
+//   mesh_tool <input> [-o <output>] [--cache-dir <dir>] [--no-lods] [--no-optimize] [--meshlets]
+
+#include "lvk/job_system.hpp"
+#include "lvk/mesh.hpp"
+#include "lvk/mesh_cache.hpp"
+#include "lvk/mesh_import.hpp"
+#include "lvk/mesh_lod.hpp"
+#include "lvk/mesh_optimize.hpp"
+
+#include <array>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <span>
+#include <string>
+
+namespace
+{
+	struct mesh_stats
+	{
+		lvk::vertex_cache_stats cache;
+		float fetch = 0.0f;
+		float overdraw = 0.0f;
+	};
+
+	auto analyze(const lvk::mesh_data& mesh) -> mesh_stats
+	{
+		const auto& lod = mesh.lods.front();
+		std::span<const uint32_t> indices{ mesh.indices.data() + lod.first_index, lod.index_count };
+		return {
+			.cache = lvk::analyze_vertex_cache(indices, mesh.vertices.size()),
+			.fetch = lvk::analyze_vertex_fetch(indices, mesh.vertices.size(), sizeof(lvk::vertex)),
+			.overdraw = lvk::analyze_overdraw(indices, mesh.vertices),
+		};
+	}
+
+	void print_meshlets(const lvk::mesh_data& mesh)
+	{
+		const auto& lod = mesh.lods.front();
+		auto meshlets = lvk::build_meshlets(mesh.vertices, { mesh.indices.data() + lod.first_index, lod.index_count });
+
+		// how many meshlets a cone test throws away, looking at the mesh from all six sides
+		const std::array<glm::vec3, 6> directions{
+			glm::vec3{ 1.0f, 0.0f, 0.0f }, glm::vec3{ -1.0f, 0.0f, 0.0f },
+			glm::vec3{ 0.0f, 1.0f, 0.0f }, glm::vec3{ 0.0f, -1.0f, 0.0f },
+			glm::vec3{ 0.0f, 0.0f, 1.0f }, glm::vec3{ 0.0f, 0.0f, -1.0f },
+		};
+		size_t culled = 0;
+		for (auto direction : directions)
+		{
+			auto camera = mesh.center + direction * mesh.radius * 3.0f;
+			for (const auto& m : meshlets.meshlets)
+			{
+				culled += lvk::is_backfacing(m, camera);
+			}
+		}
+
+		auto count = static_cast<double>(meshlets.meshlets.size());
+		std::printf("\nmeshlets: %zu, %.1f vertices and %.1f triangles on average, %.1f%% cone culled\n",
+			meshlets.meshlets.size(),
+			static_cast<double>(meshlets.vertices.size()) / count,
+			static_cast<double>(meshlets.triangles.size() / 3) / count,
+			100.0 * static_cast<double>(culled) / (count * static_cast<double>(directions.size())));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	auto usage = [] {
+		std::fprintf(stderr, "usage: mesh_tool <input> [-o <output>] [--cache-dir <dir>] [--no-lods] [--no-optimize] [--meshlets]\n");
+		return 1;
+	};
+
+	std::string input;
+	std::string output;
+	lvk::mesh_load_options options;
+	bool meshlets = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "-o" || arg == "--cache-dir")
+		{
+			if (i + 1 >= argc)
+			{
+				std::fprintf(stderr, "%s needs a value\n", arg.c_str());
+				return usage();
+			}
+			(arg == "-o" ? output : options.cache_dir) = argv[++i];
+		}
+		else if (arg == "--no-lods")
+		{
+			options.generate_lods = false;
+		}
+		else if (arg == "--no-optimize")
+		{
+			options.optimize = false;
+		}
+		else if (arg == "--meshlets")
+		{
+			meshlets = true;
+		}
+		else if (arg.starts_with("-"))
+		{
+			std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+			return usage();
+		}
+		else if (!input.empty())
+		{
+			std::fprintf(stderr, "only one input, got %s and %s\n", input.c_str(), arg.c_str());
+			return usage();
+		}
+		else
+		{
+			input = arg;
+		}
+	}
+
+	if (input.empty())
+	{
+		return usage();
+	}
+	// the app would just throw away a cache built with other settings and write its own over it
+	if (output.empty() && (!options.generate_lods || !options.optimize))
+	{
+		std::fprintf(stderr, "--no-lods and --no-optimize need -o, the default cache path is only for what the app loads\n");
+		return usage();
+	}
+
+	try
+	{
+		lvk::job_system jobs;
+		auto mesh = lvk::import_mesh(input, jobs);
+		if (options.generate_lods)
+		{
+			lvk::generate_lods(mesh);
+		}
+
+		auto before = analyze(mesh);
+		auto after = before;
+		if (options.optimize)
+		{
+			lvk::optimize_mesh(mesh);
+			after = analyze(mesh);
+		}
+
+		std::printf("%s: %zu vertices, %u triangles, %zu lods\n\n", input.c_str(), mesh.vertices.size(), mesh.lods.front().index_count / 3, mesh.lods.size());
+		std::printf("%-18s %10s %10s\n", "lod 0", "before", "after");
+		std::printf("%-18s %10.3f %10.3f\n", "acmr (fifo 16)", before.cache.acmr, after.cache.acmr);
+		std::printf("%-18s %10.3f %10.3f\n", "atvr (fifo 16)", before.cache.atvr, after.cache.atvr);
+		std::printf("%-18s %10.3f %10.3f\n", "overfetch", before.fetch, after.fetch);
+		std::printf("%-18s %10.3f %10.3f\n", "overdraw", before.overdraw, after.overdraw);
+
+		if (meshlets)
+		{
+			print_meshlets(mesh);
+		}
+
+		// by default the output goes where load_mesh looks for it, so the app skips the import. only
+		// with the default options, see above
+		if (output.empty())
+		{
+			output = lvk::mesh_cache_path(input, options.cache_dir);
+		}
+		if (auto directory = std::filesystem::path{ output }.parent_path(); !directory.empty())
+		{
+			std::filesystem::create_directories(directory);
+		}
+		lvk::write_mesh_cache(output, mesh.view(), lvk::mesh_source_stamp::of(input), options);
+		std::printf("\nwrote %s\n", output.c_str());
+	}
+	catch (const std::exception& e)
+	{
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}